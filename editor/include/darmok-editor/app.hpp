@@ -103,6 +103,9 @@ namespace darmok::editor
         bool drawFileInput(const char* label, std::filesystem::path& path, FileDialogOptions options) noexcept;
         EntityId getSelectedEntity() const noexcept;
 
+        // selects the definition entity that was loaded as the scene entity
+        bool selectEntity(Entity entity) noexcept;
+
         expected<void, std::string> addComponent(std::unique_ptr<IEditorAppComponent> comp) noexcept;
 
         template<typename T, typename... A>
@@ -3,6 +3,7 @@
 #include <darmok-editor/editor.hpp>
 #include <darmok/protobuf/scene.pb.h>
 #include <darmok/prefab.hpp>
+#include <darmok/culling.hpp>
 
 namespace darmok::editor
 {
@@ -19,4 +20,11 @@ namespace darmok::editor
         std::string getTitle() const noexcept override;
         RenderResult renderType(Prefab::Definition& prefab) noexcept override;
     };
+
+    class OccluderInspectorEditor final : public EntityComponentObjectEditor<Occluder>
+    {
+    public:
+        std::string getTitle() const noexcept override;
+        RenderResult renderType(Occluder::Definition& occluder) noexcept override;
+    };
 }
\ No newline at end of file
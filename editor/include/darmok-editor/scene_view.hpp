@@ -119,6 +119,7 @@ namespace darmok::editor
         EditorApp& _app;
         OptionalRef<Camera> _cam;
         OptionalRef<Scene> _scene;
+        OptionalRef<MaterialAppComponent> _materials;
         std::shared_ptr<Program> _program;
         std::optional<bgfx::ViewId> _viewId;
         OptionalRef<bgfx::Encoder> _encoder;
@@ -175,6 +176,7 @@ namespace darmok::editor
 
         expected<void, std::string> updateSize(const glm::uvec2& size) noexcept;
         void updateCamera(float deltaTime) noexcept;
+        bool pickEntity(const glm::vec2& viewportPoint) noexcept;
        
     };
 }
\ No newline at end of file
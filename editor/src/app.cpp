@@ -17,6 +17,7 @@
 #include <darmok/environment.hpp>
 #include <darmok/shadow.hpp>
 #include <darmok/culling.hpp>
+#include <darmok/bounds_tree.hpp>
 #include <darmok/scene_serialize.hpp>
 #include <darmok/freelook.hpp>
 #include <darmok/stream.hpp>
@@ -279,6 +280,7 @@ namespace darmok::editor
                     {
                         DARMOK_TRY(drawEntityComponentMenu<Renderable>("Renderable"));
                         DARMOK_TRY(drawEntityComponentDefinitionMenu<protobuf::Prefab>("Prefab"));
+                        DARMOK_TRY(drawEntityComponentMenu<Occluder>("Occluder"));
                         DARMOK_TRY(drawEntityComponentMenu<Camera>("Camera"));
                         DARMOK_TRY(drawEntityComponentMenu<LuaScript>("Lua Script"));
                         if (ImGui::BeginMenu("Light"))
@@ -301,6 +303,7 @@ namespace darmok::editor
                     {
                         DARMOK_TRY(drawSceneComponentMenu<FreelookController>("Freelook Controller"));
                         DARMOK_TRY(drawSceneComponentMenu<LuaScriptRunner>("Lua Script Runner"));
+                        DARMOK_TRY(drawSceneComponentMenu<SceneBoundsTree>("Scene Bounds Tree"));
                         DARMOK_TRY(onMainMenuRender(MainMenuSection::AddSceneComponent));
                         ImGui::EndMenu();
                     }
@@ -323,6 +326,7 @@ namespace darmok::editor
                         {
                             DARMOK_TRY(drawCameraComponentMenu<FrustumCuller>("Frustum Culler"));
                             DARMOK_TRY(drawCameraComponentMenu<OcclusionCuller>("Occlusion Culler"));
+                            DARMOK_TRY(drawCameraComponentMenu<SoftwareOcclusionCuller>("Software Occlusion Culler"));
                             ImGui::EndMenu();
                         }
                         if (ImGui::BeginMenu("Debug"))
@@ -527,6 +531,25 @@ namespace darmok::editor
         _sceneView.selectEntity(entity);
     }
 
+    bool EditorApp::selectEntity(Entity entity) noexcept
+    {
+        if (entity == entt::null)
+        {
+            onObjectSelected(nullEntityId);
+            return true;
+        }
+        auto& context = _proj.getComponentLoadContext();
+        for (auto entityId : _proj.getSceneDefinition().getEntities())
+        {
+            if (context.getEntity(entityId) == entity)
+            {
+                onObjectSelected(entityId);
+                return true;
+            }
+        }
+        return false;
+    }
+
     void EditorApp::onSceneTreeEntityClicked(EntityId entityId) noexcept
     {
         onObjectSelected(entityId);
@@ -27,6 +27,10 @@ namespace darmok::editor
 		{
 			changed = true;
 		}
+		if (ImguiUtils::drawProtobufInput("Skip Shadows", "skip_shadows", renderable))
+		{
+			changed = true;
+		}
 
 		return changed;
 	}
@@ -48,4 +52,15 @@ namespace darmok::editor
 		}
 		return changed;
 	}
+
+	std::string OccluderInspectorEditor::getTitle() const noexcept
+	{
+		return "Occluder";
+	}
+
+	OccluderInspectorEditor::RenderResult OccluderInspectorEditor::renderType(Occluder::Definition& occluder) noexcept
+	{
+		// should be smaller than the rendered mesh so it does not occlude too much
+		return renderChild(*occluder.mutable_mesh());
+	}
 }
\ No newline at end of file
@@ -134,6 +134,8 @@ namespace darmok::editor
         const char* confirmNewPopup = "Confirm New Project";
         const char* loadErrorPopup = "Scene Load Error";
 
+        _sceneLoader.getAssetPack().pruneCache();
+
         if (_requestReset)
         {
             _requestReset = false;
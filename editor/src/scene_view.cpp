@@ -12,6 +12,7 @@
 #include <darmok/shadow.hpp>
 #include <darmok/render_forward.hpp>
 #include <darmok/culling.hpp>
+#include <darmok/bounds_tree.hpp>
 #include <darmok/input.hpp>
 #include <darmok/shape.hpp>
 #include <darmok/mesh.hpp>
@@ -20,6 +21,8 @@
 
 #include <imgui.h>
 
+#include <limits>
+
 namespace darmok::editor
 {
     expected<void, std::string> TransformGizmo::init(Camera& cam, Scene& scene, SceneGizmosRenderer& renderer) noexcept
@@ -271,6 +274,12 @@ namespace darmok::editor
     {
         _cam = cam;
         _scene = scene;
+        auto matResult = app.getOrAddComponent<MaterialAppComponent>();
+        if (!matResult)
+        {
+            return unexpected{ std::move(matResult).error() };
+        }
+        _materials = matResult.value().get();
 
         auto progResult = StandardProgramLoader::load(Program::Standard::Unlit);
         if (!progResult)
@@ -318,6 +327,7 @@ namespace darmok::editor
         }
         _cam.reset();
         _scene.reset();
+        _materials.reset();
         return StringUtils::joinExpectedErrors(errors);
     }
 
@@ -387,7 +397,7 @@ namespace darmok::editor
         {
             return result;
         }
-        material.renderSubmit(*_viewId, *_encoder);
+        _materials->renderSubmit(*_viewId, *_encoder, material);
         return {};
     }
 
@@ -501,6 +511,45 @@ namespace darmok::editor
         return true;
     }
 
+    bool EditorSceneView::pickEntity(const glm::vec2& viewportPoint) noexcept
+    {
+        if (!_scene || !_cam)
+        {
+            return false;
+        }
+        auto ray = _cam->viewportPointToRay(glm::vec3{ viewportPoint, 0.F });
+        Entity entity = entt::null;
+        if (auto tree = _scene->getSceneComponent<SceneBoundsTree>())
+        {
+            // scene components do not update while the editor scene is paused
+            tree->refit();
+            auto hits = tree->raycast(ray);
+            if (!hits.empty())
+            {
+                entity = hits.front().entity;
+            }
+            return _app.selectEntity(entity);
+        }
+
+        // the scene has no bounds tree, test the bounds of all the entities
+        auto minDistance = std::numeric_limits<float>::max();
+        for (auto candidate : _scene->getEntities<BoundingBox>())
+        {
+            auto bbox = _scene->getComponent<const BoundingBox>(candidate).value();
+            if (auto trans = _scene->getComponent<const Transform>(candidate))
+            {
+                bbox = bbox * trans->getWorldMatrix();
+            }
+            auto dist = ray.intersect(bbox);
+            if (dist && dist.value() < minDistance)
+            {
+                minDistance = dist.value();
+                entity = candidate;
+            }
+        }
+        return _app.selectEntity(entity);
+    }
+
     EditorSceneView::MouseMode EditorSceneView::getMouseMode() const noexcept
     {
         return _mouseMode;
@@ -637,7 +686,18 @@ namespace darmok::editor
 
             if (_cam && _cam->getRenderOutput())
             {
+                auto imagePos = ImGui::GetCursorScreenPos();
                 ImguiUtils::drawBuffer(*_cam->getRenderOutput());
+                if (ImGui::IsItemClicked(ImGuiMouseButton_Left))
+                {
+                    auto mousePos = ImGui::GetMousePos();
+                    auto imageSize = ImGui::GetItemRectSize();
+                    glm::vec2 point{ mousePos.x - imagePos.x, mousePos.y - imagePos.y };
+                    point /= glm::vec2{ imageSize.x, imageSize.y };
+                    // imgui has the origin at the top
+                    point.y = 1.F - point.y;
+                    pickEntity(point);
+                }
             }
 
             _focused = ImGui::IsWindowFocused();
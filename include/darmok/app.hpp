@@ -189,6 +189,12 @@ namespace darmok
 
 		expected<void, std::string> setRendererType(bgfx::RendererType::Enum renderer) noexcept;
 
+		static constexpr size_t defaultShaderCacheMaxSize = 64 * 1024 * 1024;
+
+		// persist the compiled shaders between runs, an empty path keeps them only in memory
+		// needs to be called before init, otherwise it's applied the next time the renderer is initialized
+		void setShaderCachePath(const std::filesystem::path& path, size_t maxSize = defaultShaderCacheMaxSize) noexcept;
+
 		void setClearColor(const Color& color) noexcept;
 		void setUpdateConfig(const AppUpdateConfig& config) noexcept;
 
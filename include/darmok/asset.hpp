@@ -8,6 +8,7 @@
 #include <memory>
 #include <filesystem>
 #include <string>
+#include <future>
 
 #include <bx/bx.h>
 #include <bx/allocator.h>
@@ -29,6 +30,19 @@ namespace darmok
 	class ISoundLoader;
 	class IMusicLoader;
 	class IImageLoader;
+	class IAssetPackFileLoader;
+	class Program;
+	class Texture;
+	class Mesh;
+
+	namespace protobuf
+	{
+		class Scene;
+	}
+
+	// resolved in the main thread when the asset context updates
+	template<typename T>
+	using AssetFuture = std::shared_future<expected<std::shared_ptr<T>, std::string>>;
 
 	class DARMOK_EXPORT BX_NO_VTABLE IAssetContext
 	{
@@ -72,6 +86,7 @@ namespace darmok
 
 		[[nodiscard]] IDataLoader& getDataLoader() noexcept;
 		[[nodiscard]] IImageLoader& getImageLoader() noexcept;
+		[[nodiscard]] IAssetPackFileLoader& getAssetPackFileLoader() noexcept;
 		[[nodiscard]] bx::AllocatorI& getAllocator() noexcept override;
 		[[nodiscard]] IProgramFromDefinitionLoader& getProgramLoader() noexcept override;
 		[[nodiscard]] ITextureFromDefinitionLoader& getTextureLoader() noexcept override;
@@ -87,6 +102,13 @@ namespace darmok
 		[[nodiscard]] ISoundLoader& getSoundLoader() noexcept override;
 		[[nodiscard]] IMusicLoader& getMusicLoader() noexcept override;
 
+		// the definitions are loaded in the app task executor
+		// and the resources created in the main thread
+		[[nodiscard]] AssetFuture<Program> loadProgramAsync(const std::filesystem::path& path) noexcept;
+		[[nodiscard]] AssetFuture<Texture> loadTextureAsync(const std::filesystem::path& path) noexcept;
+		[[nodiscard]] AssetFuture<Mesh> loadMeshAsync(const std::filesystem::path& path) noexcept;
+		[[nodiscard]] AssetFuture<protobuf::Scene> loadSceneDefinitionAsync(const std::filesystem::path& path) noexcept;
+
 		[[nodiscard]] AssetContextImpl& getImpl() noexcept;
 		[[nodiscard]] const AssetContextImpl& getImpl() const noexcept;
 
@@ -108,6 +130,7 @@ namespace darmok
 		DarmokAssetFileImporter& setBgfxShadercPath(const std::filesystem::path& path) noexcept;
 		DarmokAssetFileImporter& addBgfxShaderIncludePath(const std::filesystem::path& path) noexcept;
 		DarmokAssetFileImporter& addSlangShaderIncludePath(const std::filesystem::path& path) noexcept;
+		DarmokAssetFileImporter& setJobs(size_t jobs) noexcept;
 		expected<Paths, std::string> getOutputPaths() const noexcept;
 		bool operator()(std::ostream& log) const noexcept;
 	private:
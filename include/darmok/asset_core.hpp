@@ -78,6 +78,10 @@ namespace darmok
         virtual expected<void, std::string> shutdown() noexcept;
         virtual expected<Effect, std::string> prepare(const Input& input) noexcept;
         virtual expected<void, std::string> operator()(const Input& input, Config& config) noexcept;
+
+        // importer with the same configuration for another import worker
+        // importers that return null are shared by the workers and import one file at a time
+        virtual std::unique_ptr<IFileTypeImporter> clone() const noexcept;
     };
 
     class CommandLineFileImporterImpl;
@@ -93,6 +97,7 @@ namespace darmok
         std::vector<std::filesystem::path> slangShaderIncludePaths;
         bool includeShaderDebugInfo = false;
         std::optional<int> shaderOptimizationLevel;
+        size_t jobs = 1;
 
         static const std::string defaultInputPath;
         static const std::string defaultOutputPath;
@@ -133,6 +138,9 @@ namespace darmok
         FileImporter& setOutputPath(const std::filesystem::path& outputPath) noexcept;
         FileImporter& addTypeImporter(std::unique_ptr<IFileTypeImporter> importer) noexcept;
 
+        // maximum amount of operations imported in parallel, 0 uses all the cores
+        FileImporter& setJobs(size_t jobs) noexcept;
+
         template<typename T, typename... A>
         T& addTypeImporter(A&&... args) noexcept
         {
@@ -163,6 +171,7 @@ namespace darmok
         DarmokCoreAssetFileImporter& addSlangShaderIncludePath(const std::filesystem::path &path) noexcept;
         DarmokCoreAssetFileImporter& setIncludeShaderDebugInfo(bool debug) noexcept;
         DarmokCoreAssetFileImporter& setShaderOptimizationLevel(int level) noexcept;
+        DarmokCoreAssetFileImporter& setJobs(size_t jobs) noexcept;
         expected<Paths, std::string> getOutputPaths() const noexcept;
         bool operator()(std::ostream& log) const noexcept;
     private:
@@ -180,6 +189,7 @@ namespace darmok
 
         expected<Effect, std::string> prepare(const Input& input) noexcept override;
         expected<void, std::string> operator()(const Input& input, Config& config) noexcept override;
+        std::unique_ptr<IFileTypeImporter> clone() const noexcept override;
     private:
         size_t _bufferSize;
     };
@@ -14,36 +14,137 @@
 #include <darmok/text.hpp>
 #include <darmok/scene_serialize.hpp>
 #include <darmok/optional_ref.hpp>
+#include <darmok/data.hpp>
+
+#include <array>
+#include <span>
+#include <vector>
+#include <string_view>
 
 namespace darmok
 {
+	class DARMOK_EXPORT BX_NO_VTABLE IAssetPackSource
+	{
+	public:
+		virtual ~IAssetPackSource() = default;
+		[[nodiscard]] virtual bool contains(const std::filesystem::path& path) const noexcept = 0;
+		[[nodiscard]] virtual expected<IdType, std::string> getTypeId(const std::filesystem::path& path) const noexcept = 0;
+		[[nodiscard]] virtual expected<void, std::string> unpack(const std::filesystem::path& path, protobuf::Message& msg) const noexcept = 0;
+	};
+
+	// asset pack fully loaded in memory
+	class DARMOK_EXPORT AssetPackDefinitionSource final : public IAssetPackSource
+	{
+	public:
+		using Definition = protobuf::AssetPack;
+		AssetPackDefinitionSource(OptionalRef<const Definition> def = nullptr) noexcept;
+
+		[[nodiscard]] bool contains(const std::filesystem::path& path) const noexcept override;
+		[[nodiscard]] expected<IdType, std::string> getTypeId(const std::filesystem::path& path) const noexcept override;
+		[[nodiscard]] expected<void, std::string> unpack(const std::filesystem::path& path, protobuf::Message& msg) const noexcept override;
+	private:
+		OptionalRef<const Definition> _def;
+	};
+
+	// memory mapped asset pack, loading an asset only touches the pages of its index entry and data
+	// little endian format: header, index entries sorted by path hash and 16 byte aligned blobs
+	// with the path and message type name followed by the serialized message
+	class DARMOK_EXPORT AssetPackFile final : public IAssetPackSource
+	{
+	public:
+		using Definition = protobuf::AssetPack;
+
+		struct Header final
+		{
+			std::array<char, 4> magic;
+			uint32_t version;
+			uint64_t entryCount;
+			uint64_t indexOffset;
+		};
+
+		struct Entry final
+		{
+			uint64_t pathHash;
+			uint64_t pathOffset;
+			uint64_t dataOffset;
+			uint64_t dataSize;
+			uint32_t pathSize;
+			uint32_t typeSize;
+		};
+
+		static constexpr std::array<char, 4> magic = { 'D', 'P', 'A', 'K' };
+		static constexpr uint32_t version = 1;
+		static constexpr size_t blobAlignment = 16;
+		static constexpr std::string_view extension = ".dpk";
+
+		// entry with the scene definition (without the assets) in packs written from a scene
+		static constexpr std::string_view scenePath = ":scene";
+
+		[[nodiscard]] size_t size() const noexcept;
+		[[nodiscard]] std::vector<std::filesystem::path> getPaths() const noexcept;
+		[[nodiscard]] bool contains(const std::filesystem::path& path) const noexcept override;
+		[[nodiscard]] expected<IdType, std::string> getTypeId(const std::filesystem::path& path) const noexcept override;
+		[[nodiscard]] expected<void, std::string> unpack(const std::filesystem::path& path, protobuf::Message& msg) const noexcept override;
+
+		// view of the serialized message inside the mapped file
+		[[nodiscard]] expected<DataView, std::string> getData(const std::filesystem::path& path) const noexcept;
+
+		[[nodiscard]] bool hasScene() const noexcept;
+		[[nodiscard]] expected<void, std::string> unpackScene(protobuf::Scene& scene) const noexcept;
+
+		[[nodiscard]] static expected<AssetPackFile, std::string> open(const std::filesystem::path& path) noexcept;
+		[[nodiscard]] static expected<AssetPackFile, std::string> open(MappedFile&& file) noexcept;
+		[[nodiscard]] static expected<void, std::string> write(const Definition& def, std::ostream& out) noexcept;
+		[[nodiscard]] static expected<void, std::string> write(const Definition& def, const std::filesystem::path& path) noexcept;
+
+		// the scene assets are stored as pack entries, the rest of the scene in the scenePath entry
+		[[nodiscard]] static expected<void, std::string> write(protobuf::Scene scene, std::ostream& out) noexcept;
+		[[nodiscard]] static uint64_t hashPath(std::string_view path) noexcept;
+
+	private:
+		MappedFile _file;
+		std::span<const Entry> _entries;
+
+		AssetPackFile(MappedFile&& file, std::span<const Entry> entries) noexcept;
+
+		[[nodiscard]] const Entry* findEntry(const std::filesystem::path& path) const noexcept;
+		[[nodiscard]] std::string_view getPath(const Entry& entry) const noexcept;
+		[[nodiscard]] std::string_view getTypeName(const Entry& entry) const noexcept;
+	};
+
+	class DARMOK_EXPORT BX_NO_VTABLE IAssetPackFileLoader : public ILoader<AssetPackFile>{};
+
+	// maps the pack files through the data loader
+	class DARMOK_EXPORT AssetPackFileLoader final : public IAssetPackFileLoader
+	{
+	public:
+		AssetPackFileLoader(IDataLoader& dataLoader) noexcept;
+		[[nodiscard]] Result operator()(std::filesystem::path path) noexcept override;
+	private:
+		OptionalRef<IDataLoader> _dataLoader;
+	};
+
 	template<class Interface>
 	class DARMOK_EXPORT AssetPackLoader final : public Interface
 	{
 	private:
-		OptionalRef<const protobuf::AssetPack> _assets;
-		std::unordered_set<std::filesystem::path> _loadedPaths;
+		OptionalRef<const IAssetPackSource> _source;
 	public:
 		using Result = Interface::Result;
 		using Resource = Interface::Resource;
 
-		AssetPackLoader(const protobuf::AssetPack& assets) noexcept
-			: _assets{ assets }
+		AssetPackLoader(const IAssetPackSource& source) noexcept
+			: _source{ source }
 		{
 		}
 
 		[[nodiscard]] Result operator()(std::filesystem::path path) noexcept override
 		{
-			auto& assets = _assets->assets();
-			auto itr = assets.find(path.string());
-			if (itr == assets.end())
-			{
-				return unexpected{ fmt::format("asset pack path \"{}\" not found", path.string()) };
-			}
 			auto def = std::make_shared<Resource>();
-			if (!itr->second.UnpackTo(def.get()))
+			auto result = _source->unpack(path, *def);
+			if (!result)
 			{
-				return unexpected{ fmt::format("failed to unpack asset in path \"{}\"", path.string()) };
+				return unexpected{ std::move(result).error() };
 			}
 			return def;
 		}
@@ -60,6 +161,7 @@ namespace darmok
 	public:
 		using Definition = protobuf::AssetPack;
 		AssetPack(const Definition& def, const AssetPackConfig& config);
+		AssetPack(const IAssetPackSource& source, const AssetPackConfig& config);
 
 		[[nodiscard]] bx::AllocatorI& getAllocator() noexcept override;
 		[[nodiscard]] IProgramFromDefinitionLoader& getProgramLoader() noexcept override;
@@ -78,8 +180,12 @@ namespace darmok
 
 		expected<void, std::string> reloadAsset(const std::filesystem::path& path);
 		expected<void, std::string> removeAsset(const std::filesystem::path& path);
+
+		// forget the released resources, does not affect the fallback context
+		void pruneCache() noexcept;
 	private:
-		OptionalRef<const Definition> _def;
+		AssetPackDefinitionSource _defSource;
+		const IAssetPackSource& _source;
 		OptionalRef<bx::AllocatorI> _alloc;
 		bx::DefaultAllocator _defaultAlloc;
 
@@ -119,5 +225,7 @@ namespace darmok
 		MeshLoader _meshLoader;
 		MaterialLoader _materialLoader;
 		ArmatureLoader _armatureLoader;
+
+		AssetPack(OptionalRef<const Definition> def, OptionalRef<const IAssetPackSource> source, const AssetPackConfig& config);
 	};
 }
\ No newline at end of file
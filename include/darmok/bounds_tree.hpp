@@ -0,0 +1,147 @@
+#pragma once
+
+#include <darmok/export.h>
+#include <darmok/scene.hpp>
+#include <darmok/shape.hpp>
+#include <darmok/optional_ref.hpp>
+#include <darmok/protobuf/camera.pb.h>
+
+#include <vector>
+#include <unordered_set>
+#include <limits>
+#include <span>
+
+namespace darmok
+{
+    struct DARMOK_EXPORT BoundsTreeHit final
+    {
+        Entity entity;
+        float distance;
+    };
+
+    // dynamic bounding volume hierarchy of world space boxes
+    // leaves store a fat box so that small movements do not change the tree
+    class DARMOK_EXPORT BoundsTree final
+    {
+    public:
+        using NodeId = int32_t;
+        static constexpr NodeId nullNode = -1;
+
+        BoundsTree(float margin = 0.F) noexcept;
+
+        NodeId insert(Entity entity, const BoundingBox& bbox) noexcept;
+        void remove(NodeId node) noexcept;
+
+        // returns true if the node had to be reinserted
+        bool update(NodeId node, const BoundingBox& bbox) noexcept;
+        void clear() noexcept;
+
+        void setMargin(float margin) noexcept;
+        [[nodiscard]] float getMargin() const noexcept;
+        [[nodiscard]] size_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+        [[nodiscard]] int32_t getHeight() const noexcept;
+        [[nodiscard]] Entity getEntity(NodeId node) const noexcept;
+        [[nodiscard]] const BoundingBox& getBounds(NodeId node) const noexcept;
+
+        // entities are appended to the vector
+        void query(const Frustum& frustum, std::vector<Entity>& entities) const noexcept;
+        void query(const BoundingBox& bbox, std::vector<Entity>& entities) const noexcept;
+        void query(const Sphere& sphere, std::vector<Entity>& entities) const noexcept;
+
+        // entities not completely in front of any of the planes
+        void query(std::span<const Plane> planes, std::vector<Entity>& entities) const noexcept;
+
+        // returns the hits sorted by distance
+        [[nodiscard]] std::vector<BoundsTreeHit> raycast(const Ray& ray, float maxDistance = std::numeric_limits<float>::max()) const noexcept;
+
+    private:
+        struct Node final
+        {
+            // fat bounds used to build the tree
+            BoundingBox bounds;
+
+            // exact bounds, only set in leaves
+            BoundingBox leafBounds;
+            Entity entity = entt::null;
+
+            // next free node when the node is not used
+            NodeId parent = nullNode;
+            NodeId child1 = nullNode;
+            NodeId child2 = nullNode;
+
+            // leaves have height 0, free nodes -1
+            int32_t height = -1;
+
+            [[nodiscard]] bool isLeaf() const noexcept;
+        };
+
+        std::vector<Node> _nodes;
+        NodeId _root;
+        NodeId _freeNode;
+        size_t _leafAmount;
+        float _margin;
+
+        NodeId allocateNode() noexcept;
+        void freeNode(NodeId node) noexcept;
+        void insertLeaf(NodeId leaf) noexcept;
+        void removeLeaf(NodeId leaf) noexcept;
+        void refitParents(NodeId node) noexcept;
+        NodeId balance(NodeId node) noexcept;
+
+        template<typename NodeTest, typename LeafTest>
+        void traverse(const NodeTest& nodeTest, const LeafTest& leafTest) const noexcept;
+    };
+
+    class DARMOK_EXPORT SceneBoundsTree final : public ITypeSceneComponent<SceneBoundsTree>
+    {
+    public:
+        using Definition = protobuf::SceneBoundsTree;
+
+        static Definition createDefinition() noexcept;
+
+        SceneBoundsTree(const Definition& def = createDefinition()) noexcept;
+        expected<void, std::string> init(Scene& scene, App& app) noexcept override;
+        expected<void, std::string> load(const Definition& def) noexcept;
+        expected<void, std::string> shutdown() noexcept override;
+        expected<void, std::string> update(float deltaTime) noexcept override;
+
+        // syncs the tree with the entities whose bounds, renderable or inherited transform changed
+        // cameras call it before querying since they update before the scene components
+        // bounding boxes modified in place need to be patched in the registry to be noticed
+        void refit() noexcept;
+
+        [[nodiscard]] bool contains(Entity entity) const noexcept;
+        [[nodiscard]] const BoundsTree& getTree() const noexcept;
+
+        [[nodiscard]] std::vector<Entity> query(const Frustum& frustum) const noexcept;
+        [[nodiscard]] std::vector<Entity> query(const BoundingBox& bbox) const noexcept;
+        [[nodiscard]] std::vector<Entity> query(const Sphere& sphere) const noexcept;
+        [[nodiscard]] std::vector<BoundsTreeHit> raycast(const Ray& ray, float maxDistance = std::numeric_limits<float>::max()) const noexcept;
+
+    private:
+        Definition _def;
+        OptionalRef<Scene> _scene;
+        BoundsTree _tree;
+
+        // indexed by the entity index
+        struct Proxy final
+        {
+            Entity entity = entt::null;
+            BoundsTree::NodeId node = BoundsTree::nullNode;
+        };
+        std::vector<Proxy> _proxies;
+        std::unordered_set<Entity> _dirtyEntities;
+
+        void removeProxy(Proxy& proxy) noexcept;
+        void setAllDirty() noexcept;
+        void onEntityChanged(EntityRegistry& registry, Entity entity) noexcept;
+        void onTransformHierarchyChanged(EntityRegistry& registry, Entity entity) noexcept;
+
+        template<typename T>
+        void connectSignals(Scene& scene) noexcept;
+
+        template<typename T>
+        void disconnectSignals(Scene& scene) noexcept;
+    };
+}
@@ -4,8 +4,11 @@
 #include <darmok/render_scene.hpp>
 #include <darmok/optional_ref.hpp>
 #include <darmok/render_debug.hpp>
+#include <darmok/shape.hpp>
+#include <darmok/vertex_fwd.hpp>
 #include <darmok/protobuf/camera.pb.h>
 
+#include <span>
 #include <unordered_set>
 #include <unordered_map>
 #include <optional>
@@ -17,8 +20,10 @@
 namespace darmok
 {
     class Program;
+    class Mesh;
     struct MeshData;
     class FrameBuffer;
+    class SceneBoundsTree;
 
     class DARMOK_EXPORT OcclusionCuller final : public ITypeCameraComponent<OcclusionCuller>
     {
@@ -27,26 +32,56 @@ namespace darmok
 
         static Definition createDefinition() noexcept;
 
+        OcclusionCuller(const Definition& def = createDefinition()) noexcept;
         ~OcclusionCuller() noexcept;
         expected<void, std::string> init(Camera& cam, Scene& scene, App& app) noexcept override;
         expected<void, std::string> load(const Definition& def) noexcept;
         expected<bgfx::ViewId, std::string> renderReset(bgfx::ViewId viewId) noexcept override;
         expected<void, std::string> render() noexcept override;
         expected<void, std::string> shutdown() noexcept override;
-        expected<void, std::string> beforeRenderEntity(Entity entity, bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept override;
+        bool shouldEntityBeCulled(Entity entity) noexcept override;
     private:
+        Definition _def;
         OptionalRef<Camera> _cam;
         OptionalRef<Scene> _scene;
+        OptionalRef<App> _app;
         std::optional<bgfx::ViewId> _viewId;
         std::shared_ptr<Program> _prog;
+        std::unique_ptr<Mesh> _cubeMesh;
         std::unique_ptr<FrameBuffer> _frameBuffer;
-        std::unordered_map<Entity, bgfx::OcclusionQueryHandle> _queries;
-        std::vector<bgfx::OcclusionQueryHandle> _freeQueries;
+        size_t _nextQuery;
+        uint32_t _frame;
+
+        // fixed pool of handles reused by the entities queried each frame
+        struct QuerySlot final
+        {
+            bgfx::OcclusionQueryHandle handle;
+            Entity entity = entt::null;
+            uint32_t frame = 0;
+            bool submitted = false;
+        };
+        std::vector<QuerySlot> _querySlots;
+        uint32_t _queryPoolSize;
+
+        struct PendingQuery final
+        {
+            Entity entity;
+            glm::mat4 transform;
+            bgfx::OcclusionQueryHandle query;
+        };
+        std::vector<PendingQuery> _pendingQueries;
+
+        struct CachedResult final
+        {
+            bool occluded = false;
+            uint32_t frame = 0;
+        };
+        std::unordered_map<Entity, CachedResult> _results;
 
         expected<void, std::string> updateQueries() noexcept;
-        bgfx::OcclusionQueryHandle getQuery(Entity entity) noexcept;
+        void updateResults() noexcept;
+        void createQueries() noexcept;
         void onRenderableDestroyed(EntityRegistry& registry, Entity entity) noexcept;
-        std::optional<bgfx::OcclusionQueryResult::Enum> getQueryResult(Entity entity) const noexcept;
         void clearQueries() noexcept;
     };
 
@@ -65,8 +100,117 @@ namespace darmok
     private:
         OptionalRef<Camera> _cam;
         OptionalRef<Scene> _scene;
+
+        // world space bounds indexed by the entity index
+        struct BoundsArray final
+        {
+            std::vector<float> minX;
+            std::vector<float> minY;
+            std::vector<float> minZ;
+            std::vector<float> maxX;
+            std::vector<float> maxY;
+            std::vector<float> maxZ;
+
+            void resize(size_t size) noexcept;
+            void set(size_t index, const BoundingBox& bbox) noexcept;
+        };
+
+        struct BoundsState final
+        {
+            Entity entity = entt::null;
+            uint32_t version = 0;
+            BoundingBox localBounds;
+        };
+
+        BoundsArray _bounds;
+        std::vector<BoundsState> _boundsStates;
+        std::vector<uint8_t> _outside;
+        std::vector<uint64_t> _active;
+        std::vector<uint64_t> _culled;
+
+        // when the scene has a bounds tree it is queried instead
+        OptionalRef<const SceneBoundsTree> _tree;
+        std::vector<Entity> _treeEntities;
+        std::vector<uint64_t> _treeVisible;
+
+        void updateBounds() noexcept;
+        void updateCulled() noexcept;
+        void updateTreeVisible() noexcept;
+    };
+
+    // triangles rasterized by the SoftwareOcclusionCuller
+    // should be smaller than the renderable mesh so it does not occlude too much
+    struct DARMOK_EXPORT Occluder final
+    {
+        using Definition = protobuf::Occluder;
+
+        std::vector<glm::vec3> vertices;
+        std::vector<VertexIndex> indices;
+
+        Occluder() = default;
+        Occluder(const MeshData& data) noexcept;
+
+        static Definition createDefinition() noexcept;
+        expected<void, std::string> load(const Definition& def) noexcept;
+    };
+
+    // low resolution depth buffer with a pyramid of the farthest depth per texel
+    class DARMOK_EXPORT OcclusionDepthBuffer final
+    {
+    public:
+        OcclusionDepthBuffer(const glm::uvec2& size = glm::uvec2{ 0 }) noexcept;
+
+        void resize(const glm::uvec2& size) noexcept;
+        void clear() noexcept;
+        void rasterize(const glm::mat4& modelViewProj, std::span<const glm::vec3> vertices, std::span<const VertexIndex> indices) noexcept;
+        void buildPyramid() noexcept;
+
+        // conservative, boxes crossing the near plane or outside the screen are never occluded
+        [[nodiscard]] bool isOccluded(const glm::mat4& modelViewProj, const BoundingBox& bbox) const noexcept;
+
+        [[nodiscard]] const glm::uvec2& getSize() const noexcept;
+        [[nodiscard]] size_t getLevelAmount() const noexcept;
+        [[nodiscard]] float getDepth(const glm::uvec2& pos, size_t level = 0) const noexcept;
+
+    private:
+        struct Level final
+        {
+            glm::uvec2 size;
+            std::vector<float> depth;
+        };
+        std::vector<Level> _levels;
+        glm::uvec2 _size;
+
+        static const float _clearDepth;
+        static const float _minClipW;
+
+        void rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) noexcept;
+        glm::vec3 toScreen(const glm::vec4& clip) const noexcept;
+    };
+
+    class DARMOK_EXPORT SoftwareOcclusionCuller final : public ITypeCameraComponent<SoftwareOcclusionCuller>
+    {
+    public:
+        using Definition = protobuf::SoftwareOcclusionCuller;
+
+        static Definition createDefinition() noexcept;
+
+        SoftwareOcclusionCuller(const Definition& def = createDefinition()) noexcept;
+        expected<void, std::string> init(Camera& cam, Scene& scene, App& app) noexcept override;
+        expected<void, std::string> load(const Definition& def) noexcept;
+        expected<void, std::string> shutdown() noexcept override;
+        expected<void, std::string> update(float deltaTime) noexcept override;
+        bool shouldEntityBeCulled(Entity entity) noexcept override;
+
+        [[nodiscard]] const OcclusionDepthBuffer& getDepthBuffer() const noexcept;
+    private:
+        Definition _def;
+        OptionalRef<Camera> _cam;
+        OptionalRef<Scene> _scene;
+        OcclusionDepthBuffer _depth;
         std::unordered_set<Entity> _culled;
 
+        void updateDepth() noexcept;
         void updateCulled() noexcept;
     };
 
@@ -61,6 +61,8 @@ namespace darmok
         [[nodiscard]] std::string_view stringView(size_t offset = 0, size_t size = -1) const noexcept;
         [[nodiscard]] DataView view(size_t offset = 0, size_t size = -1) const noexcept;
         [[nodiscard]] const bgfx::Memory* makeRef(size_t offset = 0, size_t size = -1) const noexcept;
+        // the owner is kept alive until bgfx releases the memory
+        [[nodiscard]] const bgfx::Memory* makeRef(std::shared_ptr<const void> owner, size_t offset = 0, size_t size = -1) const noexcept;
         [[nodiscard]] const bgfx::Memory* copyMem(size_t offset = 0, size_t size = -1) const noexcept;
         [[nodiscard]] std::string toHex(size_t offset = 0, size_t size = -1) const noexcept;
         [[nodiscard]] std::string toHeader(std::string_view varName, size_t offset = 0, size_t size = -1) const noexcept;
@@ -148,12 +150,44 @@ namespace darmok
         static void* malloc(size_t size, const OptionalRef<bx::AllocatorI>& alloc) noexcept;
     };
 
+    // read only memory mapped file, pages are loaded when accessed
+    class DARMOK_EXPORT MappedFile final
+    {
+    public:
+        MappedFile() noexcept;
+        ~MappedFile() noexcept;
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        [[nodiscard]] const void* ptr() const noexcept;
+        [[nodiscard]] size_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+        [[nodiscard]] DataView view(size_t offset = 0, size_t size = -1) const noexcept;
+
+        void close() noexcept;
+
+        [[nodiscard]] static expected<MappedFile, std::string> open(const std::filesystem::path& path) noexcept;
+
+    private:
+        void* _ptr;
+        size_t _size;
+#if BX_PLATFORM_WINDOWS
+        void* _file;
+        void* _mapping;
+#endif
+    };
+
     class DARMOK_EXPORT BX_NO_VTABLE IDataLoader
     {
     public:
         using Resource = Data;
         virtual ~IDataLoader() = default;
         [[nodiscard]] virtual expected<Data, std::string> operator()(const std::filesystem::path& path) = 0;
+
+        // loaders that are not backed by files cannot map
+        [[nodiscard]] virtual expected<MappedFile, std::string> map(const std::filesystem::path& path) noexcept;
     };
 
     class DARMOK_EXPORT FileDataLoader final : public IDataLoader
@@ -169,11 +203,14 @@ namespace darmok
         void setAbsolutePathsAllowed(bool allowed) noexcept;
 
         [[nodiscard]] expected<Data, std::string> operator()(const std::filesystem::path& path) noexcept override;
+        [[nodiscard]] expected<MappedFile, std::string> map(const std::filesystem::path& path) noexcept override;
 	private:
         std::filesystem::path _basePath;
         std::unordered_set<std::filesystem::path> _rootPaths;
 		OptionalRef<bx::AllocatorI> _alloc;
         bool _absolutePathsAllowed;
+
+        [[nodiscard]] expected<std::filesystem::path, std::string> resolvePath(const std::filesystem::path& path) const noexcept;
 	};
 }
 
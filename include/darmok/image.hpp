@@ -97,6 +97,7 @@ namespace darmok
 
 		expected<Effect, std::string> prepare(const Input& input) noexcept override;
 		expected<void, std::string> operator()(const Input& input, Config& config) noexcept override;
+		std::unique_ptr<IFileTypeImporter> clone() const noexcept override;
 
 	private:
 		std::optional<std::array<std::filesystem::path, 6>> _cubemapFaces;
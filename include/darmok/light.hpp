@@ -7,9 +7,12 @@
 #include <darmok/color.hpp>
 #include <darmok/vertex.hpp>
 #include <darmok/shadow_fwd.hpp>
+#include <darmok/shape.hpp>
 #include <darmok/protobuf/light.pb.h>
 
 #include <unordered_map>
+#include <optional>
+#include <vector>
 
 namespace darmok
 {
@@ -135,7 +138,7 @@ namespace darmok
 
         static Definition createDefinition() noexcept;
 
-        LightingRenderComponent() noexcept;
+        LightingRenderComponent(const Definition& def = createDefinition()) noexcept;
         ~LightingRenderComponent() noexcept;
         expected<void, std::string> init(Camera& cam, Scene& scene, App& app) noexcept override;
         expected<void, std::string> load(const Definition& def) noexcept;
@@ -143,11 +146,14 @@ namespace darmok
         expected<void, std::string> update(float deltaTime)  noexcept override;
         expected<void, std::string> beforeRenderEntity(Entity entity, bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept override;
 
-
+        // world space bounds in the same order as the light buffers
+        [[nodiscard]] const std::vector<Sphere>& getPointLightBounds() const noexcept;
+        [[nodiscard]] const std::vector<Sphere>& getSpotLightBounds() const noexcept;
 
     private:
         OptionalRef<Scene> _scene;
         OptionalRef<Camera> _cam;
+        Definition _def;
 
         UniformHandle _lightCountUniform;
         UniformHandle _lightDataUniform;
@@ -157,19 +163,58 @@ namespace darmok
         DynamicVertexBuffer _dirLightBuffer;
         DynamicVertexBuffer _spotLightBuffer;
 
+        UniformHandle _clusterSizeUniform;
+        UniformHandle _clusterDepthUniform;
+        DynamicVertexBuffer _clusterBuffer;
+        DynamicVertexBuffer _clusterLightIndexBuffer;
+
         bgfx::VertexLayout _pointLightsLayout;
         bgfx::VertexLayout _dirLightsLayout;
         bgfx::VertexLayout _spotLightsLayout;
+        bgfx::VertexLayout _clustersLayout;
+        bgfx::VertexLayout _clusterLightIndicesLayout;
 
         glm::vec4 _lightCount;
         glm::vec4 _lightData;
         glm::vec4 _camPos;
+        glm::vec4 _clusterSize;
+        glm::vec4 _clusterDepth;
+
+        struct ClusterRange final
+        {
+            glm::uvec3 min;
+            glm::uvec3 max;
+        };
+
+        struct ClusterGrid final
+        {
+            glm::uvec3 size;
+            glm::mat4 view;
+            glm::mat4 proj;
+            float near;
+            float far;
+            bool logDepth;
+            float depthScale;
+            float depthBias;
+        };
+
+        std::vector<Sphere> _pointLightBounds;
+        std::vector<Sphere> _spotLightBounds;
+        std::vector<ClusterRange> _clusterRanges;
+        // x: light index offset, y: point light count, z: spot light count
+        std::vector<glm::uvec4> _clusters;
+        std::vector<uint32_t> _clusterLightIndices;
 
         size_t updatePointLights() noexcept;
         size_t updateSpotLights() noexcept;
         size_t updateDirLights() noexcept;
         void updateAmbientLights() noexcept;
         void updateCamera() noexcept;
+        void updateClusters() noexcept;
+        std::optional<ClusterGrid> getClusterGrid() const noexcept;
+        static std::optional<ClusterRange> getClusterRange(const Sphere& bounds, const ClusterGrid& grid) noexcept;
+        static uint32_t getClusterSlice(float depth, const ClusterGrid& grid) noexcept;
+        static Sphere calcSpotLightBounds(const glm::vec3& pos, const glm::vec3& dir, float range, float coneAngle) noexcept;
 
         void createHandles() noexcept;
         void destroyHandles() noexcept;
@@ -12,6 +12,10 @@
 #include <unordered_map>
 #include <fstream>
 #include <memory>
+#include <list>
+#include <mutex>
+#include <algorithm>
+#include <concepts>
 
 #include <bx/bx.h>
 
@@ -175,6 +179,10 @@ namespace darmok
         std::shared_ptr<Resource> forceLoad(Argument arg) noexcept override
         {
             auto res = doLoad(arg);
+            if (res)
+            {
+                res = track(arg, std::move(res));
+            }
             _cache[arg] = res;
             return res;
         }
@@ -207,13 +215,13 @@ namespace darmok
         {
             auto itr = std::find_if(_cache.begin(), _cache.end(), [&res](auto& elm)
             {
-                return elm.second.lock() == &res;
+                return elm.second.lock().get() == &res;
             });
             if (itr == _cache.end())
             {
                 return false;
             }
-
+            _cache.erase(itr);
             return true;
         }
 
@@ -222,18 +230,20 @@ namespace darmok
             _cache.clear();
         }
 
+        // only processes the resources released since the last call
         void pruneCache() noexcept override
         {
-            // remove cache items that don't have any references
-            for (auto itr = _cache.begin(); itr != _cache.end();)
+            std::vector<Argument> released;
             {
-                if (itr->second.lock() == nullptr)
-                {
-                    itr = _cache.erase(itr);
-                }
-                else
+                std::lock_guard lock{ _releaseQueue->mutex };
+                released.swap(_releaseQueue->released);
+            }
+            for (auto& arg : released)
+            {
+                auto itr = _cache.find(arg);
+                if (itr != _cache.end() && itr->second.expired())
                 {
-                    ++itr;
+                    _cache.erase(itr);
                 }
             }
         }
@@ -246,9 +256,9 @@ namespace darmok
 
         bool isResourceCached(const Resource& res) const noexcept override
         {
-            for (auto itr = _cache.begin(); itr != _cache.end();)
+            for (auto& [arg, weakRes] : _cache)
             {
-                if (itr->second.lock() == &res)
+                if (weakRes.lock().get() == &res)
                 {
                     return true;
                 }
@@ -259,7 +269,30 @@ namespace darmok
     protected:
         virtual std::shared_ptr<Resource> doLoad(Argument arg) = 0;
     private:
+        // arguments of the resources released by their last user, can happen in any thread
+        struct ReleaseQueue final
+        {
+            std::mutex mutex;
+            std::vector<Argument> released;
+        };
+
         std::unordered_map<Argument, std::weak_ptr<Resource>> _cache;
+        std::shared_ptr<ReleaseQueue> _releaseQueue = std::make_shared<ReleaseQueue>();
+
+        std::shared_ptr<Resource> track(const Argument& arg, std::shared_ptr<Resource> res) noexcept
+        {
+            auto ptr = res.get();
+            std::weak_ptr<ReleaseQueue> weakQueue = _releaseQueue;
+            return std::shared_ptr<Resource>(ptr, [weakQueue, arg, res = std::move(res)](Resource*) mutable
+            {
+                res.reset();
+                if (auto queue = weakQueue.lock())
+                {
+                    std::lock_guard lock{ queue->mutex };
+                    queue->released.push_back(std::move(arg));
+                }
+            });
+        }
     };
 
     template<typename Interface>
@@ -380,6 +413,14 @@ namespace darmok
         virtual bool releaseDefinitionCache(const Definition& def) noexcept = 0;
         virtual bool isDefinitionCached(const Definition& def) const noexcept = 0;
 
+        // used to cache definitions that were loaded outside of the loader (in another thread)
+        virtual void cacheDefinition(Argument arg, std::shared_ptr<Definition> def) noexcept = 0;
+
+        // bytes of released resources that are kept loaded, the least recently released are evicted first
+        virtual void setCacheBudget(size_t budget) noexcept = 0;
+        [[nodiscard]] virtual size_t getCacheBudget() const noexcept = 0;
+        [[nodiscard]] virtual size_t getRetainedCacheSize() const noexcept = 0;
+
         Result reload(Argument arg, bool forceDefinition = false) noexcept
         {
 			auto defResult = loadDefinition(arg, forceDefinition);
@@ -414,6 +455,10 @@ namespace darmok
 
         FromDefinitionLoader(DefinitionLoader& defLoader) noexcept
             : _defLoader{ defLoader }
+            , _lastTrackedId{ 0 }
+            , _releaseQueue{ std::make_shared<ReleaseQueue>() }
+            , _cacheBudget{ 0 }
+            , _retainedSize{ 0 }
         {
         }
 
@@ -472,11 +517,16 @@ namespace darmok
             auto defResult = _defLoader(arg);
             if (defResult)
             {
-                _defCache[arg] = defResult.value();
+                setDefinitionCache(arg, defResult.value());
             }
             return defResult;
         }
 
+        void cacheDefinition(Argument arg, std::shared_ptr<Definition> def) noexcept override
+        {
+            setDefinitionCache(arg, std::move(def));
+        }
+
         std::shared_ptr<Resource> getResource(const Definition& def) const noexcept override
         {
             auto ptr = &def;
@@ -500,25 +550,30 @@ namespace darmok
                 {
                     return res;
                 }
+                if (auto res = restoreRetained(def))
+                {
+                    return res;
+                }
             }
             auto result = create(def);
-            if (result)
+            if (!result)
             {
-                _resCache[def] = result.value();
+                return result;
             }
-            return result;
+            eraseRetained(def);
+            auto res = track(def, std::move(result).value());
+            _resCache[def] = res;
+            return res;
         }
 
         DefinitionResult reloadDefinition(const Definition& def) noexcept override
         {
-            auto ptr = &def;
-            auto itr = std::find_if(_defCache.begin(), _defCache.end(),
-                [ptr](auto& elm) { return elm.second.get() == ptr; });
-            if (itr == _defCache.end())
+            auto itr = _defArgs.find(&def);
+            if (itr == _defArgs.end())
             {
                 return unexpected<Error>{ "definition not found in cache" };
             }
-            return loadDefinition(itr->first, true);
+            return loadDefinition(itr->second, true);
         }
 
         Result reloadResource(const Definition& def) noexcept override
@@ -535,13 +590,12 @@ namespace darmok
             {
                 return nullptr;
 			}
-            auto itrDef = std::find_if(_defCache.begin(), _defCache.end(),
-                [ptr](auto& elm) { return elm.second.get() == ptr; });
-            if (itrDef == _defCache.end())
+            auto itrArg = _defArgs.find(ptr);
+            if (itrArg == _defArgs.end())
             {
                 return unexpected<Error>{ "definition not found in cache" };
             }
-            auto arg = itrDef->first;
+            auto arg = itrArg->second;
             auto defResult = _defLoader(arg);
             if (!defResult)
             {
@@ -555,8 +609,12 @@ namespace darmok
 			}
             _resCache.erase(itrRes);
 			_resCache[newDef] = res;
-            _defCache.erase(itrDef);
-            _defCache[arg] = newDef;
+            auto itrId = _trackedIds.find(res.get());
+            if (itrId != _trackedIds.end())
+            {
+                _tracked[itrId->second].def = newDef;
+            }
+            setDefinitionCache(arg, newDef);
             return res;
         }
 
@@ -581,12 +639,11 @@ namespace darmok
             {
                 return false;
             }
+            auto def = itr->second;
+            _defArgs.erase(def.get());
             _defCache.erase(itr);
-            auto itr2 = _resCache.find(itr->second);
-            if (itr2 != _resCache.end())
-            {
-                _resCache.erase(itr2);
-            }
+            _resCache.erase(def);
+            eraseRetained(def);
             return true;
         }
 
@@ -601,20 +658,22 @@ namespace darmok
         bool releaseDefinitionCache(const Definition& def) noexcept override
         {
 			auto ptr = &def;
-            auto itr = std::find_if(_defCache.begin(), _defCache.end(),
-                [ptr](auto& elm) { return elm.second.get() == ptr; });
-            auto found = itr != _defCache.end();
-            if (found)
+            auto found = false;
+            auto itrArg = _defArgs.find(ptr);
+            if (itrArg != _defArgs.end())
             {
-                _defCache.erase(itr);
+                found = true;
+                _defCache.erase(itrArg->second);
+                _defArgs.erase(itrArg);
             }
-            auto itr2 = std::find_if(_resCache.begin(), _resCache.end(),
+            auto itr = std::find_if(_resCache.begin(), _resCache.end(),
 				[ptr](auto& elm) { return elm.first.get() == ptr; });
-            ;
-            if (itr2 != _resCache.end())
+            if (itr != _resCache.end())
             {
                 found = true;
-                _resCache.erase(itr2);
+                auto defPtr = itr->first;
+                _resCache.erase(itr);
+                eraseRetained(defPtr);
             }
             return found;
         }
@@ -622,34 +681,84 @@ namespace darmok
         void clearCache() noexcept override
         {
             _defCache.clear();
+            _defArgs.clear();
             _resCache.clear();
+            _tracked.clear();
+            _trackedIds.clear();
+            _retained.clear();
+            _retainedIndex.clear();
+            _retainedSize = 0;
+            _unusedDefinitions.clear();
         }
 
+        // only processes the resources released since the last call
         void pruneCache() noexcept override
         {
-            // remove cache items that don't have any references
-            for (auto itr = _resCache.begin(); itr != _resCache.end();)
+            std::vector<Released> released;
+            {
+                std::lock_guard lock{ _releaseQueue->mutex };
+                released.swap(_releaseQueue->released);
+            }
+            for (auto& [id, res] : released)
             {
-                if (itr->second.lock() == nullptr)
+                auto itrTracked = _tracked.find(id);
+                if (itrTracked == _tracked.end())
                 {
-                    itr = _resCache.erase(itr);
+                    continue;
                 }
-                else
+                auto [def, ptr] = itrTracked->second;
+                _tracked.erase(itrTracked);
+                auto itrId = _trackedIds.find(ptr);
+                if (itrId != _trackedIds.end() && itrId->second == id)
                 {
-                    ++itr;
+                    _trackedIds.erase(itrId);
                 }
-            }
-            for (auto itr = _defCache.begin(); itr != _defCache.end();)
-            {
-                if (!_resCache.contains(itr->second))
+                auto itr = _resCache.find(def);
+                if (itr == _resCache.end() || !itr->second.expired())
+                {
+                    // released from the cache or loaded again in the meantime
+                    continue;
+                }
+                if (!res || _cacheBudget == 0)
                 {
-                    itr = _defCache.erase(itr);
+                    _resCache.erase(itr);
+                    eraseDefinition(def);
+                    continue;
                 }
-                else
+                retain(def, std::move(res));
+            }
+            evictRetained();
+
+            // definitions that were loaded but never used to create a resource
+            for (auto& weakDef : _unusedDefinitions)
+            {
+                auto def = weakDef.lock();
+                if (def && !_resCache.contains(def))
                 {
-                    ++itr;
+                    eraseDefinition(def);
                 }
             }
+            _unusedDefinitions.clear();
+        }
+
+        void setCacheBudget(size_t budget) noexcept override
+        {
+            _cacheBudget = budget;
+            {
+                std::lock_guard lock{ _releaseQueue->mutex };
+                _releaseQueue->retain = budget > 0;
+            }
+            evictRetained();
+        }
+
+        size_t getCacheBudget() const noexcept override
+        {
+            return _cacheBudget;
+        }
+
+        size_t getRetainedCacheSize() const noexcept override
+        {
+            return _retainedSize;
         }
     private:
 
@@ -764,9 +873,158 @@ namespace darmok
         }
 
     private:
+        // resources released by their last user, can happen in any thread
+        // the resource is only kept alive in the queue if it can be retained
+        struct Released final
+        {
+            uint64_t id;
+            std::shared_ptr<Resource> res;
+        };
+
+        struct ReleaseQueue final
+        {
+            std::mutex mutex;
+            std::vector<Released> released;
+            bool retain = false;
+        };
+
+        struct Tracked final
+        {
+            std::shared_ptr<Definition> def;
+            const Resource* ptr;
+        };
+
+        // released resources kept warm, ordered from most to least recently released
+        struct Retained final
+        {
+            std::shared_ptr<Definition> def;
+            std::shared_ptr<Resource> res;
+            size_t size;
+        };
+        using RetainedList = std::list<Retained>;
+
         DefinitionLoader& _defLoader;
         std::unordered_map<Argument, std::shared_ptr<Definition>> _defCache;
+        std::unordered_map<const Definition*, Argument> _defArgs;
         std::unordered_map<std::shared_ptr<Definition>, std::weak_ptr<Resource>> _resCache;
+        std::unordered_map<uint64_t, Tracked> _tracked;
+        std::unordered_map<const Resource*, uint64_t> _trackedIds;
+        uint64_t _lastTrackedId;
+        std::vector<std::weak_ptr<Definition>> _unusedDefinitions;
+        std::shared_ptr<ReleaseQueue> _releaseQueue;
+        RetainedList _retained;
+        std::unordered_map<std::shared_ptr<Definition>, typename RetainedList::iterator> _retainedIndex;
+        size_t _cacheBudget;
+        size_t _retainedSize;
+
+        void setDefinitionCache(const Argument& arg, std::shared_ptr<Definition> def) noexcept
+        {
+            auto& cachedDef = _defCache[arg];
+            if (cachedDef == def)
+            {
+                return;
+            }
+            if (cachedDef)
+            {
+                _defArgs.erase(cachedDef.get());
+            }
+            cachedDef = def;
+            _defArgs[def.get()] = arg;
+            _unusedDefinitions.push_back(def);
+        }
+
+        void eraseDefinition(const std::shared_ptr<Definition>& def) noexcept
+        {
+            auto itr = _defArgs.find(def.get());
+            if (itr == _defArgs.end())
+            {
+                return;
+            }
+            _defCache.erase(itr->second);
+            _defArgs.erase(itr);
+        }
+
+        // the returned pointer queues the resource in the loader when the last reference is gone
+        std::shared_ptr<Resource> track(const std::shared_ptr<Definition>& def, std::shared_ptr<Resource> res) noexcept
+        {
+            auto ptr = res.get();
+            auto id = ++_lastTrackedId;
+            _tracked[id] = Tracked{ def, ptr };
+            _trackedIds[ptr] = id;
+            std::weak_ptr<ReleaseQueue> weakQueue = _releaseQueue;
+            return std::shared_ptr<Resource>(ptr, [weakQueue, id, res = std::move(res)](Resource*) mutable
+            {
+                if (auto queue = weakQueue.lock())
+                {
+                    std::lock_guard lock{ queue->mutex };
+                    queue->released.push_back(Released{ id, queue->retain ? std::move(res) : nullptr });
+                }
+                // destroyed right away like an untracked resource, the weak references keep the deleter alive
+                res.reset();
+            });
+        }
+
+        static size_t getResourceSize(const Definition& def, const Resource& res) noexcept
+        {
+            if constexpr (requires(const Resource& r) { { r.getStorageSize() } -> std::convertible_to<size_t>; })
+            {
+                return res.getStorageSize();
+            }
+            else if constexpr (requires(const Definition& d) { { d.ByteSizeLong() } -> std::convertible_to<size_t>; })
+            {
+                return def.ByteSizeLong();
+            }
+            else
+            {
+                return sizeof(Resource);
+            }
+        }
+
+        void retain(const std::shared_ptr<Definition>& def, std::shared_ptr<Resource> res) noexcept
+        {
+            eraseRetained(def);
+            auto size = getResourceSize(*def, *res);
+            _retained.push_front(Retained{ def, std::move(res), size });
+            _retainedIndex[def] = _retained.begin();
+            _retainedSize += size;
+        }
+
+        void eraseRetained(const std::shared_ptr<Definition>& def) noexcept
+        {
+            auto itr = _retainedIndex.find(def);
+            if (itr == _retainedIndex.end())
+            {
+                return;
+            }
+            _retainedSize -= itr->second->size;
+            _retained.erase(itr->second);
+            _retainedIndex.erase(itr);
+        }
+
+        std::shared_ptr<Resource> restoreRetained(const std::shared_ptr<Definition>& def) noexcept
+        {
+            auto itr = _retainedIndex.find(def);
+            if (itr == _retainedIndex.end())
+            {
+                return nullptr;
+            }
+            auto retainedRes = std::move(itr->second->res);
+            eraseRetained(def);
+            auto res = track(def, std::move(retainedRes));
+            _resCache[def] = res;
+            return res;
+        }
+
+        void evictRetained() noexcept
+        {
+            while (_retainedSize > _cacheBudget && !_retained.empty())
+            {
+                auto def = _retained.back().def;
+                eraseRetained(def);
+                _resCache.erase(def);
+                eraseDefinition(def);
+            }
+        }
     };
 
 
@@ -886,5 +1144,42 @@ namespace darmok
             }
             return false;
         }
+
+        void setCacheBudget(size_t budget) noexcept override
+        {
+            for (auto& [loader, exts] : Base::_loaders)
+            {
+                loader.get().setCacheBudget(budget);
+            }
+        }
+
+        size_t getCacheBudget() const noexcept override
+        {
+            size_t budget = 0;
+            for (auto& [loader, exts] : Base::_loaders)
+            {
+                budget = std::max(budget, loader.get().getCacheBudget());
+            }
+            return budget;
+        }
+
+        size_t getRetainedCacheSize() const noexcept override
+        {
+            size_t size = 0;
+            for (auto& [loader, exts] : Base::_loaders)
+            {
+                size += loader.get().getRetainedCacheSize();
+            }
+            return size;
+        }
+
+        void cacheDefinition(std::filesystem::path path, std::shared_ptr<Definition> def) noexcept override
+        {
+            auto loaders = Base::getLoaders(path);
+            if (!loaders.empty())
+            {
+                loaders.front().get().cacheDefinition(path, std::move(def));
+            }
+        }
     };
 }
\ No newline at end of file
@@ -57,7 +57,17 @@ namespace darmok
     {
         using TextureType = protobuf::MaterialTexture::Type;
 
+        struct TextureSampler final
+        {
+            TextureType type;
+            uint8_t stage;
+            UniformHandle uniform;
+        };
+
         std::unordered_map<TextureType, TextureUniformKey> textureUniformKeys;
+
+        // resolved from the texture uniform keys so that drawing does not look up uniform names
+        std::vector<TextureSampler> textureSamplers;
         UniformHandleContainer uniformHandles;
 
         UniformHandle albedoLutSamplerUniform;
@@ -78,6 +88,20 @@ namespace darmok
 
         static MaterialRenderConfig createDefault() noexcept;
 
+        // needs to be called after changing the texture uniform keys
+        void updateTextureSamplers() noexcept;
+        void reset() noexcept;
+    };
+
+    struct Material;
+
+    // last material submitted to an encoder, its uniforms and textures are not set again
+    // only valid while the draws are rendered in the order they were submitted
+    struct DARMOK_EXPORT MaterialSubmitState final
+    {
+        const Material* material = nullptr;
+        bgfx::ViewId viewId = 0;
+
         void reset() noexcept;
     };
 
@@ -130,8 +154,10 @@ namespace darmok
         expected<void, std::string> load(const Definition& def, IProgramLoader& progLoader, ITextureLoader& texLoader) noexcept;
 
         [[nodiscard]] static Definition createDefinition() noexcept;
-        void renderSubmit(bgfx::ViewId viewId, bgfx::Encoder& encoder, OptionalRef<const RenderConfig> config = nullptr) const noexcept;
+        void renderSubmit(bgfx::ViewId viewId, bgfx::Encoder& encoder, OptionalRef<const RenderConfig> config = nullptr, const ProgramDefines& extraDefines = {}, uint32_t depth = 0, OptionalRef<MaterialSubmitState> submitState = nullptr) const noexcept;
         static uint16_t getDepthTestFlag(Definition::DepthTest) noexcept;
+    private:
+        void setUniforms(bgfx::Encoder& encoder, const RenderConfig& config) const noexcept;
     };
 
     class DARMOK_EXPORT MaterialAppComponent : public ITypeAppComponent<MaterialAppComponent>
@@ -142,7 +168,7 @@ namespace darmok
         expected<void, std::string> init(App& app) noexcept override;
         expected<void, std::string> update(float deltaTime) noexcept override;
         expected<void, std::string> shutdown() noexcept override;
-        void renderSubmit(bgfx::ViewId viewId, bgfx::Encoder& encoder, const Material& material) const noexcept;
+        void renderSubmit(bgfx::ViewId viewId, bgfx::Encoder& encoder, const Material& material, const ProgramDefines& extraDefines = {}, uint32_t depth = 0, OptionalRef<MaterialSubmitState> submitState = nullptr) const noexcept;
     private:
         std::optional<RenderConfig> _renderConfig;
     };
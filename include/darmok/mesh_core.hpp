@@ -87,6 +87,9 @@ namespace darmok
         [[nodiscard]] static expected<Mesh, std::string> load(const bgfx::VertexLayout& layout, DataView vertices, Config config = {}) noexcept;
         [[nodiscard]] static expected<Mesh, std::string> load(const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config = {}) noexcept;
         [[nodiscard]] static expected<Mesh, std::string> load(const Definition& def) noexcept;
+
+        // static meshes reference the definition data instead of copying it
+        [[nodiscard]] static expected<Mesh, std::string> load(const std::shared_ptr<const Definition>& def) noexcept;
     private:
         struct StaticMode final
         {
@@ -99,7 +102,8 @@ namespace darmok
             StaticMode(StaticMode&& other) = default;
             StaticMode& operator=(StaticMode&& other) = default;
 
-            static expected<StaticMode, std::string> create(const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config) noexcept;
+            // if an owner is passed the data is referenced and the owner kept alive until bgfx releases it
+            static expected<StaticMode, std::string> create(const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config, std::shared_ptr<const void> owner = nullptr) noexcept;
             expected<void, std::string> render(bgfx::Encoder& encoder, RenderConfig config = {}) const noexcept;
         };
 
@@ -136,7 +140,8 @@ namespace darmok
         using Mode = std::variant<StaticMode, DynamicMode, TransientMode>;
 
         Mesh(Type type, Mode mode, const bgfx::VertexLayout& layout, size_t vertNum, size_t idxNum) noexcept;
-        static expected<Mode, std::string> createMode(Type type, const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config) noexcept;
+        static expected<Mode, std::string> createMode(Type type, const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config, std::shared_ptr<const void> owner = nullptr) noexcept;
+        static expected<Mesh, std::string> load(const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config, std::shared_ptr<const void> owner) noexcept;
 
         Type _type;
         Mode _mode;
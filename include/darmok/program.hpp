@@ -47,6 +47,7 @@ namespace darmok
 	{
 	public:
 		using Defines = ProgramDefines;
+		using DefinesMask = uint64_t;
 		using ShaderHandles = std::unordered_map<Defines, ShaderOwnedHandle>;
 		using ProgramHandles = std::unordered_map<Defines, ProgramOwnedHandle>;
 		using Definition = protobuf::Program;
@@ -70,7 +71,13 @@ namespace darmok
 		static expected<Program, std::string> load(const Definition& def) noexcept;
 
 		[[nodiscard]] ProgramHandle getHandle(const Defines& defines = {}) const noexcept;
+		[[nodiscard]] ProgramHandle getHandle(const Defines& defines, const Defines& extraDefines) const noexcept;
+
+		// each define known by the program has a bit, unknown defines are ignored
+		[[nodiscard]] DefinesMask getDefinesMask(const Defines& defines) const noexcept;
+		[[nodiscard]] ProgramHandle getHandle(DefinesMask mask) const noexcept;
 		[[nodiscard]] const bgfx::VertexLayout& getVertexLayout() const noexcept;
+		[[nodiscard]] const Defines& getDefines() const noexcept;
 
 		template<class T>
         [[nodiscard]] static expected<Program, std::string> loadStaticMem(const T& mem) noexcept
@@ -100,6 +107,12 @@ namespace darmok
 		ShaderHandles _fragmentHandles;
 		ProgramHandles _handles;
 		bgfx::VertexLayout _vertexLayout;
+
+		// only used if the program has less defines than bits in the mask
+		std::unordered_map<std::string, DefinesMask> _defineMasks;
+		std::unordered_map<DefinesMask, ProgramHandle> _maskHandles;
+
+		void updateMasks() noexcept;
 	};
 
 	class DARMOK_EXPORT StandardProgramLoader final
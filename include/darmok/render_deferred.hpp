@@ -2,25 +2,84 @@
 
 #include <darmok/export.h>
 #include <darmok/render_scene.hpp>
+#include <darmok/render_queue.hpp>
+#include <darmok/render_chain.hpp>
 #include <darmok/optional_ref.hpp>
+#include <darmok/uniform.hpp>
+#include <darmok/shape.hpp>
+#include <darmok/program_core.hpp>
 #include <darmok/protobuf/camera.pb.h>
 
+#include <memory>
+#include <vector>
+#include <optional>
+
 namespace darmok
 {
     class Camera;
+    class Scene;
+    class App;
+    class Program;
+    class Mesh;
+    class Texture;
+    class MaterialAppComponent;
+    struct Material;
 
     class DARMOK_EXPORT DeferredRenderer final : public ITypeCameraComponent<DeferredRenderer>
     {
     public:
         using Definition = protobuf::DeferredRenderer;
 
+        static Definition createDefinition() noexcept;
+
+        DeferredRenderer(const Definition& def = createDefinition()) noexcept;
+        ~DeferredRenderer() noexcept;
         expected<void, std::string> init(Camera& cam, Scene& scene, App& app) noexcept override;
         expected<void, std::string> load(const Definition& def) noexcept;
         expected<bgfx::ViewId, std::string> renderReset(bgfx::ViewId viewId) noexcept override;
+        expected<void, std::string> render() noexcept override;
         expected<void, std::string> shutdown() noexcept override;
 
-        static Definition createDefinition() noexcept;
     private:
+        Definition _def;
         OptionalRef<Camera> _cam;
+        OptionalRef<Scene> _scene;
+        OptionalRef<App> _app;
+        OptionalRef<MaterialAppComponent> _materials;
+        std::optional<bgfx::ViewId> _geometryViewId;
+        std::optional<bgfx::ViewId> _lightViewId;
+        std::optional<bgfx::ViewId> _forwardViewId;
+
+        std::shared_ptr<Program> _lightProgram;
+        std::unique_ptr<Mesh> _screenMesh;
+        std::unique_ptr<Mesh> _sphereMesh;
+
+        // albedo, normal, material, emissive, depth
+        std::vector<std::shared_ptr<Texture>> _gbufferTextures;
+        FrameBufferOwnedHandle _gbuffer;
+        std::vector<UniformHandle> _gbufferUniforms;
+        UniformHandle _lightVecUniform;
+        UniformHandle _multipleScatteringUniform;
+
+        RenderQueue _geometryQueue;
+        RenderQueue _forwardQueue;
+
+        enum class LightType : uint8_t
+        {
+            Ambient,
+            Directional,
+            Point,
+            Spot
+        };
+
+        static const std::string _deferredDefine;
+        static const std::string _shadowDefine;
+
+        bool canBeDeferred(const Material& material) const noexcept;
+        expected<void, std::string> updateGBuffer(const glm::uvec2& size) noexcept;
+        void fillQueues() noexcept;
+        expected<void, std::string> renderQueue(bgfx::ViewId viewId, bgfx::Encoder& encoder, const RenderQueue& queue, const ProgramDefines& defines) const noexcept;
+        expected<void, std::string> renderLights(bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept;
+        expected<void, std::string> renderLight(bgfx::ViewId viewId, bgfx::Encoder& encoder, LightType type, size_t index, OptionalRef<const Sphere> bounds) noexcept;
     };
-}
\ No newline at end of file
+}
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <vector>
+#include <string>
 #include <darmok/export.h>
 #include <darmok/render_scene.hpp>
+#include <darmok/render_queue.hpp>
 #include <darmok/protobuf/camera.pb.h>
 
 namespace darmok
@@ -12,6 +15,8 @@ namespace darmok
     class App;
     class MaterialAppComponent;
     class EntityView;
+    struct Material;
+    struct MaterialSubmitState;
 
     class DARMOK_EXPORT ForwardRenderer final : public ITypeCameraComponent<ForwardRenderer>
     {
@@ -21,7 +26,7 @@ namespace darmok
 
         static Definition createDefinition() noexcept;
 
-        ForwardRenderer() noexcept;
+        ForwardRenderer(const Definition& def = createDefinition()) noexcept;
         ~ForwardRenderer() noexcept;
         expected<void, std::string> init(Camera& cam, Scene& scene, App& app) noexcept override;
         expected<void, std::string> load(const Definition& def) noexcept;
@@ -30,10 +35,28 @@ namespace darmok
         expected<void, std::string> shutdown() noexcept override;
 
     private:
+        Definition _def;
         OptionalRef<Camera> _cam;
         OptionalRef<Scene> _scene;
         OptionalRef<App> _app;
         OptionalRef<MaterialAppComponent> _materials;
         std::optional<bgfx::ViewId> _viewId;
+        RenderQueue _queue;
+
+        struct DrawGroup final
+        {
+            size_t start = 0;
+            size_t count = 0;
+        };
+        std::vector<DrawGroup> _groups;
+
+        static const std::string _instancingDefine;
+        static const std::string _skinningDefine;
+        static const uint16_t _instanceStride;
+
+        [[nodiscard]] bool canBeInstanced(const Material& material) const noexcept;
+        [[nodiscard]] size_t getInstanceGroupSize(size_t start, uint32_t usedInstances) const noexcept;
+        expected<void, std::string> renderGroup(bgfx::ViewId viewId, bgfx::Encoder& encoder, size_t index, MaterialSubmitState& submitState) const noexcept;
+        expected<void, std::string> renderInstances(bgfx::ViewId viewId, bgfx::Encoder& encoder, size_t index, MaterialSubmitState& submitState) const noexcept;
     };
 }
\ No newline at end of file
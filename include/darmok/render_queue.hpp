@@ -0,0 +1,50 @@
+#pragma once
+
+#include <darmok/export.h>
+#include <darmok/scene_fwd.hpp>
+#include <darmok/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace darmok
+{
+    struct Material;
+    class Mesh;
+
+    struct DARMOK_EXPORT RenderQueueItem final
+    {
+        uint64_t key = 0;
+        Entity entity = entt::null;
+    };
+
+    // collects draw calls and sorts them by a 64 bit key
+    // opaque: program, material, mesh, depth front to back
+    // transparent: depth back to front, program, material
+    class DARMOK_EXPORT RenderQueue final
+    {
+    public:
+        using Item = RenderQueueItem;
+        using Items = std::vector<Item>;
+
+        void clear() noexcept;
+        void add(Entity entity, const Material& material, const Mesh& mesh, float depth) noexcept;
+        void sort() noexcept;
+
+        [[nodiscard]] const Items& getItems() const noexcept;
+        [[nodiscard]] size_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+
+        [[nodiscard]] static uint64_t createOpaqueKey(uint16_t program, uint16_t material, uint16_t mesh, float depth) noexcept;
+        [[nodiscard]] static uint64_t createTransparentKey(uint16_t program, uint16_t material, float depth) noexcept;
+        static void radixSort(Items& items, Items& tmp) noexcept;
+
+    private:
+        Items _items;
+        Items _tmpItems;
+        std::unordered_map<const Material*, uint16_t> _materialIds;
+
+        uint16_t getMaterialId(const Material& material) noexcept;
+    };
+}
@@ -36,6 +36,11 @@ namespace darmok
         virtual expected<void, std::string> shutdown() noexcept { return {}; }
         virtual bool shouldEntityBeCulled(Entity entity) { return false; }
         virtual expected<void, std::string> beforeRenderView(bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept { return {}; }
+
+        // the renderers record the entities from multiple threads at the same time, each one with its own encoder
+        // implementations can only read the scene and their own state, and write to the given encoder
+        // state that changes every frame should be prepared in update or render, which run on the main thread
+        // component storages other than Transform and Renderable need to be created in init (see Scene::createComponentStorage)
         virtual expected<void, std::string> beforeRenderEntity(Entity entity, bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept { return {}; }
         virtual void onCameraTransformChanged() noexcept {}
         // virtual expected<void, std::string> afterLoad() noexcept { return {}; }
@@ -69,6 +74,8 @@ namespace darmok
         Renderable& setMaterial(const std::shared_ptr<Material>& material) noexcept;
         bool isEnabled() const noexcept;
         Renderable& setEnabled(bool enabled) noexcept;
+        bool isShadowCaster() const noexcept;
+        Renderable& setShadowCaster(bool caster) noexcept;
         bgfx::VertexLayout getVertexLayout() const noexcept;
 
         bool valid() const noexcept;
@@ -81,6 +88,7 @@ namespace darmok
 
     private:
         bool _enabled;
+        bool _shadowCaster;
         std::shared_ptr<Mesh> _mesh;
         std::shared_ptr<Material> _material;
     };
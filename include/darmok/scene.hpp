@@ -430,12 +430,21 @@ namespace darmok
             return components;
         }
 
+        // entt creates the storages the first time a type is accessed
+        // so the ones read from multiple threads need to be created beforehand
+        template<typename T>
+        void createComponentStorage() noexcept
+        {
+            getRegistry().storage<T>();
+        }
+
         template<typename T>
         auto onConstructComponent()
         {
             return getRegistry().on_construct<T>();
         }
 
+        // transforms are notified when the scene update changes their world matrix
         template<typename T>
         auto onUpdateComponent()
         {
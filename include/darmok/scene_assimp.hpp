@@ -85,6 +85,7 @@ namespace darmok
         const std::string& getName() const noexcept override;
         expected<Effect, std::string> prepare(const Input& input) noexcept override;
         expected<void, std::string> operator()(const Input& input, Config& config) noexcept override;
+        std::unique_ptr<IFileTypeImporter> clone() const noexcept override;
 
         AssimpSceneFileImporter& setBgfxShadercPath(const std::filesystem::path& path) noexcept;
         AssimpSceneFileImporter& addBgfxShaderIncludePath(const std::filesystem::path& path) noexcept;
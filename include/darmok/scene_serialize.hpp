@@ -382,6 +382,7 @@ namespace darmok
     class Scene;
     class AssetPack;
     class AssetPackConfig;
+    class AssetPackFile;
 
     struct ComponentRef final
     {
@@ -616,6 +617,10 @@ namespace darmok
 
         EntityResult operator()(const Definition& sceneDef, Scene& scene) noexcept;
 
+        // loads the scene written in the pack, assets are unpacked on demand
+        // so the pack needs to outlive the loader asset pack
+        EntityResult operator()(const AssetPackFile& pack, Scene& scene) noexcept;
+
         IComponentLoadContext& getComponentLoadContext() noexcept;
         const IComponentLoadContext& getComponentLoadContext() const noexcept;
         AssetPack& getAssetPack() noexcept;
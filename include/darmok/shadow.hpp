@@ -2,12 +2,18 @@
 
 #include <memory>
 #include <vector>
+#include <optional>
+#include <unordered_map>
 #include <darmok/export.h>
 #include <darmok/render_scene.hpp>
 #include <darmok/render_debug.hpp>
+#include <darmok/render_chain.hpp>
 #include <darmok/scene_filter.hpp>
 #include <darmok/program.hpp>
+#include <darmok/shape.hpp>
+#include <darmok/shadow_fwd.hpp>
 #include <darmok/protobuf/camera.pb.h>
+#include <darmok/protobuf/light.pb.h>
 
 namespace darmok
 {
@@ -16,25 +22,92 @@ namespace darmok
     class ShadowRenderer;
     class SpotLight;
     class PointLight;
+    class SceneBoundsTree;
+
+    struct DARMOK_EXPORT ShadowAtlasTile final
+    {
+        uint16_t layer = 0;
+
+        // level 0 covers the whole layer, each level halves the size
+        uint8_t level = 0;
+
+        // in cells of the max level
+        glm::uvec2 position{ 0 };
+
+        bool operator==(const ShadowAtlasTile& other) const noexcept = default;
+    };
+
+    // allocates square power of two tiles in the layers of the shadow map texture
+    class DARMOK_EXPORT ShadowAtlas final
+    {
+    public:
+        ShadowAtlas(uint16_t layerAmount = 0, uint8_t maxLevel = 0) noexcept;
+
+        // frees all the tiles
+        void reset(uint16_t layerAmount, uint8_t maxLevel) noexcept;
+        void clear() noexcept;
+
+        [[nodiscard]] std::optional<ShadowAtlasTile> allocate(uint8_t level) noexcept;
+
+        // returns false if the tile is not free
+        bool reserve(const ShadowAtlasTile& tile) noexcept;
+        void release(const ShadowAtlasTile& tile) noexcept;
+
+        [[nodiscard]] uint16_t getLayerAmount() const noexcept;
+        [[nodiscard]] uint8_t getMaxLevel() const noexcept;
+        [[nodiscard]] bool isFree(const ShadowAtlasTile& tile) const noexcept;
+
+        // xy: offset, z: scale in layer texture coordinates
+        [[nodiscard]] glm::vec3 getRect(const ShadowAtlasTile& tile) const noexcept;
+
+        // xy: position, zw: size in texels
+        [[nodiscard]] glm::uvec4 getViewport(const ShadowAtlasTile& tile, uint32_t layerSize) const noexcept;
+
+    private:
+        uint16_t _layerAmount;
+        uint8_t _maxLevel;
+        std::vector<bool> _cells;
+
+        [[nodiscard]] uint32_t getSide() const noexcept;
+        [[nodiscard]] uint32_t getTileSide(uint8_t level) const noexcept;
+        [[nodiscard]] bool isValid(const ShadowAtlasTile& tile) const noexcept;
+        void setCells(const ShadowAtlasTile& tile, bool used) noexcept;
+    };
 
     class DARMOK_EXPORT ShadowRenderPass final
     {
     public:
         ShadowRenderPass();
-        void init(ShadowRenderer& renderer, uint16_t index) noexcept;
+        void init(ShadowRenderer& renderer) noexcept;
         void shutdown() noexcept;
-        void configure(Entity entity = entt::null, uint8_t part = 0) noexcept;
+        void configure(Entity entity = entt::null, uint8_t part = 0, const ShadowAtlasTile& tile = {}) noexcept;
 
         bgfx::ViewId renderReset(bgfx::ViewId viewId) noexcept;
+
+        // configures the view, returns false if there is nothing to render
+        bool prepare() noexcept;
+
+        // can be called from any thread after prepare
+        // does nothing if the light and the casters did not change
         void render(bgfx::Encoder& encoder) noexcept;
+
+        // forces rendering the shadow map in the next frame
+        void invalidate() noexcept;
     private:
         std::optional<bgfx::ViewId> _viewId;
         Entity _lightEntity;
         uint8_t _part;
-        bgfx::FrameBufferHandle _fb;
+        ShadowAtlasTile _tile;
+        glm::mat4 _viewProj;
         OptionalRef<ShadowRenderer> _renderer;
+        std::vector<Entity> _entities;
+        bool _cached;
+        size_t _cachedHash;
+        glm::mat4 _cachedViewProj;
 
-        void renderEntities(bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept;
+        // returns the hash of the casters state, empty if it cannot be cached
+        std::optional<size_t> updateEntities() noexcept;
+        void renderEntities(bgfx::ViewId viewId, bgfx::Encoder& encoder) const noexcept;
         void configureView() noexcept;
     };
 
@@ -56,11 +129,19 @@ namespace darmok
 
         bool isEnabled() const noexcept;
 
+        // renders all the shadow maps in the next frame
+        // needed if a caster mesh is modified in place
+        void invalidateCache() noexcept;
+
         glm::mat4 getCameraProjMatrix(uint8_t cascade = 0) const noexcept;
         
-        glm::mat4 getDirLightMatrix(const OptionalRef<const Transform>& lightTrans, uint8_t cascade = 0) const noexcept;
-        glm::mat4 getDirLightProjMatrix(const OptionalRef<const Transform>& lightTrans, uint8_t cascade = 0) const noexcept;
-        glm::mat4 getDirLightMapMatrix(const OptionalRef<const Transform>& lightTrans, uint8_t cascade = 0) const noexcept;
+        // bounding sphere of the camera frustum slice in world space
+        const Sphere& getCascadeSphere(uint8_t cascade = 0) const noexcept;
+
+        // the projections of the lights with shadow maps are fixed in the update
+        glm::mat4 getDirLightMatrix(Entity entity, uint8_t cascade = 0) const noexcept;
+        glm::mat4 getDirLightProjMatrix(Entity entity, uint8_t cascade = 0) const noexcept;
+        glm::mat4 getDirLightMapMatrix(Entity entity, uint8_t cascade = 0) const noexcept;
 
         glm::mat4 getSpotLightMatrix(const SpotLight& light, const OptionalRef<const Transform>& lightTrans) const noexcept;
         glm::mat4 getSpotLightProjMatrix(const SpotLight& light) const noexcept;
@@ -75,10 +156,20 @@ namespace darmok
         const Definition& getDefinition() const noexcept;
         ProgramHandle getProgramHandle() const noexcept;
         TextureHandle getTextureHandle() const noexcept;
+        bgfx::FrameBufferHandle getLayerFrameBuffer(uint16_t layer) const noexcept;
+        const ShadowAtlas& getAtlas() const noexcept;
         OptionalRef<Camera> getCamera() noexcept;
         OptionalRef<Scene> getScene() noexcept;
         OptionalRef<const Camera> getCamera() const noexcept;
         OptionalRef<const Scene> getScene() const noexcept;
+        const std::vector<Entity>& getCasters() const noexcept;
+
+        // world bounds of the casters, empty if the caster has no bounds
+        const std::vector<std::optional<BoundingBox>>& getCasterBounds() const noexcept;
+
+        // casters indexed in the scene bounds tree are not in getCasters
+        bool isTreeCaster(Entity entity) const noexcept;
+        OptionalRef<const SceneBoundsTree> getBoundsTree() const noexcept;
 
     private:
         Definition _def;
@@ -87,13 +178,43 @@ namespace darmok
         OptionalRef<App> _app;
         std::unique_ptr<Program> _program;
         std::vector<ShadowRenderPass> _passes;
+        std::vector<std::reference_wrapper<ShadowRenderPass>> _activePasses;
+        std::vector<Entity> _casters;
+        std::vector<std::optional<BoundingBox>> _casterBounds;
+        OptionalRef<const SceneBoundsTree> _tree;
+        std::vector<uint64_t> _treeCasters;
         std::unique_ptr<Texture> _tex;
+        std::vector<FrameBufferOwnedHandle> _layerFbs;
         std::vector<glm::mat4> _camProjs;
+        std::vector<Sphere> _cascadeSpheres;
+        uint32_t _frameCount;
         glm::mat4 _crop;
         size_t _dirAmount;
         size_t _spotAmount;
         size_t _pointAmount;
 
+        struct LightShadow final
+        {
+            Entity entity;
+            ShadowLightType lightType;
+            protobuf::Light::ShadowType shadowType;
+            float importance;
+            uint8_t level;
+            std::vector<ShadowAtlasTile> tiles;
+        };
+
+        // shadowed lights sorted by importance, one pass per tile
+        std::vector<LightShadow> _lights;
+        ShadowAtlas _atlas;
+        std::unordered_map<Entity, std::vector<ShadowAtlasTile>> _lightTiles;
+
+        struct DirLightCascade final
+        {
+            glm::mat4 proj;
+            ShadowAtlasTile tile;
+        };
+        std::unordered_map<Entity, std::vector<DirLightCascade>> _dirLightCascades;
+
         UniformHandle _shadowMapUniform;
         UniformHandle _shadowData1Uniform;
         UniformHandle _shadowData2Uniform;
@@ -106,8 +227,18 @@ namespace darmok
 
         void updateCamera() noexcept;
         void updateLights() noexcept;
+        void collectLights() noexcept;
+        void allocateTiles() noexcept;
         void updateBuffers() noexcept;
+        void updateCasters() noexcept;
+        void updateDirLightCascades() noexcept;
+        glm::mat4 calcDirLightProjMatrix(Entity entity, uint8_t cascade, uint32_t mapSize, bool fitCasters) const noexcept;
+        std::optional<float> getCasterNearDepth(const OptionalRef<const Transform>& lightTrans, const BoundingBox& lightBounds) const noexcept;
+        uint32_t getCascadeUpdateInterval(uint8_t cascade) const noexcept;
         size_t getShadowMapAmount() const noexcept;
+        uint16_t getLayerAmount() const noexcept;
+        uint8_t getMaxTileLevel() const noexcept;
+        size_t getLightPassAmount(ShadowLightType type) const noexcept;
 
         void configureUniforms(bgfx::Encoder& encoder) const noexcept;
         void drawDebug() noexcept;
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <cstdint>
+
 namespace darmok
 {
-
-}
\ No newline at end of file
+    enum class ShadowLightType : uint8_t
+    {
+        Dir,
+        Spot,
+        Point
+    };
+}
@@ -340,6 +340,9 @@ namespace darmok
         [[nodiscard]] std::optional<NormalIntersection> intersectNormal(const Sphere& sphere) const noexcept;
         [[nodiscard]] std::optional<DistanceIntersection> intersect(const Triangle& tri) const noexcept;
 
+        // returns distance to ray origin, 0 if the origin is inside
+        [[nodiscard]] std::optional<float> intersect(const BoundingBox& bbox) const noexcept;
+
         [[nodiscard]] static Ray unproject(const glm::vec2& screenPosition, const glm::mat4& model, const glm::mat4& proj, const Viewport& viewport = {}) noexcept;
     };
 
@@ -408,6 +411,9 @@ namespace darmok
 
         [[nodiscard]] BoundingBox getBoundingBox() const noexcept;
 
+        // smallest sphere centered on the axis that contains all the corners
+        [[nodiscard]] Sphere getBoundingSphere() const noexcept;
+
         [[nodiscard]] std::array<glm::vec3, 4> getSlopes() const noexcept;
         [[nodiscard]] Frustum getSlice(float nearFactor, float farFactor) const noexcept;
 
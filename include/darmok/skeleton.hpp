@@ -7,21 +7,19 @@
 #include <darmok/asset_core.hpp>
 #include <darmok/glm.hpp>
 #include <darmok/easing.hpp>
+#include <darmok/vertex.hpp>
 #include <darmok/protobuf/skeleton.pb.h>
 
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <optional>
+#include <functional>
 
 #include <bx/bx.h>
 #include <nlohmann/json.hpp>
 
-
-#ifndef DARMOK_SKELETON_MAX_BONES
-#define DARMOK_SKELETON_MAX_BONES 64
-#endif
-
 namespace darmok
 {
     class SkeletonImpl;
@@ -289,10 +287,25 @@ namespace darmok
         PlaybackState getPlaybackState() noexcept;
         
         glm::mat4 getJointModelMatrix(const std::string& node) const noexcept;
+        glm::mat4 getJointModelMatrix(size_t index) const noexcept;
+        std::optional<size_t> getJointIndex(std::string_view name) const noexcept;
         std::unordered_map<std::string, glm::mat4> getJointModelMatrixes(const glm::vec3& dir = {1, 0, 0}) const noexcept;
+        std::shared_ptr<Skeleton> getSkeleton() const noexcept;
+
+        // changes every time the joint matrices change
+        uint32_t getVersion() const noexcept;
 
+        // same as updatePose followed by updateEvents
         expected<void, std::string> update(float deltaTime) noexcept;
 
+        // only modifies the animator so different animators can be updated in parallel
+        // without sample only the time advances, the joints keep their pose
+        // with interpolation the joints blend the last two samples by that factor
+        expected<void, std::string> updatePose(float deltaTime, bool sample = true, std::optional<float> interpolation = std::nullopt) noexcept;
+
+        // calls the listeners and changes the state, has to be called from the main thread
+        void updateEvents() noexcept;
+
         expected<void, std::string> load(const Definition& def, IComponentLoadContext& ctxt) noexcept;
 		static Definition createDefinition() noexcept;
 
@@ -303,6 +316,7 @@ namespace darmok
     class Transform;
     struct Material;
     class IFont;
+    class Skinnable;
 
     class DARMOK_EXPORT RenderableSkeleton final
     {
@@ -324,13 +338,55 @@ namespace darmok
     public:
         using Definition = protobuf::SkeletalAnimationSceneComponent;
 
+        SkeletalAnimationSceneComponent(const Definition& def = createDefinition()) noexcept;
         expected<void, std::string> init(Scene& scene, App& app) noexcept override;
+        expected<void, std::string> shutdown() noexcept override;
         expected<void, std::string> update(float deltaTime) noexcept override;
 
+        // updates the stale skinnables and uploads the palettes that changed
+        // does nothing if called again in the same frame
+        void updateSkinning() noexcept;
+
+        // 3 rows of the 3x4 skinning matrix per joint of every skinnable
+        [[nodiscard]] const DynamicVertexBuffer& getSkinningBuffer() const noexcept;
+
 		static Definition createDefinition() noexcept;
 		expected<void, std::string> load(const Definition& def) noexcept;
     private:
+        Definition _def;
         OptionalRef<Scene> _scene;
+        OptionalRef<App> _app;
+        uint32_t _frameCount;
+        bgfx::VertexLayout _skinningLayout;
+        DynamicVertexBuffer _skinningBuffer;
+        uint32_t _skinningSize;
+
+        struct SkinningUpdate final
+        {
+            std::reference_wrapper<Skinnable> skinnable;
+            std::reference_wrapper<const SkeletalAnimator> animator;
+        };
+
+        struct PoseUpdate final
+        {
+            std::reference_wrapper<SkeletalAnimator> animator;
+            bool sample = true;
+            std::optional<float> interpolation;
+            expected<void, std::string> result;
+        };
+
+        std::vector<PoseUpdate> _poseUpdates;
+        std::vector<SkinningUpdate> _skinningUpdates;
+        std::vector<std::reference_wrapper<const Skinnable>> _skinnables;
+
+        // false if all the skinned meshes of the animator are culled
+        std::unordered_map<const SkeletalAnimator*, bool> _animatorsVisible;
+        std::vector<glm::vec3> _cameraPositions;
+
+        static const size_t _minParallelUpdates;
+
+        void updateVisibility() noexcept;
+        PoseUpdate createPoseUpdate(Entity entity, SkeletalAnimator& animator) const noexcept;
     };
 
     class DARMOK_EXPORT SkeletalAnimationRenderComponent final : public ITypeCameraComponent<SkeletalAnimationRenderComponent>
@@ -338,16 +394,17 @@ namespace darmok
     public:
 		using Definition = protobuf::SkeletalAnimationRenderComponent;
         expected<void, std::string> init(Camera& cam, Scene& scene, App& app) noexcept override;
+        expected<void, std::string> render() noexcept override;
         expected<void, std::string> beforeRenderEntity(Entity entity, bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept override;
         expected<void, std::string> shutdown() noexcept override;
 
         static Definition createDefinition() noexcept;
         expected<void, std::string> load(const Definition& def) noexcept;
     private:
-        UniformHandle _skinningUniform;
-        std::vector<glm::mat4> _skinning;
+        UniformHandle _skinningDataUniform;
         OptionalRef<Scene> _scene;
         OptionalRef<Camera> _cam;
+        OptionalRef<SkeletalAnimationSceneComponent> _animations;
         OptionalRef<SkeletalAnimator> getAnimator(Entity entity) const noexcept;
     };
 
@@ -355,6 +412,7 @@ namespace darmok
     {
     public:
 		SkeletalAnimatorDefinitionFileImporter() noexcept;
+        std::unique_ptr<IFileTypeImporter> clone() const noexcept override;
     private:
 		FileDataLoader _dataLoader;
         DataSkeletalAnimatorDefinitionLoader _loader;
@@ -401,7 +459,29 @@ namespace darmok
 
         static Definition createDefinition() noexcept;
 
+        // calculates the skinning matrices (joint model * inverse bind pose)
+        // the armature joints are resolved to skeleton indices only when the animator skeleton changes
+        void updateSkinning(const SkeletalAnimator& animator) noexcept;
+
+        // false if the animator changed since the last skinning update
+        [[nodiscard]] bool isSkinningUpdated(const SkeletalAnimator& animator) const noexcept;
+
+        // the first matrix is the identity for the unskinned vertices
+        [[nodiscard]] const std::vector<glm::mat4>& getSkinning() const noexcept;
+
+        // index of the first matrix in the scene skinning buffer
+        [[nodiscard]] uint32_t getSkinningOffset() const noexcept;
+        void setSkinningOffset(uint32_t offset) noexcept;
+
     private:
         std::shared_ptr<Armature> _armature;
+        std::vector<std::optional<size_t>> _jointIndices;
+        OptionalRef<const Skeleton> _jointsSkeleton;
+        OptionalRef<const SkeletalAnimator> _skinningAnimator;
+        uint32_t _skinningVersion;
+        uint32_t _skinningOffset;
+        std::vector<glm::mat4> _skinning;
+
+        void resolveJoints(const SkeletalAnimator& animator) noexcept;
     };
 }
\ No newline at end of file
@@ -64,6 +64,7 @@ namespace darmok
         expected<void, std::string> shutdown() noexcept override;
         expected<Effect, std::string> prepare(const Input& input) noexcept override;
         expected<void, std::string> operator()(const Input& input, Config& config) noexcept override;
+        std::unique_ptr<IFileTypeImporter> clone() const noexcept override;
     private:
         std::unique_ptr<FreetypeFontFileImporterImpl> _impl;
     };
@@ -130,6 +130,9 @@ namespace darmok
 		static expected<Texture, std::string> load(const DataView& data, const Config& cfg, uint64_t flags = defaultTextureLoadFlags) noexcept;
 		static expected<Texture, std::string> load(const Definition& definition) noexcept;
 
+		// references the definition data instead of copying it
+		static expected<Texture, std::string> load(const std::shared_ptr<const Definition>& definition) noexcept;
+
 		static UniformKey createUniformKey(const std::string& name, uint8_t stage) noexcept;
 
 		[[nodiscard]] expected<void, std::string> update(const DataView& data, uint8_t mip = 0);
@@ -199,6 +202,7 @@ namespace darmok
 	{
 	public:
 		TextureFileImporter();
+		std::unique_ptr<IFileTypeImporter> clone() const noexcept override;
 	private:
 		bx::DefaultAllocator _alloc;
 		FileDataLoader _dataLoader;
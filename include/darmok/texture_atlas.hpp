@@ -143,6 +143,7 @@ namespace darmok
 		expected<void, std::string> init(OptionalRef<std::ostream> log) noexcept override;
 		expected<Effect, std::string> prepare(const Input& input) noexcept override;
 		expected<void, std::string> operator()(const Input& input, Config& config) noexcept override;
+		std::unique_ptr<IFileTypeImporter> clone() const noexcept override;
 	private:
 		static const std::unordered_map<std::string, std::string> _textureFormatExts;
 		static const std::unordered_map<std::string, std::string> _sheetFormatExts;
@@ -80,9 +80,19 @@ namespace darmok
         const glm::mat4& getWorldMatrix() const noexcept;
         const glm::mat4& getWorldInverse() const noexcept;
 
+        // updates the parent first if it changed
         bool update() noexcept;
         void reset() noexcept;
 
+        // true if the world matrix needs to be updated
+        bool isDirty() const noexcept;
+
+        // amount of parents, used to update parents before children
+        uint32_t getDepth() const noexcept;
+
+        // incremented every time update changes the world matrix
+        uint32_t getVersion() const noexcept;
+
         glm::vec3 getEulerAngles() const noexcept;
         glm::vec3 getForward() const noexcept;
         glm::vec3 getRight() const noexcept;
@@ -115,12 +125,15 @@ namespace darmok
 
         bool _matrixChanged;
         bool _parentChanged;
+        uint32_t _version;
+        uint32_t _depth;
         OptionalRef<Transform> _parent;
         Children _children;
 
         void setMatrixChanged() noexcept;
         void setParentChanged() noexcept;
         void setChildrenParentChanged() noexcept;
+        void updateDepth() noexcept;
     };
 }
 
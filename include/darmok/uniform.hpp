@@ -8,6 +8,7 @@
 #include <string>
 #include <random>
 #include <unordered_map>
+#include <shared_mutex>
 
 #include <bgfx/bgfx.h>
 
@@ -107,8 +108,8 @@ namespace darmok
         UniformHandleContainer() = default;
         UniformHandleContainer(const UniformHandleContainer& other) = delete;
         UniformHandleContainer& operator=(const UniformHandleContainer& other) = delete;
-        UniformHandleContainer(UniformHandleContainer&& other) = default;
-        UniformHandleContainer& operator=(UniformHandleContainer&& other) = default;
+        UniformHandleContainer(UniformHandleContainer&& other) noexcept;
+        UniformHandleContainer& operator=(UniformHandleContainer&& other) noexcept;
 
         void configure(bgfx::Encoder& encoder, const UniformValueMap& values) const noexcept;
         void configure(bgfx::Encoder& encoder, const UniformTextureMap& textures) const noexcept;
@@ -138,6 +139,8 @@ namespace darmok
 
         const UniformHandle& getHandle(const Key& key) const noexcept;
 
+        // handles are created lazily while recording from multiple encoders
+        mutable std::shared_mutex _handlesMutex;
         mutable std::unordered_map<Key, UniformHandle, Key::Hash> _handles;
     };
 }
\ No newline at end of file
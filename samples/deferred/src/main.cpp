@@ -195,7 +195,7 @@ namespace
 			auto shadowDef = ShadowRenderer::createDefinition();
 			shadowDef.set_cascade_amount(2);
 
-			cam.tryAddComponent<ForwardRenderer>();
+			cam.tryAddComponent<DeferredRenderer>();
 			// cam.tryAddComponent<OcclusionCuller>();
 			cam.tryAddComponent<FrustumCuller>();
 			cam.tryAddComponent<LightingRenderComponent>();
@@ -10,6 +10,8 @@
 #include <darmok/string.hpp>
 
 #include <algorithm>
+#include <fstream>
+#include <vector>
 
 #include <bx/filepath.h>
 #include <bx/timer.h>
@@ -174,6 +176,7 @@ namespace darmok
 		, _activeResetFlags{ BGFX_RESET_NONE }
 		, _lastUpdate{ 0 }
 		, _updateConfig{ AppUpdateConfig::getDefaultConfig() }
+		, _shaderCacheMaxSize{ App::defaultShaderCacheMaxSize }
 		, _plat{ Platform::get() }
 		, _window{ _plat }
 		, _renderSize{ 0 }
@@ -346,8 +349,26 @@ namespace darmok
 		init.callback = &BgfxCallbacks::get();
 		// _rendererType = bgfx::RendererType::Vulkan;
 		init.type = _rendererType;
+
+		// the renderers read the cache while initializing so it needs to be set before
+		std::filesystem::path shaderCachePath;
+		if (!_shaderCachePath.empty())
+		{
+			static constexpr uint32_t shaderCacheVersion = 1;
+			auto rendererName = _rendererType == bgfx::RendererType::Count ? "Default" : bgfx::getRendererName(_rendererType);
+			shaderCachePath = _shaderCachePath
+				/ fmt::format("v{}-bgfx{}", shaderCacheVersion, BGFX_API_VERSION)
+				/ rendererName;
+		}
+		auto& callbacks = BgfxCallbacks::get();
+		callbacks.setCachePath(shaderCachePath, _shaderCacheMaxSize);
+
 		bgfx::init(init);
 
+		// compiled shaders depend on the gpu, only known once initialized
+		auto caps = bgfx::getCaps();
+		callbacks.setCacheDevice(fmt::format("{}-{:04x}-{:04x}", bgfx::getRendererName(caps->rendererType), caps->vendorId, caps->deviceId));
+
 		bgfx::setDebug(_debugFlags);
 		_activeResetFlags = _resetFlags;
 
@@ -699,6 +720,12 @@ namespace darmok
 		return {};
 	}
 
+	void AppImpl::setShaderCachePath(const std::filesystem::path& path, size_t maxSize) noexcept
+	{
+		_shaderCachePath = path;
+		_shaderCacheMaxSize = maxSize;
+	}
+
 	expected<void, std::string> AppImpl::setNextRenderer() noexcept
 	{
 		auto renderer = bgfx::getCaps()->rendererType;
@@ -1185,6 +1212,11 @@ namespace darmok
 		return _impl->setRendererType(renderer);
 	}
 
+	void App::setShaderCachePath(const std::filesystem::path& path, size_t maxSize) noexcept
+	{
+		_impl->setShaderCachePath(path, maxSize);
+	}
+
 	expected<void, std::string> App::addComponent(std::unique_ptr<IAppComponent> component) noexcept
 	{
 		return _impl->addComponent(std::move(component));
@@ -1212,6 +1244,8 @@ namespace darmok
 
 	BgfxCallbacks::BgfxCallbacks() noexcept
 		: _cache()
+		, _cacheMaxSize{ 0 }
+		, _cacheSize{ 0 }
 	{
 	}
 
@@ -1280,13 +1314,138 @@ namespace darmok
 		// TODO: vcpkg bgfx build without profiler enabled
 	}
 
+	void BgfxCallbacks::setCachePath(const std::filesystem::path& path, size_t maxSize) noexcept
+	{
+		const std::lock_guard lock(_cacheMutex);
+		_cache.clear();
+		_cachePath = path;
+		_cacheMaxSize = maxSize;
+		_cacheSize = 0;
+		if (_cachePath.empty())
+		{
+			return;
+		}
+		std::error_code err;
+		std::filesystem::create_directories(_cachePath, err);
+		std::error_code itrErr;
+		for (std::filesystem::directory_iterator itr{ _cachePath, itrErr }, end; !itrErr && itr != end; itr.increment(itrErr))
+		{
+			auto& entry = *itr;
+			if (!entry.is_regular_file(err))
+			{
+				continue;
+			}
+			auto ext = entry.path().extension();
+			if (ext == ".tmp")
+			{
+				// leftover of an interrupted write
+				std::filesystem::remove(entry.path(), err);
+				continue;
+			}
+			if (ext != ".bin")
+			{
+				continue;
+			}
+			auto fileSize = entry.file_size(err);
+			if (!err)
+			{
+				_cacheSize += fileSize;
+			}
+		}
+		evictCache(0);
+	}
+
+	void BgfxCallbacks::setCacheDevice(const std::string& device) noexcept
+	{
+		const std::lock_guard lock(_cacheMutex);
+		if (_cachePath.empty())
+		{
+			return;
+		}
+		auto devicePath = _cachePath / "device";
+		std::string oldDevice;
+		{
+			std::ifstream in{ devicePath };
+			std::getline(in, oldDevice);
+		}
+		if (oldDevice == device)
+		{
+			return;
+		}
+
+		// entries compiled for another gpu or driver
+		_cache.clear();
+		std::error_code err;
+		std::error_code itrErr;
+		for (std::filesystem::directory_iterator itr{ _cachePath, itrErr }, end; !itrErr && itr != end; itr.increment(itrErr))
+		{
+			if (itr->path().extension() == ".bin")
+			{
+				std::filesystem::remove(itr->path(), err);
+			}
+		}
+		_cacheSize = 0;
+		std::ofstream out{ devicePath, std::ios::trunc };
+		out << device;
+	}
+
+	std::filesystem::path BgfxCallbacks::getCacheFilePath(uint64_t resId) const noexcept
+	{
+		return _cachePath / fmt::format("{:016x}.bin", resId);
+	}
+
+	void BgfxCallbacks::evictCache(size_t size) noexcept
+	{
+		if (_cacheSize + size <= _cacheMaxSize)
+		{
+			return;
+		}
+		std::error_code err;
+		std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::directory_entry>> entries;
+		std::error_code itrErr;
+		for (std::filesystem::directory_iterator itr{ _cachePath, itrErr }, end; !itrErr && itr != end; itr.increment(itrErr))
+		{
+			auto& entry = *itr;
+			if (entry.is_regular_file(err) && entry.path().extension() == ".bin")
+			{
+				entries.emplace_back(entry.last_write_time(err), entry);
+			}
+		}
+		std::sort(entries.begin(), entries.end(), [](auto& a, auto& b) { return a.first < b.first; });
+		for (auto& [time, entry] : entries)
+		{
+			if (_cacheSize + size <= _cacheMaxSize)
+			{
+				break;
+			}
+			auto fileSize = entry.file_size(err);
+			if (!err && std::filesystem::remove(entry.path(), err))
+			{
+				_cacheSize -= std::min(static_cast<size_t>(fileSize), _cacheSize);
+			}
+		}
+	}
+
 	uint32_t BgfxCallbacks::cacheReadSize(uint64_t resId) noexcept
 	{
 		const std::lock_guard lock(_cacheMutex);
 		auto itr = _cache.find(resId);
 		if (itr == _cache.end())
 		{
-			return 0;
+			if (_cachePath.empty())
+			{
+				return 0;
+			}
+			auto path = getCacheFilePath(resId);
+			auto dataResult = Data::fromFile(path);
+			if (!dataResult)
+			{
+				return 0;
+			}
+			// least recently used entries are evicted first
+			std::error_code err;
+			std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), err);
+			itr = _cache.emplace(resId, std::move(dataResult).value()).first;
 		}
 		return static_cast<uint32_t>(itr->second.size());
 	}
@@ -1305,12 +1464,56 @@ namespace darmok
 			size = static_cast<uint32_t>(data.size());
 		}
 		std::memcpy(dataPtr, data.ptr(), size);
+		if (!_cachePath.empty())
+		{
+			// can be read again from the file
+			_cache.erase(itr);
+		}
 		return true;
 	}
 
 	void BgfxCallbacks::cacheWrite(uint64_t resId, const void* data, uint32_t size) noexcept
 	{
-		_cache.emplace(resId, Data(data, size));
+		const std::lock_guard lock(_cacheMutex);
+		if (_cachePath.empty())
+		{
+			_cache.emplace(resId, Data(data, size));
+			return;
+		}
+		if (size > _cacheMaxSize)
+		{
+			return;
+		}
+		evictCache(size);
+
+		// write to a temporary file and rename it so that a crash never leaves a partial entry
+		auto path = getCacheFilePath(resId);
+		auto tmpPath = path;
+		tmpPath += ".tmp";
+		std::error_code err;
+		auto oldSize = std::filesystem::file_size(path, err);
+		if (err)
+		{
+			oldSize = 0;
+		}
+		{
+			std::ofstream out{ tmpPath, std::ios::binary | std::ios::trunc };
+			out.write(static_cast<const char*>(data), size);
+			if (!out)
+			{
+				out.close();
+				std::filesystem::remove(tmpPath, err);
+				return;
+			}
+		}
+		std::filesystem::rename(tmpPath, path, err);
+		if (err)
+		{
+			std::filesystem::remove(tmpPath, err);
+			return;
+		}
+		_cacheSize += size;
+		_cacheSize -= std::min(static_cast<size_t>(oldSize), _cacheSize);
 	}
 
 	void BgfxCallbacks::screenShot(
@@ -2,6 +2,7 @@
 
 #include <darmok/asset_pack.hpp>
 #include <darmok/slang.hpp>
+#include <darmok/app.hpp>
 
 namespace darmok
 {
@@ -9,6 +10,7 @@ namespace darmok
 	AssetContextImpl::AssetContextImpl(IAssetContext& assets, Config&& config)
 		: _config{ std::move(config) }
 		, _imageLoader{ getDataLoader(), getAllocator() }
+		, _assetPackFileLoader{ getDataLoader() }
 		, _dataProgDefLoader{ getDataLoader() }
 		, _dataTexDefLoader{ getDataLoader() }
 		, _imgTexDefLoader{ _imageLoader }
@@ -52,6 +54,10 @@ namespace darmok
 		, _miniaudioSoundLoader{ getDataLoader() }
 		, _miniaudioMusicLoader{ getDataLoader() }
 #endif
+		, _asyncProgLoader{ _progLoader, _dataProgDefLoader }
+		, _asyncTexLoader{ _texLoader, _texDefLoader }
+		, _asyncMeshLoader{ _meshLoader, _dataMeshDefLoader }
+		, _asyncSceneDefLoader{ _sceneDefLoader }
 	{
 		_fontLoader.addFront(_texAtlasFontLoader, ".xml");
 	}
@@ -71,6 +77,11 @@ namespace darmok
 		return _imageLoader;
 	}
 
+	IAssetPackFileLoader& AssetContextImpl::getAssetPackFileLoader() noexcept
+	{
+		return _assetPackFileLoader;
+	}
+
 	IProgramFromDefinitionLoader& AssetContextImpl::getProgramLoader() noexcept
 	{
 		return _progLoader;
@@ -140,8 +151,33 @@ namespace darmok
 	}
 #endif
 
+	AssetFuture<Program> AssetContextImpl::loadProgramAsync(const std::filesystem::path& path) noexcept
+	{
+		return _asyncProgLoader(path);
+	}
+
+	AssetFuture<Texture> AssetContextImpl::loadTextureAsync(const std::filesystem::path& path) noexcept
+	{
+		return _asyncTexLoader(path);
+	}
+
+	AssetFuture<Mesh> AssetContextImpl::loadMeshAsync(const std::filesystem::path& path) noexcept
+	{
+		return _asyncMeshLoader(path);
+	}
+
+	AssetFuture<protobuf::Scene> AssetContextImpl::loadSceneDefinitionAsync(const std::filesystem::path& path) noexcept
+	{
+		return _asyncSceneDefLoader(path);
+	}
+
 	expected<void, std::string> AssetContextImpl::init(App& app) noexcept
 	{
+		auto& executor = app.getTaskExecutor();
+		_asyncProgLoader.init(executor);
+		_asyncTexLoader.init(executor);
+		_asyncMeshLoader.init(executor);
+		_asyncSceneDefLoader.init(executor);
 #ifdef DARMOK_FREETYPE
         auto result = _freetypeFontLoader.init(app);
 		if (!result)
@@ -154,9 +190,16 @@ namespace darmok
 
 	expected<void, std::string> AssetContextImpl::update() noexcept
 	{
+		_asyncProgLoader.update();
+		_asyncTexLoader.update();
+		_asyncMeshLoader.update();
+		_asyncSceneDefLoader.update();
+
 		_progLoader.pruneCache();
 		_texLoader.pruneCache();
 		_meshLoader.pruneCache();
+		_materialLoader.pruneCache();
+		_armatureLoader.pruneCache();
 		_texAtlasLoader.pruneCache();
 #ifdef DARMOK_FREETYPE
 		_freetypeFontLoader.pruneCache();
@@ -166,6 +209,11 @@ namespace darmok
 
 	expected<void, std::string> AssetContextImpl::shutdown() noexcept
 	{
+		_asyncProgLoader.shutdown();
+		_asyncTexLoader.shutdown();
+		_asyncMeshLoader.shutdown();
+		_asyncSceneDefLoader.shutdown();
+
 #ifdef DARMOK_FREETYPE
 		auto result = _freetypeFontLoader.shutdown();
 		if (!result)
@@ -195,6 +243,11 @@ namespace darmok
 		return _impl->getImageLoader();
 	}
 
+	IAssetPackFileLoader& AssetContext::getAssetPackFileLoader() noexcept
+	{
+		return _impl->getAssetPackFileLoader();
+	}
+
 	IProgramFromDefinitionLoader& AssetContext::getProgramLoader() noexcept
 	{
 		return _impl->getProgramLoader();
@@ -265,6 +318,26 @@ namespace darmok
 		return _impl->getAllocator();
 	}
 
+	AssetFuture<Program> AssetContext::loadProgramAsync(const std::filesystem::path& path) noexcept
+	{
+		return _impl->loadProgramAsync(path);
+	}
+
+	AssetFuture<Texture> AssetContext::loadTextureAsync(const std::filesystem::path& path) noexcept
+	{
+		return _impl->loadTextureAsync(path);
+	}
+
+	AssetFuture<Mesh> AssetContext::loadMeshAsync(const std::filesystem::path& path) noexcept
+	{
+		return _impl->loadMeshAsync(path);
+	}
+
+	AssetFuture<protobuf::Scene> AssetContext::loadSceneDefinitionAsync(const std::filesystem::path& path) noexcept
+	{
+		return _impl->loadSceneDefinitionAsync(path);
+	}
+
 	AssetContextImpl& AssetContext::getImpl() noexcept
 	{
 		return *_impl;
@@ -298,6 +371,7 @@ namespace darmok
 		{
 			addSlangShaderIncludePath(path);
 		}
+		setJobs(config.jobs);
 	}
 
 	DarmokAssetFileImporter::DarmokAssetFileImporter(const std::filesystem::path& inputPath) noexcept
@@ -360,6 +434,12 @@ namespace darmok
 		return *this;
 	}
 
+	DarmokAssetFileImporter& DarmokAssetFileImporter::setJobs(size_t jobs) noexcept
+	{
+		_importer.setJobs(jobs);
+		return *this;
+	}
+
 	expected<DarmokAssetFileImporter::Paths, std::string> DarmokAssetFileImporter::getOutputPaths() const noexcept
 	{
 		return _importer.getOutputPaths();
@@ -13,8 +13,14 @@
 #include <fstream>
 #include <algorithm>
 #include <chrono>
+#include <sstream>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
 
 #include <CLI/CLI.hpp>
+#include <taskflow/taskflow.hpp>
 
 namespace darmok
 {
@@ -96,6 +102,11 @@ namespace darmok
         return {};
     };
 
+    std::unique_ptr<IFileTypeImporter> IFileTypeImporter::clone() const noexcept
+    {
+        return nullptr;
+    }
+
     FileImporterImpl::FileImporterImpl(const fs::path& inputPath) noexcept
     {
         std::vector<fs::path> inputPaths;
@@ -868,6 +879,11 @@ namespace darmok
         }
     }
 
+    void FileImporterImpl::setJobs(size_t jobs) noexcept
+    {
+        _jobs = jobs;
+    }
+
     bool FileImporterImpl::operator()(std::ostream& log) const noexcept
     {
         if (_inputPath.empty())
@@ -875,9 +891,33 @@ namespace darmok
             log << "no input path specified" << std::endl;
             return false;
         }
+
+        std::mutex logMutex;
+        auto flushLog = [&log, &logMutex](std::stringstream& buffer)
+        {
+            auto str = buffer.str();
+            if (str.empty())
+            {
+                return;
+            }
+            buffer.str({});
+            std::lock_guard lock{ logMutex };
+            log << str << std::flush;
+        };
+
+        // importers that cannot be cloned are shared by the workers
+        struct SharedImporter final
+        {
+            std::mutex mutex;
+            std::stringstream log;
+        };
+        std::unordered_map<const IFileTypeImporter*, SharedImporter> sharedImporters;
+
         for(auto& importer : _importers)
         {
-            auto initResult = importer.second->init(log);
+            auto& shared = sharedImporters[importer.second.get()];
+            auto initResult = importer.second->init(shared.log);
+            flushLog(shared.log);
             if (!initResult)
             {
                 log << "error initializing importer \"" << importer.second->getName() << "\": " << initResult.error();
@@ -891,21 +931,138 @@ namespace darmok
             log << "error loading operations: " << opsResult.error();
             return false;
         }
-        auto hasError = false;
-        for (auto& op : opsResult.value())
+        auto& ops = opsResult.value();
+
+        // the file cache is not thread safe
+        std::vector<bool> inputsCached;
+        inputsCached.reserve(ops.size());
+        std::vector<fs::path> inputPaths;
+        inputPaths.reserve(ops.size());
+        std::unordered_map<fs::path, std::vector<size_t>> inputOps;
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            auto& path = ops[i].input.path;
+            inputsCached.push_back(isCached(path));
+            auto& inputPath = inputPaths.emplace_back(normalizePath(path));
+            inputOps[inputPath].push_back(i);
+        }
+
+        auto jobs = _jobs > 0 ? _jobs : std::thread::hardware_concurrency();
+        jobs = std::clamp<size_t>(jobs, 1, std::max<size_t>(ops.size(), 1));
+        tf::Executor executor{ jobs };
+
+        // the importers keep state between prepare and import,
+        // so each worker imports with its own clones
+        struct WorkerImporter final
+        {
+            std::unique_ptr<IFileTypeImporter> importer;
+            expected<void, std::string> initResult;
+            std::stringstream log;
+        };
+        using WorkerImporters = std::unordered_map<const IFileTypeImporter*, WorkerImporter>;
+        std::vector<WorkerImporters> workerImporters(jobs);
+
+        std::atomic<bool> hasError = false;
+        tf::Taskflow taskflow;
+        std::vector<tf::Task> tasks;
+        tasks.reserve(ops.size());
+        for (size_t i = 0; i < ops.size(); ++i)
         {
-            auto result = importFile(op, log);
-            hasError = hasError || result.error;
-            if (op.headerConfig.produceHeaders && !result.updatedOutputPaths.empty())
+            tasks.push_back(taskflow.emplace([this, i, &ops, &inputsCached, &executor, &workerImporters, &sharedImporters, &flushLog, &hasError]()
             {
-                auto groups = getPathGroups(result.outputPaths);
-                for (auto& [groupPath, paths] : groups)
+                auto& op = ops[i];
+                auto workerId = std::max(executor.this_worker_id(), 0);
+                auto& workerImps = workerImporters[workerId];
+                auto itr = workerImps.find(&op.importer);
+                if (itr == workerImps.end())
+                {
+                    itr = workerImps.try_emplace(&op.importer).first;
+                    auto& workerImp = itr->second;
+                    workerImp.importer = op.importer.clone();
+                    if (workerImp.importer)
+                    {
+                        workerImp.initResult = workerImp.importer->init(workerImp.log);
+                    }
+                }
+                auto& workerImp = itr->second;
+                std::stringstream opLog;
+                if (!workerImp.initResult)
+                {
+                    opLog << "error initializing importer \"" << op.importer.getName() << "\": " << workerImp.initResult.error() << std::endl;
+                    flushLog(opLog);
+                    hasError = true;
+                    return;
+                }
+
+                std::unique_lock<std::mutex> sharedLock;
+                auto importer = workerImp.importer.get();
+                auto importerLog = &workerImp.log;
+                if (!importer)
+                {
+                    auto& shared = sharedImporters.at(&op.importer);
+                    sharedLock = std::unique_lock{ shared.mutex };
+                    importer = &op.importer;
+                    importerLog = &shared.log;
+                }
+
+                auto result = importFile(op, *importer, inputsCached[i], opLog);
+                if (result.error)
+                {
+                    hasError = true;
+                }
+                if (op.headerConfig.produceHeaders && !result.updatedOutputPaths.empty())
+                {
+                    auto groups = getPathGroups(result.outputPaths);
+                    for (auto& [groupPath, paths] : groups)
+                    {
+                        opLog << "combined header " << groupPath << "..." << std::endl;
+                        produceCombinedHeader(groupPath, paths, op.headerConfig.includeDir);
+                    }
+                }
+                flushLog(*importerLog);
+                sharedLock = {};
+                flushLog(opLog);
+            }));
+        }
+
+        // an operation runs after the operations that import its dependencies
+        std::vector<std::unordered_set<fs::path>> opDeps(ops.size());
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            auto itrDeps = _fileDependencies.find(ops[i].input.path);
+            if (itrDeps == _fileDependencies.end())
+            {
+                continue;
+            }
+            for (auto& dep : itrDeps->second)
+            {
+                opDeps[i].insert(normalizePath(dep));
+            }
+        }
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            auto& path = inputPaths[i];
+            for (auto& dep : opDeps[i])
+            {
+                auto itrOps = inputOps.find(dep);
+                if (dep == path || itrOps == inputOps.end())
                 {
-                    log << "combined header " << groupPath  << "..." << std::endl;
-                    produceCombinedHeader(groupPath, paths, op.headerConfig.includeDir);
+                    continue;
+                }
+                for (auto j : itrOps->second)
+                {
+                    if (opDeps[j].contains(path))
+                    {
+                        // circular dependency, no order between them
+                        continue;
+                    }
+                    tasks[j].precede(tasks[i]);
                 }
             }
         }
+
+        executor.run(taskflow).wait();
+
         if (isCacheUpdated())
         {
             log << "writing cache " << _cachePath << "..." << std::endl;
@@ -917,15 +1074,30 @@ namespace darmok
             }
         }
 
-        for (auto& importer : _importers)
+        auto shutdownImporter = [&log, &flushLog, &hasError](IFileTypeImporter& importer, std::stringstream& importerLog)
         {
-            auto initResult = importer.second->shutdown();
-            if (!initResult)
+            auto result = importer.shutdown();
+            flushLog(importerLog);
+            if (!result)
             {
-                log << "error shutting down importer \"" << importer.second->getName() << "\": " << initResult.error();
-				hasError = true;
+                log << "error shutting down importer \"" << importer.getName() << "\": " << result.error();
+                hasError = true;
+            }
+        };
+        for (auto& workerImps : workerImporters)
+        {
+            for (auto& [mainImporter, workerImp] : workerImps)
+            {
+                if (workerImp.importer && workerImp.initResult)
+                {
+                    shutdownImporter(*workerImp.importer, workerImp.log);
+                }
             }
         }
+        for (auto& importer : _importers)
+        {
+            shutdownImporter(*importer.second, sharedImporters[importer.second.get()].log);
+        }
 
         return !hasError;
     }
@@ -965,11 +1137,11 @@ namespace darmok
         return outputs;
     }
 
-    FileImporterImpl::FileImportResult FileImporterImpl::importFile(const Operation& op, std::ostream& log) const noexcept
+    FileImporterImpl::FileImportResult FileImporterImpl::importFile(const Operation& op, IFileTypeImporter& importer, bool inputCached, std::ostream& log) const noexcept
     {
         FileImportResult result;
-        auto prepareResult = op.importer.prepare(op.input);
-        auto& name = op.importer.getName();
+        auto prepareResult = importer.prepare(op.input);
+        auto& name = importer.getName();
         if (!prepareResult)
         {
             log << name << " error in prepare: " << prepareResult.error();
@@ -982,7 +1154,7 @@ namespace darmok
             return result;
         }
 
-        result.inputCached = isCached(op.input.path);
+        result.inputCached = inputCached;
         size_t i = 0;
         auto relInput = fs::relative(op.input.path, _inputPath);
         FileImportConfig config{ .context = *this };
@@ -1001,7 +1173,7 @@ namespace darmok
                 // log << name << ": skipping " << relInput << " -> " << relOutput << std::endl;
                 continue;
             }
-            log << op.importer.getName() << ": " << relInput << " -> " << relOutput << "..." << std::endl;
+            log << name << ": " << relInput << " -> " << relOutput << "..." << std::endl;
             result.updatedOutputPaths.push_back(outputPath);
             fs::create_directories(outputPath.parent_path());
             config.outputStreams[i] = std::make_unique<DataOutputStream>(datas[i]);
@@ -1011,7 +1183,7 @@ namespace darmok
             return result;
         }
 
-        auto importResult = op.importer(op.input, config);
+        auto importResult = importer(op.input, config);
         if (!importResult)
         {
             log << name << " error in import: " << importResult.error() << std::endl;
@@ -1079,6 +1251,12 @@ namespace darmok
         return _impl->getOutputPaths();
     }
 
+    FileImporter& FileImporter::setJobs(size_t jobs) noexcept
+    {
+        _impl->setJobs(jobs);
+        return *this;
+    }
+
     bool FileImporter::operator()(std::ostream& out) const noexcept
     {
         return (*_impl)(out);
@@ -1135,6 +1313,11 @@ namespace darmok
         return name;
     }
 
+    std::unique_ptr<IFileTypeImporter> CopyFileImporter::clone() const noexcept
+    {
+        return std::make_unique<CopyFileImporter>(_bufferSize);
+    }
+
     DarmokCoreAssetFileImporter::DarmokCoreAssetFileImporter(const CommandLineFileImporterConfig& config)
         : DarmokCoreAssetFileImporter(config.inputPath)
     {
@@ -1163,6 +1346,7 @@ namespace darmok
         {
             setShaderOptimizationLevel(*config.shaderOptimizationLevel);
         }
+        setJobs(config.jobs);
     }
 
     DarmokCoreAssetFileImporter::DarmokCoreAssetFileImporter(const fs::path& inputPath)
@@ -1219,6 +1403,12 @@ namespace darmok
         return *this;
     }
 
+    DarmokCoreAssetFileImporter& DarmokCoreAssetFileImporter::setJobs(size_t jobs) noexcept
+    {
+        _importer.setJobs(jobs);
+        return *this;
+    }
+
     expected<DarmokCoreAssetFileImporter::Paths, std::string> DarmokCoreAssetFileImporter::getOutputPaths() const noexcept
     {
         return _importer.getOutputPaths();
@@ -1270,6 +1460,9 @@ namespace darmok
             ->envname("DARMOK_IMPORT_CACHE");
         cli.add_flag("-d, --import-dry", cfg.dry, "Do not process assets, just print output files.")
             ->envname("DARMOK_IMPORT_DRY");
+        cli.add_option("-j,--import-jobs", cfg.jobs, "Amount of assets imported in parallel (0 uses all the cores).")
+            ->option_text("N")
+            ->envname("DARMOK_IMPORT_JOBS");
 
         auto progGroup = cli.add_option_group("Program Compiler");
         progGroup->add_option("--bgfx-shaderc", cfg.bgfxShadercPath, "path to the shaderc executable")
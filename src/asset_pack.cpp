@@ -1,22 +1,386 @@
 #include <darmok/asset_pack.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+#include <google/protobuf/descriptor.h>
+
 namespace darmok
 {
-	AssetPack::AssetPack(const Definition& def, const AssetPackConfig& config)
+	AssetPackDefinitionSource::AssetPackDefinitionSource(OptionalRef<const Definition> def) noexcept
 		: _def{ def }
+	{
+	}
+
+	bool AssetPackDefinitionSource::contains(const std::filesystem::path& path) const noexcept
+	{
+		return _def && _def->assets().contains(path.string());
+	}
+
+	expected<IdType, std::string> AssetPackDefinitionSource::getTypeId(const std::filesystem::path& path) const noexcept
+	{
+		if (!_def)
+		{
+			return unexpected{ "empty asset pack" };
+		}
+		auto& assets = _def->assets();
+		auto itr = assets.find(path.string());
+		if (itr == assets.end())
+		{
+			return unexpected{ fmt::format("asset pack path \"{}\" not found", path.string()) };
+		}
+		return protobuf::getTypeId(itr->second);
+	}
+
+	expected<void, std::string> AssetPackDefinitionSource::unpack(const std::filesystem::path& path, protobuf::Message& msg) const noexcept
+	{
+		if (!_def)
+		{
+			return unexpected{ "empty asset pack" };
+		}
+		auto& assets = _def->assets();
+		auto itr = assets.find(path.string());
+		if (itr == assets.end())
+		{
+			return unexpected{ fmt::format("asset pack path \"{}\" not found", path.string()) };
+		}
+		if (!itr->second.UnpackTo(&msg))
+		{
+			return unexpected{ fmt::format("failed to unpack asset in path \"{}\"", path.string()) };
+		}
+		return {};
+	}
+
+	static_assert(sizeof(AssetPackFile::Header) == 24, "unexpected asset pack header size");
+	static_assert(sizeof(AssetPackFile::Entry) == 40, "unexpected asset pack entry size");
+
+	AssetPackFile::AssetPackFile(MappedFile&& file, std::span<const Entry> entries) noexcept
+		: _file{ std::move(file) }
+		, _entries{ entries }
+	{
+	}
+
+	uint64_t AssetPackFile::hashPath(std::string_view path) noexcept
+	{
+		// FNV-1a, needs to be stable between platforms and builds
+		uint64_t hash = 14695981039346656037ULL;
+		for (auto chr : path)
+		{
+			hash ^= static_cast<uint8_t>(chr);
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	expected<AssetPackFile, std::string> AssetPackFile::open(const std::filesystem::path& path) noexcept
+	{
+		auto fileResult = MappedFile::open(path);
+		if (!fileResult)
+		{
+			return unexpected{ std::move(fileResult).error() };
+		}
+		return open(std::move(fileResult).value());
+	}
+
+	expected<AssetPackFile, std::string> AssetPackFile::open(MappedFile&& file) noexcept
+	{
+		if (file.size() < sizeof(Header))
+		{
+			return unexpected{ "asset pack file too small" };
+		}
+		auto& header = *static_cast<const Header*>(file.ptr());
+		if (header.magic != magic)
+		{
+			return unexpected{ "invalid asset pack file" };
+		}
+		if (header.version != version)
+		{
+			return unexpected{ fmt::format("unsupported asset pack version {}", header.version) };
+		}
+		if (header.indexOffset % alignof(Entry) != 0
+			|| header.indexOffset > file.size()
+			|| header.entryCount > (file.size() - header.indexOffset) / sizeof(Entry))
+		{
+			return unexpected{ "invalid asset pack index" };
+		}
+		auto entriesPtr = reinterpret_cast<const Entry*>(static_cast<const uint8_t*>(file.ptr()) + header.indexOffset);
+		std::span<const Entry> entries{ entriesPtr, static_cast<size_t>(header.entryCount) };
+		return AssetPackFile{ std::move(file), entries };
+	}
+
+	size_t AssetPackFile::size() const noexcept
+	{
+		return _entries.size();
+	}
+
+	std::vector<std::filesystem::path> AssetPackFile::getPaths() const noexcept
+	{
+		std::vector<std::filesystem::path> paths;
+		paths.reserve(_entries.size());
+		for (auto& entry : _entries)
+		{
+			paths.emplace_back(getPath(entry));
+		}
+		return paths;
+	}
+
+	std::string_view AssetPackFile::getPath(const Entry& entry) const noexcept
+	{
+		return _file.view(entry.pathOffset, entry.pathSize).stringView();
+	}
+
+	std::string_view AssetPackFile::getTypeName(const Entry& entry) const noexcept
+	{
+		return _file.view(entry.pathOffset + entry.pathSize, entry.typeSize).stringView();
+	}
+
+	const AssetPackFile::Entry* AssetPackFile::findEntry(const std::filesystem::path& path) const noexcept
+	{
+		auto pathStr = path.string();
+		auto hash = hashPath(pathStr);
+		auto itr = std::lower_bound(_entries.begin(), _entries.end(), hash,
+			[](const Entry& entry, uint64_t hash) { return entry.pathHash < hash; });
+		for (; itr != _entries.end() && itr->pathHash == hash; ++itr)
+		{
+			auto& entry = *itr;
+			auto size = _file.size();
+			if (entry.pathOffset > size || uint64_t(entry.pathSize) + entry.typeSize > size - entry.pathOffset
+				|| entry.dataOffset > size || entry.dataSize > size - entry.dataOffset)
+			{
+				// corrupt entry
+				continue;
+			}
+			if (getPath(entry) == pathStr)
+			{
+				return &entry;
+			}
+		}
+		return nullptr;
+	}
+
+	bool AssetPackFile::contains(const std::filesystem::path& path) const noexcept
+	{
+		return findEntry(path) != nullptr;
+	}
+
+	bool AssetPackFile::hasScene() const noexcept
+	{
+		return contains(scenePath);
+	}
+
+	expected<void, std::string> AssetPackFile::unpackScene(protobuf::Scene& scene) const noexcept
+	{
+		return unpack(scenePath, scene);
+	}
+
+	expected<DataView, std::string> AssetPackFile::getData(const std::filesystem::path& path) const noexcept
+	{
+		auto entry = findEntry(path);
+		if (!entry)
+		{
+			return unexpected{ fmt::format("asset pack path \"{}\" not found", path.string()) };
+		}
+		return _file.view(entry->dataOffset, entry->dataSize);
+	}
+
+	expected<IdType, std::string> AssetPackFile::getTypeId(const std::filesystem::path& path) const noexcept
+	{
+		auto entry = findEntry(path);
+		if (!entry)
+		{
+			return unexpected{ fmt::format("asset pack path \"{}\" not found", path.string()) };
+		}
+		auto typeName = getTypeName(*entry);
+		auto desc = google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(std::string{ typeName });
+		if (!desc)
+		{
+			return unexpected{ fmt::format("unknown asset type \"{}\"", typeName) };
+		}
+		return protobuf::getTypeId(*desc);
+	}
+
+	expected<void, std::string> AssetPackFile::unpack(const std::filesystem::path& path, protobuf::Message& msg) const noexcept
+	{
+		auto entry = findEntry(path);
+		if (!entry)
+		{
+			return unexpected{ fmt::format("asset pack path \"{}\" not found", path.string()) };
+		}
+		auto typeName = getTypeName(*entry);
+		if (typeName != msg.GetDescriptor()->full_name())
+		{
+			return unexpected{ fmt::format("asset pack path \"{}\" contains a {}", path.string(), typeName) };
+		}
+		auto data = _file.view(entry->dataOffset, entry->dataSize);
+		if (data.size() > static_cast<size_t>(std::numeric_limits<int>::max()))
+		{
+			return unexpected{ fmt::format("asset in path \"{}\" is too big", path.string()) };
+		}
+		// parsing directly from the mapped memory, only the pages of this asset are read
+		if (!msg.ParseFromArray(data.ptr(), static_cast<int>(data.size())))
+		{
+			return unexpected{ fmt::format("failed to unpack asset in path \"{}\"", path.string()) };
+		}
+		return {};
+	}
+
+	namespace
+	{
+		uint64_t alignOffset(uint64_t offset, uint64_t alignment) noexcept
+		{
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+		void writePadding(std::ostream& out, uint64_t& offset, uint64_t alignment) noexcept
+		{
+			auto aligned = alignOffset(offset, alignment);
+			static const std::array<char, AssetPackFile::blobAlignment> zeros{};
+			out.write(zeros.data(), static_cast<std::streamsize>(aligned - offset));
+			offset = aligned;
+		}
+	}
+
+	expected<void, std::string> AssetPackFile::write(const Definition& def, std::ostream& out) noexcept
+	{
+		struct WriteEntry final
+		{
+			Entry entry;
+			std::string_view path;
+			std::string typeName;
+			std::string_view data;
+		};
+
+		std::vector<WriteEntry> writeEntries;
+		writeEntries.reserve(def.assets_size());
+		for (auto& [path, any] : def.assets())
+		{
+			auto& elm = writeEntries.emplace_back();
+			elm.path = path;
+			elm.typeName = protobuf::getFullName(any);
+			elm.data = any.value();
+			elm.entry.pathHash = hashPath(path);
+			elm.entry.pathSize = static_cast<uint32_t>(path.size());
+			elm.entry.typeSize = static_cast<uint32_t>(elm.typeName.size());
+			elm.entry.dataSize = elm.data.size();
+		}
+		std::sort(writeEntries.begin(), writeEntries.end(), [](auto& a, auto& b)
+		{
+			if (a.entry.pathHash != b.entry.pathHash)
+			{
+				return a.entry.pathHash < b.entry.pathHash;
+			}
+			return a.path < b.path;
+		});
+
+		Header header{ magic, version, writeEntries.size(), sizeof(Header) };
+		uint64_t offset = header.indexOffset + (sizeof(Entry) * writeEntries.size());
+		for (auto& elm : writeEntries)
+		{
+			offset = alignOffset(offset, blobAlignment);
+			elm.entry.pathOffset = offset;
+			offset += elm.entry.pathSize + elm.entry.typeSize;
+			offset = alignOffset(offset, blobAlignment);
+			elm.entry.dataOffset = offset;
+			offset += elm.entry.dataSize;
+		}
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		for (auto& elm : writeEntries)
+		{
+			out.write(reinterpret_cast<const char*>(&elm.entry), sizeof(Entry));
+		}
+		offset = header.indexOffset + (sizeof(Entry) * writeEntries.size());
+		for (auto& elm : writeEntries)
+		{
+			writePadding(out, offset, blobAlignment);
+			out.write(elm.path.data(), elm.path.size());
+			out.write(elm.typeName.data(), elm.typeName.size());
+			offset += elm.entry.pathSize + elm.entry.typeSize;
+			writePadding(out, offset, blobAlignment);
+			out.write(elm.data.data(), elm.data.size());
+			offset += elm.entry.dataSize;
+		}
+		if (!out)
+		{
+			return unexpected{ "failed to write asset pack" };
+		}
+		return {};
+	}
+
+	expected<void, std::string> AssetPackFile::write(const Definition& def, const std::filesystem::path& path) noexcept
+	{
+		std::ofstream out{ path, std::ios::binary };
+		if (!out)
+		{
+			return unexpected{ "failed to open " + path.string() };
+		}
+		return write(def, out);
+	}
+
+	expected<void, std::string> AssetPackFile::write(protobuf::Scene scene, std::ostream& out) noexcept
+	{
+		Definition def;
+		def.Swap(scene.mutable_assets());
+		auto& assets = *def.mutable_assets();
+		std::string sceneKey{ scenePath };
+		if (assets.find(sceneKey) != assets.end())
+		{
+			return unexpected{ fmt::format("scene asset uses the reserved path \"{}\"", scenePath) };
+		}
+		if (!assets[sceneKey].PackFrom(scene))
+		{
+			return unexpected{ "failed to pack the scene" };
+		}
+		return write(def, out);
+	}
+
+	AssetPackFileLoader::AssetPackFileLoader(IDataLoader& dataLoader) noexcept
+		: _dataLoader{ dataLoader }
+	{
+	}
+
+	AssetPackFileLoader::Result AssetPackFileLoader::operator()(std::filesystem::path path) noexcept
+	{
+		auto fileResult = _dataLoader->map(path);
+		if (!fileResult)
+		{
+			return unexpected{ std::move(fileResult).error() };
+		}
+		auto packResult = AssetPackFile::open(std::move(fileResult).value());
+		if (!packResult)
+		{
+			return unexpected{ fmt::format("failed to open asset pack \"{}\": {}", path.string(), packResult.error()) };
+		}
+		return std::make_shared<AssetPackFile>(std::move(packResult).value());
+	}
+
+	AssetPack::AssetPack(const Definition& def, const AssetPackConfig& config)
+		: AssetPack{ def, nullptr, config }
+	{
+	}
+
+	AssetPack::AssetPack(const IAssetPackSource& source, const AssetPackConfig& config)
+		: AssetPack{ nullptr, source, config }
+	{
+	}
+
+	AssetPack::AssetPack(OptionalRef<const Definition> def, OptionalRef<const IAssetPackSource> source, const AssetPackConfig& config)
+		: _defSource{ def }
+		, _source{ source ? source.value() : static_cast<const IAssetPackSource&>(_defSource) }
 		, _alloc{ config.fallback ? config.fallback->getAllocator() : _defaultAlloc }
-		, _progDefLoader{ def }
-		, _texDefLoader{ def }
-		, _meshDefLoader{ def }
-		, _matDefLoader{ def }
-		, _armDefLoader{ def }
-		, _sceneDefLoader{ def }
-
-		, _progSrcLoader{ def }
+		, _progDefLoader{ _source }
+		, _texDefLoader{ _source }
+		, _meshDefLoader{ _source }
+		, _matDefLoader{ _source }
+		, _armDefLoader{ _source }
+		, _sceneDefLoader{ _source }
+
+		, _progSrcLoader{ _source }
 		, _progDefFromSrcLoader{ _progSrcLoader, config.programCompilerConfig }
-		, _texSrcLoader{ def }
+		, _texSrcLoader{ _source }
 		, _texDefFromSrcLoader{ _texSrcLoader, *_alloc }
-		, _meshSrcLoader{ def }
+		, _meshSrcLoader{ _source }
 		, _meshDefFromSrcLoader{ _meshSrcLoader, _progSrcLoader }
 
 		, _programLoader{ _multiProgramDefLoader }
@@ -133,16 +497,26 @@ namespace darmok
 		}
 	}
 
+	void AssetPack::pruneCache() noexcept
+	{
+		_progDefFromSrcLoader.pruneCache();
+		_texDefFromSrcLoader.pruneCache();
+		_meshDefFromSrcLoader.pruneCache();
+		_programLoader.pruneCache();
+		_textureLoader.pruneCache();
+		_meshLoader.pruneCache();
+		_materialLoader.pruneCache();
+		_armatureLoader.pruneCache();
+	}
+
 	expected<void, std::string> AssetPack::removeAsset(const std::filesystem::path& path)
 	{
-		auto& assets = _def->assets();
-		auto itr = assets.find(path.string());
-		if (itr == assets.end())
+		auto typeResult = _source.getTypeId(path);
+		if (!typeResult)
 		{
-			return unexpected{ fmt::format("asset pack path \"{}\" not found", path.string()) };
+			return unexpected{ std::move(typeResult).error() };
 		}
-		auto& asset = itr->second;
-		auto typeId = protobuf::getTypeId(asset);
+		auto typeId = typeResult.value();
 		if (typeId == protobuf::getTypeId<Mesh::Source>())
 		{
 			_meshDefFromSrcLoader.releaseCache(path);
@@ -164,14 +538,12 @@ namespace darmok
 
 	expected<void, std::string> AssetPack::reloadAsset(const std::filesystem::path& path)
 	{
-		auto& assets = _def->assets();
-		auto itr = assets.find(path.string());
-		if (itr == assets.end())
+		auto typeResult = _source.getTypeId(path);
+		if (!typeResult)
 		{
-			return unexpected{ fmt::format("asset pack path \"{}\" not found", path.string()) };
+			return unexpected{ std::move(typeResult).error() };
 		}
-		auto& asset = itr->second;
-		auto typeId = protobuf::getTypeId(asset);
+		auto typeId = typeResult.value();
 		if (typeId == protobuf::getTypeId<Texture::Source>())
 		{
 			auto result = _texDefFromSrcLoader.reload(path);
@@ -0,0 +1,700 @@
+#include <darmok/bounds_tree.hpp>
+#include <darmok/scene_filter.hpp>
+#include <darmok/transform.hpp>
+#include "detail/culling.hpp"
+
+#include <glm/gtx/norm.hpp>
+
+#include <algorithm>
+
+namespace darmok
+{
+    namespace
+    {
+        float getSurfaceArea(const BoundingBox& bbox) noexcept
+        {
+            auto size = bbox.size();
+            return 2.F * ((size.x * size.y) + (size.y * size.z) + (size.z * size.x));
+        }
+
+        bool contains(const BoundingBox& outer, const BoundingBox& inner) noexcept
+        {
+            return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::greaterThanEqual(outer.max, inner.max));
+        }
+
+        bool overlaps(const BoundingBox& bbox1, const BoundingBox& bbox2) noexcept
+        {
+            return glm::all(glm::lessThanEqual(bbox1.min, bbox2.max)) && glm::all(glm::greaterThanEqual(bbox1.max, bbox2.min));
+        }
+
+        bool overlaps(const BoundingBox& bbox, const Sphere& sphere) noexcept
+        {
+            auto closest = glm::clamp(sphere.origin, bbox.min, bbox.max);
+            return glm::distance2(closest, sphere.origin) <= sphere.radius * sphere.radius;
+        }
+    }
+
+    bool BoundsTree::Node::isLeaf() const noexcept
+    {
+        return child1 == nullNode;
+    }
+
+    BoundsTree::BoundsTree(float margin) noexcept
+        : _root{ nullNode }
+        , _freeNode{ nullNode }
+        , _leafAmount{ 0 }
+        , _margin{ margin }
+    {
+    }
+
+    BoundsTree::NodeId BoundsTree::allocateNode() noexcept
+    {
+        if (_freeNode == nullNode)
+        {
+            _nodes.emplace_back();
+            _freeNode = static_cast<NodeId>(_nodes.size() - 1);
+            _nodes.back().parent = nullNode;
+        }
+        auto id = _freeNode;
+        auto& node = _nodes[id];
+        _freeNode = node.parent;
+        node = Node{};
+        node.height = 0;
+        return id;
+    }
+
+    void BoundsTree::freeNode(NodeId id) noexcept
+    {
+        auto& node = _nodes[id];
+        node = Node{};
+        node.parent = _freeNode;
+        _freeNode = id;
+    }
+
+    BoundsTree::NodeId BoundsTree::insert(Entity entity, const BoundingBox& bbox) noexcept
+    {
+        auto id = allocateNode();
+        auto& node = _nodes[id];
+        node.entity = entity;
+        node.leafBounds = bbox;
+        node.bounds = bbox;
+        node.bounds.expand(glm::vec3{ _margin });
+        insertLeaf(id);
+        ++_leafAmount;
+        return id;
+    }
+
+    void BoundsTree::remove(NodeId id) noexcept
+    {
+        if (id < 0 || id >= static_cast<NodeId>(_nodes.size()) || !_nodes[id].isLeaf() || _nodes[id].height < 0)
+        {
+            return;
+        }
+        removeLeaf(id);
+        freeNode(id);
+        --_leafAmount;
+    }
+
+    bool BoundsTree::update(NodeId id, const BoundingBox& bbox) noexcept
+    {
+        auto& node = _nodes[id];
+        node.leafBounds = bbox;
+        if (contains(node.bounds, bbox))
+        {
+            return false;
+        }
+        removeLeaf(id);
+        node.bounds = bbox;
+        node.bounds.expand(glm::vec3{ _margin });
+        insertLeaf(id);
+        return true;
+    }
+
+    void BoundsTree::clear() noexcept
+    {
+        _nodes.clear();
+        _root = nullNode;
+        _freeNode = nullNode;
+        _leafAmount = 0;
+    }
+
+    void BoundsTree::setMargin(float margin) noexcept
+    {
+        // only affects nodes inserted afterwards
+        _margin = margin;
+    }
+
+    float BoundsTree::getMargin() const noexcept
+    {
+        return _margin;
+    }
+
+    size_t BoundsTree::size() const noexcept
+    {
+        return _leafAmount;
+    }
+
+    bool BoundsTree::empty() const noexcept
+    {
+        return _leafAmount == 0;
+    }
+
+    int32_t BoundsTree::getHeight() const noexcept
+    {
+        return _root == nullNode ? 0 : _nodes[_root].height;
+    }
+
+    Entity BoundsTree::getEntity(NodeId id) const noexcept
+    {
+        return _nodes[id].entity;
+    }
+
+    const BoundingBox& BoundsTree::getBounds(NodeId id) const noexcept
+    {
+        return _nodes[id].leafBounds;
+    }
+
+    void BoundsTree::insertLeaf(NodeId leaf) noexcept
+    {
+        if (_root == nullNode)
+        {
+            _root = leaf;
+            _nodes[leaf].parent = nullNode;
+            return;
+        }
+
+        // find the sibling that increases the surface area the least
+        auto leafBounds = _nodes[leaf].bounds;
+        auto index = _root;
+        while (!_nodes[index].isLeaf())
+        {
+            auto& node = _nodes[index];
+            auto area = getSurfaceArea(node.bounds);
+            auto combinedArea = getSurfaceArea(node.bounds + leafBounds);
+
+            // cost of creating a new parent for this node and the leaf
+            auto cost = 2.F * combinedArea;
+
+            // minimum cost of pushing the leaf further down the tree
+            auto inheritanceCost = 2.F * (combinedArea - area);
+
+            auto childCost = [this, &leafBounds, inheritanceCost](NodeId child)
+            {
+                auto& childNode = _nodes[child];
+                auto childArea = getSurfaceArea(childNode.bounds + leafBounds);
+                if (!childNode.isLeaf())
+                {
+                    childArea -= getSurfaceArea(childNode.bounds);
+                }
+                return childArea + inheritanceCost;
+            };
+            auto cost1 = childCost(node.child1);
+            auto cost2 = childCost(node.child2);
+
+            if (cost < cost1 && cost < cost2)
+            {
+                break;
+            }
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        auto sibling = index;
+        auto oldParent = _nodes[sibling].parent;
+        auto newParent = allocateNode();
+        {
+            auto& parentNode = _nodes[newParent];
+            parentNode.parent = oldParent;
+            parentNode.bounds = leafBounds + _nodes[sibling].bounds;
+            parentNode.height = _nodes[sibling].height + 1;
+            parentNode.child1 = sibling;
+            parentNode.child2 = leaf;
+        }
+
+        if (oldParent == nullNode)
+        {
+            _root = newParent;
+        }
+        else if (_nodes[oldParent].child1 == sibling)
+        {
+            _nodes[oldParent].child1 = newParent;
+        }
+        else
+        {
+            _nodes[oldParent].child2 = newParent;
+        }
+        _nodes[sibling].parent = newParent;
+        _nodes[leaf].parent = newParent;
+
+        refitParents(_nodes[leaf].parent);
+    }
+
+    void BoundsTree::removeLeaf(NodeId leaf) noexcept
+    {
+        if (leaf == _root)
+        {
+            _root = nullNode;
+            return;
+        }
+
+        auto parent = _nodes[leaf].parent;
+        auto grandParent = _nodes[parent].parent;
+        auto sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+        if (grandParent == nullNode)
+        {
+            _root = sibling;
+            _nodes[sibling].parent = nullNode;
+            freeNode(parent);
+            return;
+        }
+
+        if (_nodes[grandParent].child1 == parent)
+        {
+            _nodes[grandParent].child1 = sibling;
+        }
+        else
+        {
+            _nodes[grandParent].child2 = sibling;
+        }
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        refitParents(grandParent);
+    }
+
+    void BoundsTree::refitParents(NodeId index) noexcept
+    {
+        while (index != nullNode)
+        {
+            index = balance(index);
+            auto& node = _nodes[index];
+            auto& child1 = _nodes[node.child1];
+            auto& child2 = _nodes[node.child2];
+            node.height = 1 + std::max(child1.height, child2.height);
+            node.bounds = child1.bounds + child2.bounds;
+            index = node.parent;
+        }
+    }
+
+    BoundsTree::NodeId BoundsTree::balance(NodeId iA) noexcept
+    {
+        // tree rotation so that the height difference between children is at most one
+        auto& a = _nodes[iA];
+        if (a.isLeaf() || a.height < 2)
+        {
+            return iA;
+        }
+
+        auto iB = a.child1;
+        auto iC = a.child2;
+        auto& b = _nodes[iB];
+        auto& c = _nodes[iC];
+
+        auto replaceInParent = [this, iA](NodeId parent, NodeId child)
+        {
+            if (parent == nullNode)
+            {
+                _root = child;
+            }
+            else if (_nodes[parent].child1 == iA)
+            {
+                _nodes[parent].child1 = child;
+            }
+            else
+            {
+                _nodes[parent].child2 = child;
+            }
+        };
+
+        auto diff = c.height - b.height;
+        if (diff > 1)
+        {
+            // rotate c up
+            auto iF = c.child1;
+            auto iG = c.child2;
+            auto& f = _nodes[iF];
+            auto& g = _nodes[iG];
+
+            c.child1 = iA;
+            c.parent = a.parent;
+            a.parent = iC;
+            replaceInParent(c.parent, iC);
+
+            if (f.height > g.height)
+            {
+                c.child2 = iF;
+                a.child2 = iG;
+                g.parent = iA;
+                a.bounds = b.bounds + g.bounds;
+                c.bounds = a.bounds + f.bounds;
+                a.height = 1 + std::max(b.height, g.height);
+                c.height = 1 + std::max(a.height, f.height);
+            }
+            else
+            {
+                c.child2 = iG;
+                a.child2 = iF;
+                f.parent = iA;
+                a.bounds = b.bounds + f.bounds;
+                c.bounds = a.bounds + g.bounds;
+                a.height = 1 + std::max(b.height, f.height);
+                c.height = 1 + std::max(a.height, g.height);
+            }
+            return iC;
+        }
+        if (diff < -1)
+        {
+            // rotate b up
+            auto iD = b.child1;
+            auto iE = b.child2;
+            auto& d = _nodes[iD];
+            auto& e = _nodes[iE];
+
+            b.child1 = iA;
+            b.parent = a.parent;
+            a.parent = iB;
+            replaceInParent(b.parent, iB);
+
+            if (d.height > e.height)
+            {
+                b.child2 = iD;
+                a.child1 = iE;
+                e.parent = iA;
+                a.bounds = c.bounds + e.bounds;
+                b.bounds = a.bounds + d.bounds;
+                a.height = 1 + std::max(c.height, e.height);
+                b.height = 1 + std::max(a.height, d.height);
+            }
+            else
+            {
+                b.child2 = iE;
+                a.child1 = iD;
+                d.parent = iA;
+                a.bounds = c.bounds + d.bounds;
+                b.bounds = a.bounds + e.bounds;
+                a.height = 1 + std::max(c.height, d.height);
+                b.height = 1 + std::max(a.height, e.height);
+            }
+            return iB;
+        }
+        return iA;
+    }
+
+    template<typename NodeTest, typename LeafTest>
+    void BoundsTree::traverse(const NodeTest& nodeTest, const LeafTest& leafTest) const noexcept
+    {
+        if (_root == nullNode)
+        {
+            return;
+        }
+        thread_local std::vector<NodeId> stack;
+        stack.clear();
+        stack.push_back(_root);
+        while (!stack.empty())
+        {
+            auto& node = _nodes[stack.back()];
+            stack.pop_back();
+            if (!nodeTest(node.bounds))
+            {
+                continue;
+            }
+            if (node.isLeaf())
+            {
+                leafTest(node);
+                continue;
+            }
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+    void BoundsTree::query(const Frustum& frustum, std::vector<Entity>& entities) const noexcept
+    {
+        auto planes = frustum.getPlanes();
+        query(std::span<const Plane>{ planes }, entities);
+    }
+
+    void BoundsTree::query(std::span<const Plane> planes, std::vector<Entity>& entities) const noexcept
+    {
+        auto canSee = [&planes](const BoundingBox& bbox)
+        {
+            for (auto& plane : planes)
+            {
+                if (plane.isInFront(bbox))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+        traverse(canSee, [&canSee, &entities](const Node& node)
+        {
+            if (canSee(node.leafBounds))
+            {
+                entities.push_back(node.entity);
+            }
+        });
+    }
+
+    void BoundsTree::query(const BoundingBox& bbox, std::vector<Entity>& entities) const noexcept
+    {
+        auto test = [&bbox](const BoundingBox& nodeBounds)
+        {
+            return overlaps(nodeBounds, bbox);
+        };
+        traverse(test, [&test, &entities](const Node& node)
+        {
+            if (test(node.leafBounds))
+            {
+                entities.push_back(node.entity);
+            }
+        });
+    }
+
+    void BoundsTree::query(const Sphere& sphere, std::vector<Entity>& entities) const noexcept
+    {
+        auto test = [&sphere](const BoundingBox& nodeBounds)
+        {
+            return overlaps(nodeBounds, sphere);
+        };
+        traverse(test, [&test, &entities](const Node& node)
+        {
+            if (test(node.leafBounds))
+            {
+                entities.push_back(node.entity);
+            }
+        });
+    }
+
+    std::vector<BoundsTreeHit> BoundsTree::raycast(const Ray& ray, float maxDistance) const noexcept
+    {
+        std::vector<BoundsTreeHit> hits;
+        auto test = [&ray, maxDistance](const BoundingBox& nodeBounds)
+        {
+            auto dist = ray.intersect(nodeBounds);
+            return dist && dist.value() <= maxDistance;
+        };
+        traverse(test, [&ray, maxDistance, &hits](const Node& node)
+        {
+            auto dist = ray.intersect(node.leafBounds);
+            if (dist && dist.value() <= maxDistance)
+            {
+                hits.push_back({ node.entity, dist.value() });
+            }
+        });
+        std::sort(hits.begin(), hits.end(), [](const BoundsTreeHit& a, const BoundsTreeHit& b)
+        {
+            return a.distance < b.distance;
+        });
+        return hits;
+    }
+
+    SceneBoundsTree::Definition SceneBoundsTree::createDefinition() noexcept
+    {
+        Definition def;
+        def.set_margin(0.1F);
+        return def;
+    }
+
+    SceneBoundsTree::SceneBoundsTree(const Definition& def) noexcept
+        : _def{ def }
+        , _tree{ def.margin() }
+    {
+    }
+
+    template<typename T>
+    void SceneBoundsTree::connectSignals(Scene& scene) noexcept
+    {
+        scene.onConstructComponent<T>().template connect<&SceneBoundsTree::onEntityChanged>(*this);
+        scene.onUpdateComponent<T>().template connect<&SceneBoundsTree::onEntityChanged>(*this);
+        scene.onDestroyComponent<T>().template connect<&SceneBoundsTree::onEntityChanged>(*this);
+    }
+
+    template<typename T>
+    void SceneBoundsTree::disconnectSignals(Scene& scene) noexcept
+    {
+        scene.onConstructComponent<T>().template disconnect<&SceneBoundsTree::onEntityChanged>(*this);
+        scene.onUpdateComponent<T>().template disconnect<&SceneBoundsTree::onEntityChanged>(*this);
+        scene.onDestroyComponent<T>().template disconnect<&SceneBoundsTree::onEntityChanged>(*this);
+    }
+
+    expected<void, std::string> SceneBoundsTree::init(Scene& scene, App& app) noexcept
+    {
+        _scene = scene;
+        connectSignals<Renderable>(scene);
+        connectSignals<BoundingBox>(scene);
+        scene.onConstructComponent<Transform>().connect<&SceneBoundsTree::onTransformHierarchyChanged>(*this);
+        scene.onUpdateComponent<Transform>().connect<&SceneBoundsTree::onEntityChanged>(*this);
+        scene.onDestroyComponent<Transform>().connect<&SceneBoundsTree::onTransformHierarchyChanged>(*this);
+#ifdef DARMOK_JOLT
+        connectSignals<physics3d::PhysicsBody>(scene);
+#endif
+        setAllDirty();
+        refit();
+        return {};
+    }
+
+    expected<void, std::string> SceneBoundsTree::load(const Definition& def) noexcept
+    {
+        _def = def;
+        _tree.clear();
+        _tree.setMargin(def.margin());
+        _proxies.clear();
+        setAllDirty();
+        refit();
+        return {};
+    }
+
+    expected<void, std::string> SceneBoundsTree::shutdown() noexcept
+    {
+        if (_scene)
+        {
+            auto& scene = _scene.value();
+            disconnectSignals<Renderable>(scene);
+            disconnectSignals<BoundingBox>(scene);
+            scene.onConstructComponent<Transform>().disconnect<&SceneBoundsTree::onTransformHierarchyChanged>(*this);
+            scene.onUpdateComponent<Transform>().disconnect<&SceneBoundsTree::onEntityChanged>(*this);
+            scene.onDestroyComponent<Transform>().disconnect<&SceneBoundsTree::onTransformHierarchyChanged>(*this);
+#ifdef DARMOK_JOLT
+            disconnectSignals<physics3d::PhysicsBody>(scene);
+#endif
+            _scene.reset();
+        }
+        _tree.clear();
+        _proxies.clear();
+        _dirtyEntities.clear();
+        return {};
+    }
+
+    expected<void, std::string> SceneBoundsTree::update(float deltaTime) noexcept
+    {
+        refit();
+        return {};
+    }
+
+    void SceneBoundsTree::removeProxy(Proxy& proxy) noexcept
+    {
+        _tree.remove(proxy.node);
+        proxy = Proxy{};
+    }
+
+    void SceneBoundsTree::setAllDirty() noexcept
+    {
+        if (!_scene)
+        {
+            return;
+        }
+        for (auto entity : _scene->getEntities(CullingUtils::getEntityFilter()))
+        {
+            _dirtyEntities.insert(entity);
+        }
+    }
+
+    void SceneBoundsTree::onEntityChanged(EntityRegistry& registry, Entity entity) noexcept
+    {
+        _dirtyEntities.insert(entity);
+    }
+
+    void SceneBoundsTree::onTransformHierarchyChanged(EntityRegistry& registry, Entity entity) noexcept
+    {
+        // the children change the transform they inherit
+        // moving transforms are patched with their children in the scene update
+        _dirtyEntities.insert(entity);
+        if (_scene)
+        {
+            _scene->forEachChild(entity, [this](auto child, auto& trans) {
+                _dirtyEntities.insert(child);
+                return false;
+            });
+        }
+    }
+
+    void SceneBoundsTree::refit() noexcept
+    {
+        if (!_scene || _dirtyEntities.empty())
+        {
+            return;
+        }
+        auto& scene = _scene.value();
+        for (auto entity : _dirtyEntities)
+        {
+            std::optional<BoundingBox> bounds;
+            if (scene.isEntityAlive(entity) && scene.hasComponent<Renderable>(entity))
+            {
+                bounds = CullingUtils::getEntityBounds(scene, entity);
+            }
+            auto index = static_cast<size_t>(entt::to_entity(entity));
+            if (!bounds)
+            {
+                // destroyed or lost its bounds
+                if (index < _proxies.size() && _proxies[index].entity == entity)
+                {
+                    removeProxy(_proxies[index]);
+                }
+                continue;
+            }
+            if (index >= _proxies.size())
+            {
+                _proxies.resize(index + 1);
+            }
+            auto& proxy = _proxies[index];
+            if (proxy.entity != entity && proxy.entity != entt::null)
+            {
+                // the entity index was recycled
+                removeProxy(proxy);
+            }
+            auto worldBounds = bounds.value();
+            // same transform the renderers use
+            if (auto trans = scene.getComponentInParent<const Transform>(entity))
+            {
+                worldBounds = worldBounds * trans->getWorldMatrix();
+            }
+            if (proxy.entity == entity)
+            {
+                _tree.update(proxy.node, worldBounds);
+            }
+            else
+            {
+                proxy.entity = entity;
+                proxy.node = _tree.insert(entity, worldBounds);
+            }
+        }
+        _dirtyEntities.clear();
+    }
+
+    bool SceneBoundsTree::contains(Entity entity) const noexcept
+    {
+        auto index = static_cast<size_t>(entt::to_entity(entity));
+        return index < _proxies.size() && _proxies[index].entity == entity;
+    }
+
+    const BoundsTree& SceneBoundsTree::getTree() const noexcept
+    {
+        return _tree;
+    }
+
+    std::vector<Entity> SceneBoundsTree::query(const Frustum& frustum) const noexcept
+    {
+        std::vector<Entity> entities;
+        _tree.query(frustum, entities);
+        return entities;
+    }
+
+    std::vector<Entity> SceneBoundsTree::query(const BoundingBox& bbox) const noexcept
+    {
+        std::vector<Entity> entities;
+        _tree.query(bbox, entities);
+        return entities;
+    }
+
+    std::vector<Entity> SceneBoundsTree::query(const Sphere& sphere) const noexcept
+    {
+        std::vector<Entity> entities;
+        _tree.query(sphere, entities);
+        return entities;
+    }
+
+    std::vector<BoundsTreeHit> SceneBoundsTree::raycast(const Ray& ray, float maxDistance) const noexcept
+    {
+        return _tree.raycast(ray, maxDistance);
+    }
+}
@@ -290,6 +290,10 @@ namespace darmok
         _scene = scene;
         _app = app;
 
+        // entities are recorded from multiple threads, see beforeRenderEntity
+        scene.createComponentStorage<Transform>();
+        scene.createComponentStorage<Renderable>();
+
         auto result = _renderChain.init();
         if (!result)
         {
@@ -502,7 +506,8 @@ namespace darmok
     {
         setEntityTransform(entity, encoder);
 		std::vector<std::string> errors;
-        for (auto& comp : copyComponents())
+        // components cannot change while recording, copying them here would contend on the reference counts
+        for (auto& comp : _components)
         {
             auto result = comp->beforeRenderEntity(entity, viewId, encoder);
             if (!result)
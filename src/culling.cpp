@@ -7,49 +7,40 @@
 #include <darmok/mesh.hpp>
 #include <darmok/render_chain.hpp>
 #include <darmok/transform.hpp>
-
-#ifdef DARMOK_JOLT
-#include <darmok/physics3d.hpp>
-#endif
+#include <darmok/string.hpp>
+#include <darmok/app.hpp>
+#include <darmok/glm_serialize.hpp>
+#include <darmok/mesh_core.hpp>
+#include <darmok/bounds_tree.hpp>
+#include "detail/render_scene.hpp"
+#include "detail/culling.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/component_wise.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
 
 namespace darmok
 {
-    struct CullingUtils final
-    {
-        static std::optional<BoundingBox> getEntityBounds(Scene& scene, Entity& entity) noexcept
-        {
-            if (auto bbox = scene.getComponent<BoundingBox>(entity))
-            {
-                return bbox.value();
-            }
-            #ifdef DARMOK_JOLT
-                if (auto body = scene.getComponent<physics3d::PhysicsBody>(entity))
-                {
-                    return body->getLocalBounds();
-                }
-            #endif
-            return std::nullopt;
-        }
-
-        static const EntityFilter& getEntityFilter() noexcept
-        {
-            static const EntityFilter filter = EntityFilter::create<Renderable>() & (EntityFilter::create<BoundingBox>()
-#ifdef DARMOK_JOLT
-                 | EntityFilter::create<physics3d::PhysicsBody>()
-#endif
-            );
-            return filter;
-        }
-    };
-
     OcclusionCuller::Definition OcclusionCuller::createDefinition() noexcept
     {
         Definition def;
+        def.set_queries_per_frame(256);
+        def.set_max_result_age(16);
         return def;
     }
 
+    OcclusionCuller::OcclusionCuller(const Definition& def) noexcept
+        : _def{ def }
+        , _nextQuery{ 0 }
+        , _frame{ 0 }
+        , _queryPoolSize{ 0 }
+    {
+    }
+
     OcclusionCuller::~OcclusionCuller() noexcept
     {
         clearQueries();
@@ -59,29 +50,41 @@ namespace darmok
     {
         _cam = cam;
         _scene = scene;
+        _app = app;
         auto progResult = StandardProgramLoader::load(Program::Standard::Unlit);
         if (!progResult)
         {
             return unexpected{ std::move(progResult).error() };
         }
         _prog = progResult.value();
+        // all the queries share a unit cube scaled to the entity bounds
+        auto meshResult = MeshData{ Cube{} }.createMesh(_prog->getVertexLayout());
+        if (!meshResult)
+        {
+            return unexpected{ std::move(meshResult).error() };
+        }
+        _cubeMesh = std::make_unique<Mesh>(std::move(meshResult).value());
         scene.onDestroyComponent<Renderable>().connect<&OcclusionCuller::onRenderableDestroyed>(*this);
         return {};
     }
 
     expected<void, std::string> OcclusionCuller::load(const Definition& def) noexcept
     {
+        _def = def;
         return {};
     }
 
     void OcclusionCuller::onRenderableDestroyed(EntityRegistry& registry, Entity entity) noexcept
     {
-        auto itr = _queries.find(entity);
-        if (itr != _queries.end())
+        for (auto& slot : _querySlots)
         {
-            _freeQueries.push_back(itr->second);
-            _queries.erase(itr);
+            if (slot.entity == entity)
+            {
+                // the handle stays busy until its result is available
+                slot.entity = entt::null;
+            }
         }
+        _results.erase(entity);
     }
 
     expected<bgfx::ViewId, std::string> OcclusionCuller::renderReset(bgfx::ViewId viewId) noexcept
@@ -119,164 +122,708 @@ namespace darmok
             _scene.reset();
         }
         _cam.reset();
+        _app.reset();
         _viewId.reset();
         _prog.reset();
+        _cubeMesh.reset();
+        _pendingQueries.clear();
         clearQueries();
         return {};
     }
 
     void OcclusionCuller::clearQueries() noexcept
     {
-        for (auto& [entity, query] : _queries)
+        for (auto& slot : _querySlots)
         {
-            bgfx::destroy(query);
+            bgfx::destroy(slot.handle);
+        }
+        _querySlots.clear();
+        _queryPoolSize = 0;
+        _results.clear();
+        _nextQuery = 0;
+    }
 
+    void OcclusionCuller::createQueries() noexcept
+    {
+        // bgfx has a fixed amount of occlusion query handles
+        uint32_t size = bgfx::getCaps()->limits.maxOcclusionQueries;
+        auto maxAmount = _def.queries_per_frame();
+        if (maxAmount > 0)
+        {
+            size = std::min(size, maxAmount);
         }
-        _queries.clear();
-        for (auto& query : _freeQueries)
+        if (size == _queryPoolSize)
         {
-            bgfx::destroy(query);
-
+            return;
+        }
+        clearQueries();
+        _queryPoolSize = size;
+        _querySlots.reserve(size);
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            auto handle = bgfx::createOcclusionQuery();
+            if (!isValid(handle))
+            {
+                break;
+            }
+            _querySlots.push_back({ handle });
         }
-        _freeQueries.clear();
     }
 
     expected<void, std::string> OcclusionCuller::render() noexcept
     {
-        return updateQueries();
+        updateResults();
+        auto result = updateQueries();
+        ++_frame;
+        return result;
+    }
+
+    void OcclusionCuller::updateResults() noexcept
+    {
+        // bgfx resolves the queries some frames after they are submitted
+        // and keeps the last available result until the query is resolved again
+        static constexpr uint32_t queryLatency = 2;
+        for (auto& slot : _querySlots)
+        {
+            if (!slot.submitted || _frame - slot.frame < queryLatency)
+            {
+                continue;
+            }
+            // the handle can be reused once its result is read
+            slot.submitted = false;
+            auto entity = slot.entity;
+            slot.entity = entt::null;
+            if (entity == entt::null)
+            {
+                continue;
+            }
+            auto result = bgfx::getResult(slot.handle);
+            if (result == bgfx::OcclusionQueryResult::NoResult)
+            {
+                continue;
+            }
+            auto itr = _results.find(entity);
+            if (itr != _results.end())
+            {
+                itr->second.occluded = result == bgfx::OcclusionQueryResult::Invisible;
+            }
+        }
     }
 
     expected<void, std::string> OcclusionCuller::updateQueries() noexcept
     {
-        if (!_scene || !_viewId || !_cam || !_cam->isEnabled())
+        if (!_scene || !_viewId || !_cam || !_cam->isEnabled() || !_cubeMesh)
         {
             return {};
         }
 
-        static const uint64_t state = BGFX_STATE_DEPTH_TEST_LEQUAL | BGFX_STATE_CULL_CW;
-
         auto viewId = _viewId.value();
-        auto& encoder = *bgfx::begin();
-        auto prog = _prog->getHandle();
-        auto& layout = _prog->getVertexLayout();
         auto& scene = _scene.value();
+        createQueries();
+        std::vector<size_t> freeSlots;
+        for (size_t i = 0; i < _querySlots.size(); ++i)
+        {
+            if (!_querySlots[i].submitted)
+            {
+                freeSlots.push_back(i);
+            }
+        }
+
         auto entities = _cam->getEntities(CullingUtils::getEntityFilter());
         _cam->setViewTransform(viewId);
-        std::vector<std::string> errors;
+
+        _pendingQueries.clear();
         for (auto entity : entities)
         {
             if (auto bounds = CullingUtils::getEntityBounds(scene, entity))
             {
-                _cam->setEntityTransform(entity, encoder);
-                MeshData meshData{ Cube{ *bounds } };
-                meshData.type = Mesh::Definition::Transient;
-                auto meshResult = meshData.createMesh(layout);
-                if (!meshResult)
-                {
-					errors.push_back(std::move(meshResult).error());
-				}
-                auto renderResult = meshResult.value().render(encoder);
+                auto trans = glm::translate(glm::mat4{ 1 }, bounds->getCenter()) * glm::scale(glm::mat4{ 1 }, bounds->size());
+                _pendingQueries.push_back({ entity, trans });
+            }
+        }
+
+        // only a slice of the entities is queried each frame, the rest keep their cached results
+        auto amount = _pendingQueries.size();
+        auto maxAmount = freeSlots.size();
+        if (amount > maxAmount)
+        {
+            auto start = _nextQuery % amount;
+            std::rotate(_pendingQueries.begin(), _pendingQueries.begin() + start, _pendingQueries.end());
+            _pendingQueries.resize(maxAmount);
+            _nextQuery = start + maxAmount;
+        }
+        else
+        {
+            _nextQuery = 0;
+        }
+
+        // queries are assigned on the main thread before recording
+        for (size_t i = 0; i < _pendingQueries.size(); ++i)
+        {
+            auto& pending = _pendingQueries[i];
+            auto& slot = _querySlots[freeSlots[i]];
+            slot.entity = pending.entity;
+            slot.frame = _frame;
+            slot.submitted = true;
+            pending.query = slot.handle;
+            _results[pending.entity].frame = _frame;
+        }
+
+        auto prog = _prog->getHandle();
+        auto recordQueries = [this, viewId, prog](bgfx::Encoder& encoder, size_t start, size_t end) -> expected<void, std::string>
+        {
+            std::vector<std::string> errors;
+            for (auto i = start; i < end; ++i)
+            {
+                auto& pending = _pendingQueries[i];
+                _cam->setEntityTransform(pending.entity, encoder, pending.transform);
+                auto renderResult = _cubeMesh->render(encoder);
                 if (!renderResult)
                 {
                     errors.push_back(std::move(renderResult).error());
+                    continue;
                 }
-                auto occlusion = getQuery(entity);
-                bgfx::setCondition(occlusion, true);
-                encoder.submit(viewId, prog, occlusion);
+                encoder.submit(viewId, prog, pending.query);
             }
-        }
+            return StringUtils::joinExpectedErrors(errors);
+        };
 
+        auto& encoder = *bgfx::begin();
+        auto result = RenderParallelUtils::record(_app->getTaskExecutor(), encoder, _pendingQueries.size(), recordQueries);
         bgfx::end(&encoder);
-        return StringUtils::joinExpectedErrors(errors);
+        return result;
     }
 
-    bgfx::OcclusionQueryHandle OcclusionCuller::getQuery(Entity entity) noexcept
+    bool OcclusionCuller::shouldEntityBeCulled(Entity entity) noexcept
     {
-        auto itr = _queries.find(entity);
-        if (itr != _queries.end())
+        auto itr = _results.find(entity);
+        if (itr == _results.end() || !itr->second.occluded)
+        {
+            return false;
+        }
+        // old results are not trusted so that entities do not stay hidden
+        auto maxAge = _def.max_result_age();
+        return maxAge == 0 || _frame - itr->second.frame <= maxAge;
+    }
+
+    FrustumCuller::Definition FrustumCuller::createDefinition() noexcept
+    {
+        Definition def;
+        return def;
+    }
+
+    expected<void, std::string> FrustumCuller::init(Camera& cam, Scene& scene, App& app) noexcept
+    {
+        _cam = cam;
+        _scene = scene;
+        return {};
+    }
+
+    expected<void, std::string> FrustumCuller::load(const Definition& def) noexcept
+    {
+        return {};
+    }
+
+    expected<void, std::string> FrustumCuller::shutdown() noexcept
+    {
+        _cam.reset();
+        _scene.reset();
+        _bounds.resize(0);
+        _boundsStates.clear();
+        _outside.clear();
+        _active.clear();
+        _culled.clear();
+        _tree.reset();
+        _treeEntities.clear();
+        _treeVisible.clear();
+        return {};
+    }
+
+    expected<void, std::string> FrustumCuller::update(float deltaTime) noexcept
+    {
+        _tree.reset();
+        if (auto tree = _scene->getSceneComponent<SceneBoundsTree>())
+        {
+            // cameras update before the scene components
+            tree->refit();
+            _tree = tree.value();
+            updateTreeVisible();
+            return {};
+        }
+        updateBounds();
+        updateCulled();
+        return {};
+    }
+
+    void FrustumCuller::updateTreeVisible() noexcept
+    {
+        std::fill(_treeVisible.begin(), _treeVisible.end(), 0);
+        _treeEntities.clear();
+        _tree->getTree().query(Frustum{ _cam->getViewProjectionMatrix() }, _treeEntities);
+        for (auto entity : _treeEntities)
+        {
+            auto index = static_cast<size_t>(entt::to_entity(entity));
+            if (index / 64 >= _treeVisible.size())
+            {
+                _treeVisible.resize((index / 64) + 1, 0);
+            }
+            _treeVisible[index / 64] |= uint64_t{ 1 } << (index % 64);
+        }
+    }
+
+    void FrustumCuller::BoundsArray::resize(size_t size) noexcept
+    {
+        minX.resize(size);
+        minY.resize(size);
+        minZ.resize(size);
+        maxX.resize(size);
+        maxY.resize(size);
+        maxZ.resize(size);
+    }
+
+    void FrustumCuller::BoundsArray::set(size_t index, const BoundingBox& bbox) noexcept
+    {
+        minX[index] = bbox.min.x;
+        minY[index] = bbox.min.y;
+        minZ[index] = bbox.min.z;
+        maxX[index] = bbox.max.x;
+        maxY[index] = bbox.max.y;
+        maxZ[index] = bbox.max.z;
+    }
+
+    void FrustumCuller::updateBounds() noexcept
+    {
+        std::fill(_active.begin(), _active.end(), 0);
+        auto& scene = _scene.value();
+        for (auto entity : _cam->getEntities(CullingUtils::getEntityFilter()))
+        {
+            auto bounds = CullingUtils::getEntityBounds(scene, entity);
+            if (!bounds)
+            {
+                continue;
+            }
+            auto index = static_cast<size_t>(entt::to_entity(entity));
+            if (index >= _boundsStates.size())
+            {
+                // keep the size a multiple of the word size for the bitsets
+                auto size = ((index / 64) + 1) * 64;
+                _boundsStates.resize(size);
+                _bounds.resize(size);
+                _active.resize(size / 64, 0);
+            }
+            _active[index / 64] |= uint64_t{ 1 } << (index % 64);
+
+            // world bounds are only recalculated when the transform changed
+            auto trans = scene.getComponent<const Transform>(entity);
+            auto version = trans ? trans->getVersion() : 0;
+            auto& state = _boundsStates[index];
+            if (state.entity == entity && state.version == version && state.localBounds == bounds.value())
+            {
+                continue;
+            }
+            state.entity = entity;
+            state.version = version;
+            state.localBounds = bounds.value();
+            _bounds.set(index, trans ? bounds.value() * trans->getWorldMatrix() : bounds.value());
+        }
+    }
+
+    void FrustumCuller::updateCulled() noexcept
+    {
+        auto size = _boundsStates.size();
+        _culled.assign(_active.size(), 0);
+        _outside.assign(size, 0);
+        if (size == 0)
+        {
+            return;
+        }
+
+        const Frustum frust{ _cam->getViewProjectionMatrix() };
+        for (auto& plane : frust.getPlanes())
         {
-            return itr->second;
+            // a box is outside if its vertex nearest to the plane is in front of it
+            auto normal = glm::normalize(plane.normal);
+            auto dist = plane.distance;
+            auto xs = normal.x > 0.F ? _bounds.minX.data() : _bounds.maxX.data();
+            auto ys = normal.y > 0.F ? _bounds.minY.data() : _bounds.maxY.data();
+            auto zs = normal.z > 0.F ? _bounds.minZ.data() : _bounds.maxZ.data();
+            auto outside = _outside.data();
+
+            // branchless so that the compiler can vectorize it
+            for (size_t i = 0; i < size; ++i)
+            {
+                auto d = (xs[i] * normal.x) + (ys[i] * normal.y) + (zs[i] * normal.z) - dist;
+                outside[i] |= static_cast<uint8_t>(d > 0.F);
+            }
         }
-        if (!_freeQueries.empty())
+
+        for (size_t word = 0; word < _culled.size(); ++word)
         {
-            auto query = _freeQueries.back();
-            _freeQueries.pop_back();
-            _queries.insert(itr, std::make_pair(entity, query));
-            return query;
+            auto active = _active[word];
+            if (active == 0)
+            {
+                continue;
+            }
+            uint64_t culled = 0;
+            auto offset = word * 64;
+            for (size_t bit = 0; bit < 64; ++bit)
+            {
+                culled |= static_cast<uint64_t>(_outside[offset + bit]) << bit;
+            }
+            _culled[word] = culled & active;
         }
-        auto query = bgfx::createOcclusionQuery();
-        _queries[entity] = query;
-        return query;
     }
 
-    std::optional<bgfx::OcclusionQueryResult::Enum> OcclusionCuller::getQueryResult(Entity entity) const noexcept
+    bool FrustumCuller::shouldEntityBeCulled(Entity entity) noexcept
     {
-        auto itr = _queries.find(entity);
-        if (itr != _queries.end())
+        auto index = static_cast<size_t>(entt::to_entity(entity));
+        if (_tree)
+        {
+            if (!_tree->contains(entity))
+            {
+                return false;
+            }
+            return index / 64 >= _treeVisible.size() || ((_treeVisible[index / 64] >> (index % 64)) & 1) == 0;
+        }
+        if (index >= _boundsStates.size() || _boundsStates[index].entity != entity)
         {
-            auto result = bgfx::getResult(itr->second);
-            return result;
+            return false;
         }
-        return std::nullopt;
+        return (_culled[index / 64] >> (index % 64)) & 1;
     }
 
-    expected<void, std::string> OcclusionCuller::beforeRenderEntity(Entity entity, bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept
+    Occluder::Occluder(const MeshData& data) noexcept
     {
-        auto itr = _queries.find(entity);
-        if (itr != _queries.end())
+        vertices.reserve(data.vertices.size());
+        for (auto& vert : data.vertices)
         {
-            encoder.setCondition(itr->second, true);
+            vertices.push_back(vert.position);
         }
+        indices = data.indices;
+    }
+
+    Occluder::Definition Occluder::createDefinition() noexcept
+    {
+        Definition def;
+        *def.mutable_mesh()->mutable_cube()->mutable_shape() = Cube::createDefinition();
+        return def;
+    }
+
+    expected<void, std::string> Occluder::load(const Definition& def) noexcept
+    {
+        *this = Occluder{ MeshData{ def.mesh() } };
         return {};
     }
 
-    FrustumCuller::Definition FrustumCuller::createDefinition() noexcept
+    const float OcclusionDepthBuffer::_clearDepth = std::numeric_limits<float>::max();
+    const float OcclusionDepthBuffer::_minClipW = 1e-5F;
+
+    OcclusionDepthBuffer::OcclusionDepthBuffer(const glm::uvec2& size) noexcept
+        : _size{ 0 }
+    {
+        resize(size);
+    }
+
+    void OcclusionDepthBuffer::resize(const glm::uvec2& size) noexcept
+    {
+        if (_size == size && !_levels.empty())
+        {
+            return;
+        }
+        _size = size;
+        _levels.clear();
+        if (size.x == 0 || size.y == 0)
+        {
+            return;
+        }
+        auto levelSize = size;
+        while (true)
+        {
+            auto& level = _levels.emplace_back();
+            level.size = levelSize;
+            level.depth.resize(static_cast<size_t>(levelSize.x) * levelSize.y, _clearDepth);
+            if (levelSize.x == 1 && levelSize.y == 1)
+            {
+                break;
+            }
+            levelSize = glm::max((levelSize + 1U) / 2U, glm::uvec2{ 1 });
+        }
+    }
+
+    void OcclusionDepthBuffer::clear() noexcept
+    {
+        for (auto& level : _levels)
+        {
+            std::fill(level.depth.begin(), level.depth.end(), _clearDepth);
+        }
+    }
+
+    glm::vec3 OcclusionDepthBuffer::toScreen(const glm::vec4& clip) const noexcept
+    {
+        auto ndc = glm::vec3{ clip } / clip.w;
+        return {
+            (ndc.x + 1.F) * 0.5F * static_cast<float>(_size.x),
+            (1.F - ndc.y) * 0.5F * static_cast<float>(_size.y),
+            ndc.z
+        };
+    }
+
+    void OcclusionDepthBuffer::rasterize(const glm::mat4& modelViewProj, std::span<const glm::vec3> vertices, std::span<const VertexIndex> indices) noexcept
+    {
+        if (_levels.empty())
+        {
+            return;
+        }
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            std::array<glm::vec3, 3> screen;
+            auto clipped = false;
+            for (size_t j = 0; j < 3; ++j)
+            {
+                auto index = indices[i + j];
+                if (index >= vertices.size())
+                {
+                    clipped = true;
+                    break;
+                }
+                auto clip = modelViewProj * glm::vec4{ vertices[index], 1.F };
+                // skipping triangles that cross the near plane only makes the buffer less occluding
+                if (clip.w < _minClipW)
+                {
+                    clipped = true;
+                    break;
+                }
+                screen[j] = toScreen(clip);
+            }
+            if (!clipped)
+            {
+                rasterizeTriangle(screen[0], screen[1], screen[2]);
+            }
+        }
+    }
+
+    void OcclusionDepthBuffer::rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) noexcept
+    {
+        auto area = ((v1.x - v0.x) * (v2.y - v0.y)) - ((v1.y - v0.y) * (v2.x - v0.x));
+        if (std::abs(area) < 1e-8F)
+        {
+            return;
+        }
+        auto minPos = glm::max(glm::floor(glm::min(v0, glm::min(v1, v2))), glm::vec3{ 0.F });
+        auto maxPos = glm::min(glm::ceil(glm::max(v0, glm::max(v1, v2))), glm::vec3{ glm::vec2{ _size } - 1.F, 0.F });
+        if (minPos.x > maxPos.x || minPos.y > maxPos.y)
+        {
+            return;
+        }
+
+        // edge functions normalized so that both windings are rasterized
+        auto invArea = 1.F / area;
+        auto edge = [invArea](const glm::vec3& a, const glm::vec3& b)
+        {
+            // value at (x, y) = c + x * dx + y * dy
+            glm::vec3 e{ (a.y - b.y) * invArea, (b.x - a.x) * invArea, ((a.x * b.y) - (a.y * b.x)) * invArea };
+            return e;
+        };
+        auto e0 = edge(v1, v2);
+        auto e1 = edge(v2, v0);
+        auto e2 = edge(v0, v1);
+
+        auto& level = _levels.front();
+        auto startX = static_cast<uint32_t>(minPos.x);
+        auto endX = static_cast<uint32_t>(maxPos.x);
+        for (auto y = static_cast<uint32_t>(minPos.y); y <= static_cast<uint32_t>(maxPos.y); ++y)
+        {
+            auto py = static_cast<float>(y) + 0.5F;
+            auto row = &level.depth[static_cast<size_t>(y) * level.size.x];
+            // branchless row loop so the compiler can vectorize it
+            for (auto x = startX; x <= endX; ++x)
+            {
+                auto px = static_cast<float>(x) + 0.5F;
+                auto w0 = (e0.x * px) + (e0.y * py) + e0.z;
+                auto w1 = (e1.x * px) + (e1.y * py) + e1.z;
+                auto w2 = (e2.x * px) + (e2.y * py) + e2.z;
+                auto inside = w0 >= 0.F && w1 >= 0.F && w2 >= 0.F;
+                auto depth = (w0 * v0.z) + (w1 * v1.z) + (w2 * v2.z);
+                row[x] = inside ? std::min(row[x], depth) : row[x];
+            }
+        }
+    }
+
+    void OcclusionDepthBuffer::buildPyramid() noexcept
+    {
+        for (size_t i = 1; i < _levels.size(); ++i)
+        {
+            auto& src = _levels[i - 1];
+            auto& dst = _levels[i];
+            for (uint32_t y = 0; y < dst.size.y; ++y)
+            {
+                auto y0 = static_cast<size_t>(y) * 2;
+                auto y1 = std::min<size_t>(y0 + 1, src.size.y - 1);
+                for (uint32_t x = 0; x < dst.size.x; ++x)
+                {
+                    auto x0 = static_cast<size_t>(x) * 2;
+                    auto x1 = std::min<size_t>(x0 + 1, src.size.x - 1);
+                    // keep the farthest depth so that the test stays conservative
+                    auto depth = std::max(
+                        std::max(src.depth[(y0 * src.size.x) + x0], src.depth[(y0 * src.size.x) + x1]),
+                        std::max(src.depth[(y1 * src.size.x) + x0], src.depth[(y1 * src.size.x) + x1]));
+                    dst.depth[(static_cast<size_t>(y) * dst.size.x) + x] = depth;
+                }
+            }
+        }
+    }
+
+    bool OcclusionDepthBuffer::isOccluded(const glm::mat4& modelViewProj, const BoundingBox& bbox) const noexcept
+    {
+        if (_levels.empty())
+        {
+            return false;
+        }
+        glm::vec3 minPos{ std::numeric_limits<float>::max() };
+        glm::vec3 maxPos{ std::numeric_limits<float>::lowest() };
+        for (auto& corner : bbox.getCorners())
+        {
+            auto clip = modelViewProj * glm::vec4{ corner, 1.F };
+            if (clip.w < _minClipW)
+            {
+                return false;
+            }
+            auto screen = toScreen(clip);
+            minPos = glm::min(minPos, screen);
+            maxPos = glm::max(maxPos, screen);
+        }
+        auto size = glm::vec2{ _size };
+        if (maxPos.x < 0.F || maxPos.y < 0.F || minPos.x >= size.x || minPos.y >= size.y)
+        {
+            return false;
+        }
+        auto minTexel = glm::uvec2{ glm::clamp(glm::vec2{ minPos }, glm::vec2{ 0.F }, size - 1.F) };
+        auto maxTexel = glm::uvec2{ glm::clamp(glm::vec2{ maxPos }, glm::vec2{ 0.F }, size - 1.F) };
+
+        // pick the level where the rect covers at most 2x2 texels
+        auto span = glm::compMax(maxTexel - minTexel) + 1U;
+        size_t levelIndex = 0;
+        while ((1U << levelIndex) < span && levelIndex + 1 < _levels.size())
+        {
+            ++levelIndex;
+        }
+        auto& level = _levels[levelIndex];
+        minTexel >>= static_cast<uint32_t>(levelIndex);
+        maxTexel = glm::min(maxTexel >> static_cast<uint32_t>(levelIndex), level.size - 1U);
+
+        auto depth = std::numeric_limits<float>::lowest();
+        for (auto y = minTexel.y; y <= maxTexel.y; ++y)
+        {
+            for (auto x = minTexel.x; x <= maxTexel.x; ++x)
+            {
+                depth = std::max(depth, level.depth[(static_cast<size_t>(y) * level.size.x) + x]);
+            }
+        }
+        return minPos.z > depth;
+    }
+
+    const glm::uvec2& OcclusionDepthBuffer::getSize() const noexcept
+    {
+        return _size;
+    }
+
+    size_t OcclusionDepthBuffer::getLevelAmount() const noexcept
+    {
+        return _levels.size();
+    }
+
+    float OcclusionDepthBuffer::getDepth(const glm::uvec2& pos, size_t level) const noexcept
+    {
+        if (level >= _levels.size())
+        {
+            return _clearDepth;
+        }
+        auto& lvl = _levels[level];
+        if (pos.x >= lvl.size.x || pos.y >= lvl.size.y)
+        {
+            return _clearDepth;
+        }
+        return lvl.depth[(static_cast<size_t>(pos.y) * lvl.size.x) + pos.x];
+    }
+
+    SoftwareOcclusionCuller::Definition SoftwareOcclusionCuller::createDefinition() noexcept
     {
         Definition def;
+        *def.mutable_resolution() = convert<protobuf::Uvec2>(glm::uvec2{ 256, 128 });
         return def;
     }
 
-    expected<void, std::string> FrustumCuller::init(Camera& cam, Scene& scene, App& app) noexcept
+    SoftwareOcclusionCuller::SoftwareOcclusionCuller(const Definition& def) noexcept
+        : _def{ def }
+    {
+    }
+
+    expected<void, std::string> SoftwareOcclusionCuller::init(Camera& cam, Scene& scene, App& app) noexcept
     {
         _cam = cam;
         _scene = scene;
         return {};
     }
 
-    expected<void, std::string> FrustumCuller::load(const Definition& def) noexcept
+    expected<void, std::string> SoftwareOcclusionCuller::load(const Definition& def) noexcept
     {
+        _def = def;
         return {};
     }
 
-    expected<void, std::string> FrustumCuller::shutdown() noexcept
+    expected<void, std::string> SoftwareOcclusionCuller::shutdown() noexcept
     {
         _cam.reset();
         _scene.reset();
+        _culled.clear();
         return {};
     }
 
-    expected<void, std::string> FrustumCuller::update(float deltaTime) noexcept
+    expected<void, std::string> SoftwareOcclusionCuller::update(float deltaTime) noexcept
     {
+        if (!_cam || !_scene)
+        {
+            return {};
+        }
+        updateDepth();
         updateCulled();
         return {};
     }
 
-    void FrustumCuller::updateCulled() noexcept
+    void SoftwareOcclusionCuller::updateDepth() noexcept
     {
+        _depth.resize(convert<glm::uvec2>(_def.resolution()));
+        _depth.clear();
         auto& scene = _scene.value();
-        auto entities = _cam->getEntities(CullingUtils::getEntityFilter());
-        const Frustum camFrust{ _cam->getViewProjectionMatrix() };
+        auto viewProj = _cam->getViewProjectionMatrix();
+        for (auto entity : _cam->getEntities<Occluder>())
+        {
+            auto& occluder = scene.getComponent<const Occluder>(entity).value();
+            auto mvp = viewProj;
+            if (auto trans = scene.getComponentInParent<const Transform>(entity))
+            {
+                mvp *= trans->getWorldMatrix();
+            }
+            _depth.rasterize(mvp, occluder.vertices, occluder.indices);
+        }
+        _depth.buildPyramid();
+    }
+
+    void SoftwareOcclusionCuller::updateCulled() noexcept
+    {
+        auto& scene = _scene.value();
+        auto viewProj = _cam->getViewProjectionMatrix();
         _culled.clear();
-        for (auto entity : entities)
+        for (auto entity : _cam->getEntities(CullingUtils::getEntityFilter()))
         {
             if (auto bounds = CullingUtils::getEntityBounds(scene, entity))
             {
-                Frustum frust = camFrust;
-                if (auto trans = scene.getComponent<const Transform>(entity))
+                auto mvp = viewProj;
+                if (auto trans = scene.getComponentInParent<const Transform>(entity))
                 {
-                    frust *= trans->getWorldInverse();
+                    mvp *= trans->getWorldMatrix();
                 }
-                if (!frust.canSee(bounds.value()))
+                if (_depth.isOccluded(mvp, bounds.value()))
                 {
                     _culled.insert(entity);
                 }
@@ -284,11 +831,16 @@ namespace darmok
         }
     }
 
-    bool FrustumCuller::shouldEntityBeCulled(Entity entity) noexcept
+    bool SoftwareOcclusionCuller::shouldEntityBeCulled(Entity entity) noexcept
     {
         return _culled.contains(entity);
     }
 
+    const OcclusionDepthBuffer& SoftwareOcclusionCuller::getDepthBuffer() const noexcept
+    {
+        return _depth;
+    }
+
     CullingDebugRenderer::CullingDebugRenderer(const OptionalRef<const Camera>& mainCam) noexcept
         : _mainCam{ mainCam }
     {
@@ -10,6 +10,18 @@
 #include <cstdio>
 #include <cstdlib>
 
+#if BX_PLATFORM_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace darmok
 {
     DataView::DataView(const void* ptr, size_t size) noexcept
@@ -177,6 +189,26 @@ namespace darmok
         return bgfx::makeRef(ptr, uint32_t(size));
     }
 
+    const bgfx::Memory* DataView::makeRef(std::shared_ptr<const void> owner, size_t offset, size_t size) const noexcept
+    {
+        if (!owner)
+        {
+            return makeRef(offset, size);
+        }
+        void* ptr;
+        offset = fixOffset(offset, ptr);
+        size = fixSize(size, offset);
+        if (size == 0)
+        {
+            return nullptr;
+        }
+        auto userData = new std::shared_ptr<const void>{ std::move(owner) };
+        return bgfx::makeRef(ptr, uint32_t(size), [](void* ptr, void* userData)
+        {
+            delete static_cast<std::shared_ptr<const void>*>(userData);
+        }, userData);
+    }
+
     const bgfx::Memory* DataView::copyMem(size_t offset, size_t size) const noexcept
     {
         void* ptr;
@@ -503,6 +535,166 @@ namespace darmok
         return operator=(std::string_view(str));
     }
 
+    MappedFile::MappedFile() noexcept
+        : _ptr{ nullptr }
+        , _size{ 0 }
+#if BX_PLATFORM_WINDOWS
+        , _file{ nullptr }
+        , _mapping{ nullptr }
+#endif
+    {
+    }
+
+    MappedFile::~MappedFile() noexcept
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : _ptr{ other._ptr }
+        , _size{ other._size }
+#if BX_PLATFORM_WINDOWS
+        , _file{ other._file }
+        , _mapping{ other._mapping }
+#endif
+    {
+        other._ptr = nullptr;
+        other._size = 0;
+#if BX_PLATFORM_WINDOWS
+        other._file = nullptr;
+        other._mapping = nullptr;
+#endif
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        close();
+        _ptr = other._ptr;
+        _size = other._size;
+        other._ptr = nullptr;
+        other._size = 0;
+#if BX_PLATFORM_WINDOWS
+        _file = other._file;
+        _mapping = other._mapping;
+        other._file = nullptr;
+        other._mapping = nullptr;
+#endif
+        return *this;
+    }
+
+    const void* MappedFile::ptr() const noexcept
+    {
+        return _ptr;
+    }
+
+    size_t MappedFile::size() const noexcept
+    {
+        return _size;
+    }
+
+    bool MappedFile::empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    DataView MappedFile::view(size_t offset, size_t size) const noexcept
+    {
+        return DataView{ _ptr, _size }.view(offset, size);
+    }
+
+    void MappedFile::close() noexcept
+    {
+#if BX_PLATFORM_WINDOWS
+        if (_ptr != nullptr)
+        {
+            UnmapViewOfFile(_ptr);
+        }
+        if (_mapping != nullptr)
+        {
+            CloseHandle(_mapping);
+            _mapping = nullptr;
+        }
+        if (_file != nullptr)
+        {
+            CloseHandle(_file);
+            _file = nullptr;
+        }
+#else
+        if (_ptr != nullptr)
+        {
+            munmap(_ptr, _size);
+        }
+#endif
+        _ptr = nullptr;
+        _size = 0;
+    }
+
+    expected<MappedFile, std::string> MappedFile::open(const std::filesystem::path& path) noexcept
+    {
+        MappedFile file;
+#if BX_PLATFORM_WINDOWS
+        auto fileHandle = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+        {
+            return unexpected{ "failed to open file " + path.string() };
+        }
+        file._file = fileHandle;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size))
+        {
+            return unexpected{ "failed to get the size of file " + path.string() };
+        }
+        file._size = static_cast<size_t>(size.QuadPart);
+        if (file._size == 0)
+        {
+            return file;
+        }
+        file._mapping = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (file._mapping == nullptr)
+        {
+            return unexpected{ "failed to map file " + path.string() };
+        }
+        file._ptr = MapViewOfFile(file._mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return unexpected{ std::string{ strerror(errno) } + ": " + path.string() };
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return unexpected{ std::string{ strerror(errno) } + ": " + path.string() };
+        }
+        file._size = static_cast<size_t>(st.st_size);
+        if (file._size == 0)
+        {
+            ::close(fd);
+            return file;
+        }
+        auto ptr = mmap(nullptr, file._size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+        if (ptr != MAP_FAILED)
+        {
+            file._ptr = ptr;
+            posix_madvise(ptr, file._size, POSIX_MADV_RANDOM);
+        }
+#endif
+        if (file._ptr == nullptr)
+        {
+            file._size = 0;
+            return unexpected{ "failed to map file " + path.string() };
+        }
+        return file;
+    }
+
     FileDataLoader::FileDataLoader(const OptionalRef<bx::AllocatorI>& alloc)
         : _alloc{ alloc }
         , _absolutePathsAllowed{ false }
@@ -543,7 +735,12 @@ namespace darmok
         _absolutePathsAllowed = allowed;
     }
 
-    expected<Data, std::string> FileDataLoader::operator()(const std::filesystem::path& path) noexcept
+    expected<MappedFile, std::string> IDataLoader::map(const std::filesystem::path& path) noexcept
+    {
+        return unexpected{ "data loader does not support mapping " + path.string() };
+    }
+
+    expected<std::filesystem::path, std::string> FileDataLoader::resolvePath(const std::filesystem::path& path) const noexcept
     {
         if (path.is_absolute())
         {
@@ -551,7 +748,7 @@ namespace darmok
             {
                 return unexpected{ "absolute paths not allowed"};
             }
-            return Data::fromFile(path, _alloc);
+            return path;
         }
         auto fpath = (_basePath / path).relative_path();
         for (auto& rootPath : _rootPaths)
@@ -559,12 +756,32 @@ namespace darmok
             auto combPath = rootPath / fpath;
             if (std::filesystem::exists(combPath))
             {
-                return Data::fromFile(combPath, _alloc);
+                return combPath;
             }
         }
         auto err = std::string{ "path " } + path.string() + " does not exist";
         return unexpected{ std::move(err) };
     }
+
+    expected<Data, std::string> FileDataLoader::operator()(const std::filesystem::path& path) noexcept
+    {
+        auto pathResult = resolvePath(path);
+        if (!pathResult)
+        {
+            return unexpected{ std::move(pathResult).error() };
+        }
+        return Data::fromFile(pathResult.value(), _alloc);
+    }
+
+    expected<MappedFile, std::string> FileDataLoader::map(const std::filesystem::path& path) noexcept
+    {
+        auto pathResult = resolvePath(path);
+        if (!pathResult)
+        {
+            return unexpected{ std::move(pathResult).error() };
+        }
+        return MappedFile::open(pathResult.value());
+    }
 }
 
 std::ostream& operator<<(std::ostream& out, const darmok::DataView& data)
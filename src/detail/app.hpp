@@ -20,6 +20,8 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <filesystem>
 
 namespace darmok
 {
@@ -86,10 +88,22 @@ namespace darmok
 		void captureEnd() noexcept override;
 
 		void captureFrame(const void* data, uint32_t size) noexcept override;
+
+		// the cache entries are stored as files in the directory, an empty path disables it
+		void setCachePath(const std::filesystem::path& path, size_t maxSize) noexcept;
+
+		// clears the cache entries if they were written with a different device
+		void setCacheDevice(const std::string& device) noexcept;
 	private:
 		std::mutex _cacheMutex;
 		std::unordered_map<uint64_t, Data> _cache;
+		std::filesystem::path _cachePath;
+		size_t _cacheMaxSize;
+		size_t _cacheSize;
+
 		BgfxCallbacks() noexcept;
+		[[nodiscard]] std::filesystem::path getCacheFilePath(uint64_t resId) const noexcept;
+		void evictCache(size_t size) noexcept;
 	};
 
 	class AppImpl final : ITypeKeyboardListener<AppImpl>
@@ -124,6 +138,7 @@ namespace darmok
 		void setUpdateConfig(const AppUpdateConfig& config) noexcept;
 
 		expected<void, std::string> setRendererType(bgfx::RendererType::Enum renderer) noexcept;
+		void setShaderCachePath(const std::filesystem::path& path, size_t maxSize) noexcept;
 
 		void setPaused(bool paused) noexcept;
 		[[nodiscard]] bool isPaused() const noexcept;
@@ -217,6 +232,8 @@ namespace darmok
 		Color _clearColor;
 		uint64_t _lastUpdate;
 		AppUpdateConfig _updateConfig;
+		std::filesystem::path _shaderCachePath;
+		size_t _shaderCacheMaxSize;
 		Platform& _plat;
 		App& _app;
 		std::unique_ptr<IAppDelegate> _delegate;
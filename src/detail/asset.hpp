@@ -12,6 +12,8 @@
 #include <darmok/skeleton.hpp>
 #include <darmok/scene_serialize.hpp>
 #include <darmok/audio.hpp>
+#include <darmok/asset_pack.hpp>
+#include "detail/loader_async.hpp"
 
 #ifdef DARMOK_OZZ
 #include <darmok/skeleton_ozz.hpp>
@@ -46,6 +48,7 @@ namespace darmok
 		AssetContextImpl(IAssetContext& assets, Config&& config);
 		IDataLoader& getDataLoader() noexcept;
 		IImageLoader& getImageLoader() noexcept;
+		IAssetPackFileLoader& getAssetPackFileLoader() noexcept;
 		IProgramFromDefinitionLoader& getProgramLoader() noexcept;
 		ITextureFromDefinitionLoader& getTextureLoader() noexcept;
 		ITextureAtlasFromDefinitionLoader& getTextureAtlasLoader() noexcept;
@@ -61,12 +64,18 @@ namespace darmok
 		ISoundLoader& getSoundLoader() noexcept;
 		IMusicLoader& getMusicLoader() noexcept;
 
+		AssetFuture<Program> loadProgramAsync(const std::filesystem::path& path) noexcept;
+		AssetFuture<Texture> loadTextureAsync(const std::filesystem::path& path) noexcept;
+		AssetFuture<Mesh> loadMeshAsync(const std::filesystem::path& path) noexcept;
+		AssetFuture<protobuf::Scene> loadSceneDefinitionAsync(const std::filesystem::path& path) noexcept;
+
 		expected<void, std::string> init(App& app) noexcept;
 		expected<void, std::string> update() noexcept;
 		expected<void, std::string> shutdown() noexcept;
 	private:
 		Config _config;
 		ImageLoader _imageLoader;
+		AssetPackFileLoader _assetPackFileLoader;
 		DataProgramDefinitionLoader _dataProgDefLoader;
 		ProgramLoader _progLoader;
 		DataTextureDefinitionLoader _dataTexDefLoader;
@@ -113,5 +122,10 @@ namespace darmok
 		EmptyLoader<ISoundLoader> _emptySoundLoader;
 		EmptyLoader<IMusicLoader> _emptyMusicLoader;
 #endif
+
+		AsyncLoader<Program, Program::Definition> _asyncProgLoader;
+		AsyncLoader<Texture, Texture::Definition> _asyncTexLoader;
+		AsyncLoader<Mesh, Mesh::Definition> _asyncMeshLoader;
+		AsyncLoader<protobuf::Scene, protobuf::Scene> _asyncSceneDefLoader;
 	};
 }
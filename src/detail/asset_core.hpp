@@ -27,12 +27,14 @@ namespace darmok
         void setCachePath(const std::filesystem::path& cachePath) noexcept;
         void setOutputPath(const std::filesystem::path& outputPath) noexcept;
         void addTypeImporter(std::unique_ptr<IFileTypeImporter> importer) noexcept;
+        void setJobs(size_t jobs) noexcept;
         expected<Paths, std::string> getOutputPaths() const noexcept;
         bool operator()(std::ostream& log) const noexcept;
 	private:
         std::filesystem::path _inputPath;
         std::filesystem::path _outputPath;
         std::filesystem::path _cachePath;
+        size_t _jobs = 1;
 
         struct FileCacheData final
         {
@@ -130,7 +132,7 @@ namespace darmok
         using DirConfigs = std::vector<OptionalRef<const DirConfig>>;
         DirConfigs getDirConfigs(const std::filesystem::path& path) const noexcept;
         bool addFileCachePath(const std::filesystem::path& path, std::time_t cacheTime = 0) const noexcept;
-        FileImportResult importFile(const Operation& op, std::ostream& log) const noexcept;
+        FileImportResult importFile(const Operation& op, IFileTypeImporter& importer, bool inputCached, std::ostream& log) const noexcept;
         std::filesystem::path getHeaderPath(const std::filesystem::path& path, const std::string& baseName) const noexcept;
         std::filesystem::path getHeaderPath(const std::filesystem::path& path) const noexcept;
         bool loadInput(const std::filesystem::path& path, const Paths& paths) noexcept;
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <darmok/scene.hpp>
+#include <darmok/scene_filter.hpp>
+#include <darmok/shape.hpp>
+#include <darmok/render_scene.hpp>
+
+#ifdef DARMOK_JOLT
+#include <darmok/physics3d.hpp>
+#endif
+
+#include <optional>
+
+namespace darmok
+{
+    struct CullingUtils final
+    {
+        static std::optional<BoundingBox> getEntityBounds(Scene& scene, Entity entity) noexcept
+        {
+            if (auto bbox = scene.getComponent<BoundingBox>(entity))
+            {
+                return bbox.value();
+            }
+            #ifdef DARMOK_JOLT
+                if (auto body = scene.getComponent<physics3d::PhysicsBody>(entity))
+                {
+                    return body->getLocalBounds();
+                }
+            #endif
+            return std::nullopt;
+        }
+
+        static const EntityFilter& getEntityFilter() noexcept
+        {
+            static const EntityFilter filter = EntityFilter::create<Renderable>() & (EntityFilter::create<BoundingBox>()
+#ifdef DARMOK_JOLT
+                 | EntityFilter::create<physics3d::PhysicsBody>()
+#endif
+            );
+            return filter;
+        }
+    };
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <darmok/loader.hpp>
+#include <darmok/expected.hpp>
+#include <darmok/optional_ref.hpp>
+
+#include <taskflow/taskflow.hpp>
+
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <concepts>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <memory>
+
+namespace darmok
+{
+	// loads the definitions in the task executor (file reads, parsing, decoding)
+	// and finalizes the resources in the main thread, where bgfx handles can be created
+	// requests for a path that is already loading share the same future
+	template<typename ResourceType, typename DefinitionType>
+	class AsyncLoader final
+	{
+	public:
+		using Resource = ResourceType;
+		using Definition = DefinitionType;
+		using Argument = std::filesystem::path;
+		using Error = std::string;
+		using Result = expected<std::shared_ptr<Resource>, Error>;
+		using Future = std::shared_future<Result>;
+		using DefinitionLoader = ILoader<Definition>;
+		using DefinitionResult = DefinitionLoader::Result;
+
+		// the loaded definition is the resource
+		AsyncLoader(DefinitionLoader& defLoader) noexcept requires std::same_as<Resource, Definition>
+			: _defLoader{ defLoader }
+			, _finalize{ [](const Argument& arg, DefinitionResult&& defResult) -> Result {
+				return std::move(defResult);
+			} }
+			, _running{ 0 }
+		{
+		}
+
+		// the resource is created by a definition loader that shares the definition loader
+		template<typename Loader>
+		AsyncLoader(Loader& loader, DefinitionLoader& defLoader) noexcept
+			: _defLoader{ defLoader }
+			, _findCached{ [&loader](const Argument& arg) -> std::optional<Result> {
+				if (!loader.isCached(arg))
+				{
+					return std::nullopt;
+				}
+				return loader(arg);
+			} }
+			, _finalize{ [&loader](const Argument& arg, DefinitionResult&& defResult) -> Result {
+				if (loader.isCached(arg))
+				{
+					// loaded synchronously while this one was loading
+					return loader(arg);
+				}
+				if (!defResult)
+				{
+					return unexpected{ std::move(defResult).error() };
+				}
+				loader.cacheDefinition(arg, defResult.value());
+				return loader.loadResource(defResult.value());
+			} }
+			, _running{ 0 }
+		{
+		}
+
+		~AsyncLoader() noexcept
+		{
+			shutdown();
+		}
+
+		AsyncLoader(const AsyncLoader&) = delete;
+		AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+		void init(tf::Executor& executor) noexcept
+		{
+			_executor = executor;
+		}
+
+		void shutdown() noexcept
+		{
+			{
+				std::unique_lock lock{ _mutex };
+				_runningCondition.wait(lock, [this] { return _running == 0; });
+				_loaded.clear();
+			}
+			for (auto& [arg, pending] : _pending)
+			{
+				pending.promise.set_value(unexpected<Error>{ "async loader shut down" });
+			}
+			_pending.clear();
+			_executor.reset();
+		}
+
+		// should be called from the main thread
+		Future operator()(const Argument& arg) noexcept
+		{
+			auto itr = _pending.find(arg);
+			if (itr != _pending.end())
+			{
+				return itr->second.future;
+			}
+			if (_findCached)
+			{
+				if (auto cached = _findCached(arg))
+				{
+					std::promise<Result> promise;
+					promise.set_value(std::move(cached).value());
+					return promise.get_future().share();
+				}
+			}
+			if (!_executor)
+			{
+				// no executor, load synchronously
+				std::promise<Result> promise;
+				promise.set_value(_finalize(arg, _defLoader(arg)));
+				return promise.get_future().share();
+			}
+
+			auto& pending = _pending[arg];
+			pending.future = pending.promise.get_future().share();
+			{
+				std::lock_guard lock{ _mutex };
+				++_running;
+			}
+			_executor->silent_async([this, arg]()
+			{
+				auto defResult = _defLoader(arg);
+				std::lock_guard lock{ _mutex };
+				_loaded.emplace_back(arg, std::move(defResult));
+				--_running;
+				_runningCondition.notify_all();
+			});
+			return pending.future;
+		}
+
+		// finalizes the loaded definitions, should be called from the main thread
+		size_t update() noexcept
+		{
+			std::vector<Loaded> loaded;
+			{
+				std::lock_guard lock{ _mutex };
+				loaded.swap(_loaded);
+			}
+			for (auto& [arg, defResult] : loaded)
+			{
+				auto itr = _pending.find(arg);
+				if (itr == _pending.end())
+				{
+					continue;
+				}
+				itr->second.promise.set_value(_finalize(arg, std::move(defResult)));
+				_pending.erase(itr);
+			}
+			return loaded.size();
+		}
+
+		[[nodiscard]] bool isLoading(const Argument& arg) const noexcept
+		{
+			return _pending.contains(arg);
+		}
+
+		[[nodiscard]] size_t getLoadingAmount() const noexcept
+		{
+			return _pending.size();
+		}
+
+	private:
+		struct Pending final
+		{
+			std::promise<Result> promise;
+			Future future;
+		};
+
+		using Loaded = std::pair<Argument, DefinitionResult>;
+
+		DefinitionLoader& _defLoader;
+		std::function<std::optional<Result>(const Argument& arg)> _findCached;
+		std::function<Result(const Argument& arg, DefinitionResult&& defResult)> _finalize;
+		OptionalRef<tf::Executor> _executor;
+
+		// only accessed from the main thread
+		std::unordered_map<Argument, Pending> _pending;
+
+		std::mutex _mutex;
+		std::condition_variable _runningCondition;
+		std::vector<Loaded> _loaded;
+		size_t _running;
+	};
+}
@@ -123,11 +123,13 @@ namespace darmok
         using ImportConfig = FileImportConfig;
         using Source = protobuf::ProgramSource;
         ProgramFileImporterImpl(size_t defaultBufferSize = 4096) noexcept;
+        ProgramFileImporterImpl(const CompileConfig& defaultConfig) noexcept;
 
         void setShadercPath(const std::filesystem::path& path) noexcept;
         void addIncludePath(const std::filesystem::path& path) noexcept;
         void setIncludeDebugInfo(bool debug) noexcept;
-        void setOptimizationLevel(int level) noexcept;        
+        void setOptimizationLevel(int level) noexcept;
+        const CompileConfig& getDefaultConfig() const noexcept;
         expected<void, std::string> init(OptionalRef<std::ostream> log = nullptr) noexcept;
         expected<Effect, std::string> prepare(const Input& input) noexcept;
         expected<void, std::string> operator()(const Input& input, ImportConfig& config) noexcept;
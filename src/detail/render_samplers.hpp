@@ -22,16 +22,20 @@ namespace darmok
         static const uint8_t SHADOW_TRANS = 11;
         static const uint8_t SHADOW_LIGHT_DATA = 12;
 
+        // the cluster bounds are never bound when drawing
         static const uint8_t CLUSTERS_CLUSTERS = 13;
         static const uint8_t CLUSTERS_LIGHTINDICES = 14;
         static const uint8_t CLUSTERS_LIGHTGRID = 15;
         static const uint8_t CLUSTERS_ATOMICINDEX = 16;
 
-        static const uint8_t DEFERRED_DIFFUSE_A = 17;
-        static const uint8_t DEFERRED_NORMAL = 18;
-        static const uint8_t DEFERRED_F0_METALLIC = 19;
-        static const uint8_t DEFERRED_EMISSIVE_OCCLUSION = 20;
-        static const uint8_t DEFERRED_DEPTH = 21;
+        static const uint8_t SKINNING = 13;
+
+        // the deferred lighting pass does not sample material textures
+        static const uint8_t DEFERRED_ALBEDO = 1;
+        static const uint8_t DEFERRED_NORMAL = 2;
+        static const uint8_t DEFERRED_MATERIAL = 3;
+        static const uint8_t DEFERRED_EMISSIVE = 4;
+        static const uint8_t DEFERRED_DEPTH = 5;
 
 
     };
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <darmok/expected.hpp>
+#include <darmok/optional_ref.hpp>
+
+#include <functional>
+#include <string>
+
+#include <bgfx/bgfx.h>
+
+namespace tf
+{
+    class Executor;
+}
+
+namespace darmok
+{
+    struct RenderParallelUtils final
+    {
+        using ChunkCallback = std::function<expected<void, std::string>(bgfx::Encoder& encoder, size_t start, size_t end)>;
+
+        // splits the range in chunks that are recorded in parallel, each one with its own encoder
+        // the first chunk is recorded on the calling thread with the given encoder
+        // the callback needs to be thread safe, see ICameraComponent::beforeRenderEntity
+        static expected<void, std::string> record(OptionalRef<tf::Executor> executor, bgfx::Encoder& encoder, size_t size, const ChunkCallback& callback, size_t minChunkSize = defaultMinChunkSize) noexcept;
+
+        static const size_t defaultMinChunkSize;
+    };
+}
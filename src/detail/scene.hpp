@@ -20,6 +20,7 @@ namespace darmok
     class App;
     class Camera;
     class FrameBuffer;
+    class Transform;
 
     using SceneComponentRefs = std::vector<std::reference_wrapper<ISceneComponent>>;
     using ConstSceneComponentRefs = std::vector<std::reference_wrapper<const ISceneComponent>>;
@@ -92,6 +93,11 @@ namespace darmok
         std::optional<Viewport> _viewport;
         EntityFilter _updateFilter;
 
+        // dirty transforms grouped by hierarchy depth
+        std::vector<std::vector<std::reference_wrapper<Transform>>> _transformLevels;
+        std::vector<Entity> _changedTransforms;
+        static const size_t _minParallelTransforms;
+
         Components copySceneComponents() const noexcept;
         Components::iterator findSceneComponent(entt::id_type type) noexcept;
         Components::const_iterator findSceneComponent(entt::id_type type) const noexcept;
@@ -102,5 +108,6 @@ namespace darmok
         Viewport getRenderChainViewport() const noexcept override;
         void onRenderChainChanged() noexcept override;
         void destroyPendingEntities() noexcept;
+        void updateTransforms() noexcept;
     };
 }
@@ -149,7 +149,7 @@ namespace darmok
         using OutputFormat = protobuf::Format;
         using Definition = protobuf::Scene;
 
-        AssimpSceneFileImporterImpl(bx::AllocatorI& alloc);
+        AssimpSceneFileImporterImpl(bx::AllocatorI& alloc, const CompilerConfig& defaultCompilerConfig = {});
 
         const std::string& getName() const noexcept;
         void setLogOutput(OptionalRef<std::ostream> log) noexcept;
@@ -159,6 +159,9 @@ namespace darmok
         void setBgfxShadercPath(const std::filesystem::path& path) noexcept;
         void addBgfxShaderIncludePath(const std::filesystem::path& path) noexcept;
         void addSlangShaderIncludePath(const std::filesystem::path& path) noexcept;
+
+        bx::AllocatorI& getAllocator() const noexcept;
+        const CompilerConfig& getDefaultCompilerConfig() const noexcept;
     private:
         bx::AllocatorI& _alloc;
         bx::FileReader _fileReader;
@@ -169,6 +172,7 @@ namespace darmok
 
         std::optional<AssimpConfig> _currentConfig;
         OutputFormat _outputFormat = OutputFormat::Binary;
+        bool _packOutput = false;
         std::shared_ptr<aiScene> _currentScene;
         CompilerConfig _defaultCompilerConfig;
         std::optional<CompilerConfig> _compilerConfig;
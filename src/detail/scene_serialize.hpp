@@ -38,6 +38,7 @@ namespace darmok
         // SceneLoader
         void reload() noexcept;
         EntityResult load(const Scene::Definition& sceneDef, Scene& scene) noexcept;
+        EntityResult load(const AssetPackFile& pack, Scene& scene) noexcept;
         void operator()(std::underlying_type_t<Entity>& count) noexcept;
         void operator()(Entity& entity) noexcept;
 
@@ -64,6 +65,8 @@ namespace darmok
         OptionalRef<Scene> _scene;     
         OptionalRef<const Definition> _sceneDefRef;
         Definition _sceneDef;
+        OptionalRef<const AssetPackFile> _assetPackFile;
+        Definition _packSceneDef;
         Entity _parentEntity;
         std::vector<ComponentListener> _compListeners;
         AssetPackConfig _assetConfig;
@@ -76,5 +79,6 @@ namespace darmok
         std::vector<LoadFunction> _loadFuncs;
 
         void createAssetPack() const noexcept;
+        EntityResult load(const Scene::Definition& sceneDef, OptionalRef<const AssetPackFile> pack, Scene& scene) noexcept;
     };
 }
\ No newline at end of file
@@ -2,10 +2,12 @@
 
 #include <memory>
 #include <vector>
+#include <optional>
 #include <darmok/skeleton.hpp>
 #include <darmok/data.hpp>
 #include <darmok/collection.hpp>
 #include <ozz/base/io/stream.h>
+#include <ozz/base/span.h>
 #include <ozz/base/maths/soa_transform.h>
 #include <ozz/base/maths/vec_float.h>
 #include <ozz/base/containers/vector.h>
@@ -69,7 +71,7 @@ namespace darmok
 
 		static std::optional<OzzSkeletalAnimatorAnimationState> create(const ozz::animation::Skeleton& skel, const Definition& def, ISkeletalAnimationProvider& anims);
 
-		expected<void, std::string> update(float deltaTime) noexcept;
+		expected<void, std::string> update(float deltaTime, bool sample = true) noexcept;
 		bool hasLooped() const noexcept;
 		bool hasFinished() const noexcept;
 		float getDuration() const noexcept;
@@ -97,7 +99,7 @@ namespace darmok
 
 		static std::optional<OzzSkeletalAnimatorState> create(const ozz::animation::Skeleton& skel, const Definition& def, ISkeletalAnimationProvider& animations) noexcept;
 
-		expected<void, std::string> update(float deltaTime, const glm::vec2& blendPosition) noexcept;
+		expected<void, std::string> update(float deltaTime, const glm::vec2& blendPosition, bool sample = true) noexcept;
 		std::string_view getName() const noexcept override;
 		const ozz::vector<ozz::math::SoaTransform>& getLocals() const noexcept;
 		float getNormalizedTime() const noexcept override;
@@ -131,7 +133,7 @@ namespace darmok
 		using State = OzzSkeletalAnimatorState;
 
 		OzzSkeletalAnimatorTransition(const Definition& def, State currentState, State previousState) noexcept;
-		expected<void, std::string> update(float deltaTime, const glm::vec2& blendPosition) noexcept;
+		expected<void, std::string> update(float deltaTime, const glm::vec2& blendPosition, bool sample = true) noexcept;
 		float getDuration() const noexcept override;
 		float getNormalizedTime() const noexcept override;
 		void setNormalizedTime(float normalizedTime) noexcept;
@@ -192,9 +194,15 @@ namespace darmok
 		PlaybackState getPlaybackState() noexcept;
 
 		expected<void, std::string> update(float deltaTime) noexcept;
+		expected<void, std::string> updatePose(float deltaTime, bool sample = true, std::optional<float> interpolation = std::nullopt) noexcept;
+		void updateEvents() noexcept;
 
 		glm::mat4 getJointModelMatrix(const std::string& joint) const noexcept;
+		glm::mat4 getJointModelMatrix(size_t index) const noexcept;
+		std::optional<size_t> getJointIndex(std::string_view name) const noexcept;
 		std::unordered_map<std::string, glm::mat4> getJointModelMatrixes(const glm::vec3& dir = {1, 0, 0}) const noexcept;
+		std::shared_ptr<Skeleton> getSkeleton() const noexcept;
+		uint32_t getVersion() const noexcept;
 
 		// ISkeletalAnimationProvider
 		std::shared_ptr<SkeletalAnimation> getAnimation(std::string_view name) noexcept override;
@@ -214,14 +222,22 @@ namespace darmok
 		std::optional<Transition> _transition;
 		std::optional<State> _state;
 		ozz::vector<ozz::math::Float4x4> _models;
+		uint32_t _version;
+
+		// last two sampled poses, only kept while interpolating
+		ozz::vector<ozz::math::SoaTransform> _prevSample;
+		ozz::vector<ozz::math::SoaTransform> _lastSample;
+		ozz::vector<ozz::math::SoaTransform> _interpolatedLocals;
 
 		OwnRefCollection<ISkeletalAnimatorListener> _listeners;
 
 		ozz::animation::Skeleton& getOzz() noexcept;
 		const ozz::animation::Skeleton& getOzz() const noexcept;
-		void afterUpdate() noexcept;
 
 		OptionalRef<State> getCurrentOzzState() noexcept;
 		OptionalRef<Transition> getCurrentOzzTransition() noexcept;
+
+		expected<void, std::string> updateModels(ozz::span<const ozz::math::SoaTransform> locals) noexcept;
+		expected<void, std::string> updateInterpolation(float factor) noexcept;
 	};
 }
\ No newline at end of file
@@ -35,9 +35,12 @@ namespace darmok
         using ImportConfig = FileImportConfig;
         using Source = protobuf::SlangProgramSource;
 
+        SlangProgramFileImporterImpl(const CompileConfig& defaultConfig = {}) noexcept;
+
         void addIncludePath(const std::filesystem::path& path) noexcept;
         void setIncludeDebugInfo(bool debug) noexcept;
         void setOptimizationLevel(int level) noexcept;
+        const CompileConfig& getDefaultConfig() const noexcept;
 
         expected<void, std::string> init(OptionalRef<std::ostream> log = nullptr) noexcept;
         expected<Effect, std::string> prepare(const Input& input) noexcept;
@@ -586,4 +586,9 @@ namespace darmok
 		static const std::string name = "image";
 		return name;
 	}
+
+	std::unique_ptr<IFileTypeImporter> ImageFileImporter::clone() const noexcept
+	{
+		return std::make_unique<ImageFileImporter>();
+	}
 }
\ No newline at end of file
@@ -10,10 +10,19 @@
 #include <darmok/glm_serialize.hpp>
 #include <glm/gtx/matrix_operation.hpp>
 #include <glm/gtx/component_wise.hpp>
+#include <glm/gtc/constants.hpp>
 #include "detail/render_samplers.hpp"
 
+#include <limits>
+
 namespace darmok
 {
+    namespace
+    {
+        // used when the definition leaves the grid sizes empty
+        const glm::uvec3 defaultClusterSize{ 16, 9, 24 };
+    }
+
     PointLight::PointLight(float intensity, const Color3& color, float range) noexcept
         : _intensity{ intensity }
         , _color{ color }
@@ -280,13 +289,19 @@ namespace darmok
     LightingRenderComponent::Definition LightingRenderComponent::createDefinition() noexcept
     {
         Definition def;
+        def.mutable_cluster_tiles()->set_x(defaultClusterSize.x);
+        def.mutable_cluster_tiles()->set_y(defaultClusterSize.y);
+        def.set_cluster_slices(defaultClusterSize.z);
         return def;
     }
 
-    LightingRenderComponent::LightingRenderComponent() noexcept
-        : _lightCount{ 0 }
+    LightingRenderComponent::LightingRenderComponent(const Definition& def) noexcept
+        : _def{ def }
+        , _lightCount{ 0 }
         , _lightData{ 0 }
         , _camPos{ 0 }
+        , _clusterSize{ 0 }
+        , _clusterDepth{ 0 }
     {
 
         _pointLightsLayout.begin()
@@ -309,6 +324,17 @@ namespace darmok
             .add(bgfx::Attrib::Weight, 3, bgfx::AttribType::Float)
             .end();
 
+        _clustersLayout.begin()
+            .add(bgfx::Attrib::Indices, 4, bgfx::AttribType::Uint8)
+            .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8)
+            .add(bgfx::Attrib::Color1, 4, bgfx::AttribType::Uint8)
+            .add(bgfx::Attrib::Color2, 4, bgfx::AttribType::Uint8)
+            .end();
+
+        _clusterLightIndicesLayout.begin()
+            .add(bgfx::Attrib::Indices, 4, bgfx::AttribType::Uint8)
+            .end();
+
         createHandles();
     }
 
@@ -326,6 +352,7 @@ namespace darmok
 
     expected<void, std::string> LightingRenderComponent::load(const Definition& def) noexcept
     {
+        _def = def;
         return {};
     }
 
@@ -338,6 +365,10 @@ namespace darmok
         _lightDataUniform = { "u_ambientLightIrradiance", bgfx::UniformType::Vec4 };
         _camPosUniform = { "u_camPos", bgfx::UniformType::Vec4 };
         _normalMatrixUniform = { "u_normalMatrix", bgfx::UniformType::Mat3 };
+        _clusterBuffer = { 1, _clustersLayout, BGFX_BUFFER_COMPUTE_READ | BGFX_BUFFER_ALLOW_RESIZE };
+        _clusterLightIndexBuffer = { 1, _clusterLightIndicesLayout, BGFX_BUFFER_COMPUTE_READ | BGFX_BUFFER_ALLOW_RESIZE };
+        _clusterSizeUniform = { "u_lightClusterSize", bgfx::UniformType::Vec4 };
+        _clusterDepthUniform = { "u_lightClusterDepth", bgfx::UniformType::Vec4 };
     }
 
     void LightingRenderComponent::destroyHandles() noexcept
@@ -349,6 +380,10 @@ namespace darmok
         _pointLightBuffer.reset();
         _dirLightBuffer.reset();
         _spotLightBuffer.reset();
+        _clusterBuffer.reset();
+        _clusterLightIndexBuffer.reset();
+        _clusterSizeUniform.reset();
+        _clusterDepthUniform.reset();
     }
 
     expected<void, std::string> LightingRenderComponent::shutdown() noexcept
@@ -402,6 +437,7 @@ namespace darmok
     size_t LightingRenderComponent::updatePointLights() noexcept
     {
         std::vector<PointLightBufferElement> elms;
+        _pointLightBounds.clear();
         for (auto entity : _cam->getEntities<PointLight>())
         {
             auto& elm = elms.emplace_back();
@@ -416,6 +452,7 @@ namespace darmok
             elm.entity = static_cast<uint32_t>(entity);
             elm.intensity = Colors::normalize(light.getColor()) * light.getIntensity();
             elm.range = light.getRange() * scale;
+            _pointLightBounds.emplace_back(elm.pos, elm.range);
         }
 
         if (!elms.empty())
@@ -441,6 +478,7 @@ namespace darmok
     size_t LightingRenderComponent::updateSpotLights() noexcept
     {
         std::vector<SpotLightBufferElement> elms;
+        _spotLightBounds.clear();
         for (auto entity : _cam->getEntities<SpotLight>())
         {
             auto& elm = elms.emplace_back();
@@ -458,6 +496,7 @@ namespace darmok
             elm.range = light.getRange() * scale;
             elm.coneAngle = light.getConeAngle();
             elm.innerConeAngle = light.getInnerConeAngle();
+            _spotLightBounds.push_back(calcSpotLightBounds(elm.pos, elm.direction, elm.range, elm.coneAngle));
         }
 
         if(!elms.empty())
@@ -469,6 +508,211 @@ namespace darmok
         return elms.size();
     }
 
+    const std::vector<Sphere>& LightingRenderComponent::getPointLightBounds() const noexcept
+    {
+        return _pointLightBounds;
+    }
+
+    const std::vector<Sphere>& LightingRenderComponent::getSpotLightBounds() const noexcept
+    {
+        return _spotLightBounds;
+    }
+
+    Sphere LightingRenderComponent::calcSpotLightBounds(const glm::vec3& pos, const glm::vec3& dir, float range, float coneAngle) noexcept
+    {
+        // smallest sphere containing the cone
+        if (coneAngle > glm::quarter_pi<float>())
+        {
+            return { pos + (dir * range * glm::cos(coneAngle)), range * glm::sin(coneAngle) };
+        }
+        auto radius = range / (2.F * glm::cos(coneAngle));
+        return { pos + (dir * radius), radius };
+    }
+
+    std::optional<LightingRenderComponent::ClusterGrid> LightingRenderComponent::getClusterGrid() const noexcept
+    {
+        auto tiles = convert<glm::uvec2>(_def.cluster_tiles());
+        ClusterGrid grid;
+        grid.size = glm::uvec3{ tiles, _def.cluster_slices() };
+        for (glm::length_t i = 0; i < 3; ++i)
+        {
+            if (grid.size[i] == 0)
+            {
+                grid.size[i] = defaultClusterSize[i];
+            }
+        }
+        grid.view = _cam->getViewMatrix();
+        grid.proj = _cam->getProjectionMatrix();
+        auto& proj = _cam->getProjection();
+        if (auto persp = std::get_if<CameraPerspectiveData>(&proj))
+        {
+            grid.near = persp->near;
+            grid.far = persp->far;
+            grid.logDepth = persp->near > 0.F;
+        }
+        else
+        {
+            auto& ortho = std::get<CameraOrthoData>(proj);
+            grid.near = ortho.near;
+            grid.far = ortho.far;
+            grid.logDepth = false;
+        }
+        if (grid.far <= grid.near)
+        {
+            return std::nullopt;
+        }
+        // slice = floor(f(depth) * scale + bias), f being log for perspective cameras
+        // so that the clusters keep a similar shape along the view depth
+        auto slices = static_cast<float>(grid.size.z);
+        if (grid.logDepth)
+        {
+            grid.depthScale = slices / glm::log(grid.far / grid.near);
+            grid.depthBias = -glm::log(grid.near) * grid.depthScale;
+        }
+        else
+        {
+            grid.depthScale = slices / (grid.far - grid.near);
+            grid.depthBias = -grid.near * grid.depthScale;
+        }
+        return grid;
+    }
+
+    uint32_t LightingRenderComponent::getClusterSlice(float depth, const ClusterGrid& grid) noexcept
+    {
+        if (grid.logDepth)
+        {
+            depth = glm::log(depth);
+        }
+        auto slice = glm::floor((depth * grid.depthScale) + grid.depthBias);
+        return static_cast<uint32_t>(glm::clamp(slice, 0.F, static_cast<float>(grid.size.z - 1)));
+    }
+
+    std::optional<LightingRenderComponent::ClusterRange> LightingRenderComponent::getClusterRange(const Sphere& bounds, const ClusterGrid& grid) noexcept
+    {
+        auto center = glm::vec3{ grid.view * glm::vec4{ bounds.origin, 1.F } };
+        auto radius = bounds.radius;
+        auto minZ = glm::max(center.z - radius, grid.near);
+        auto maxZ = glm::min(center.z + radius, grid.far);
+        if (minZ > maxZ)
+        {
+            return std::nullopt;
+        }
+
+        // project the corners of the view space box clipped to the near plane
+        glm::vec2 ndcMin{ std::numeric_limits<float>::max() };
+        glm::vec2 ndcMax{ std::numeric_limits<float>::lowest() };
+        for (auto i = 0; i < 8; ++i)
+        {
+            glm::vec4 corner{
+                (i & 1) ? center.x + radius : center.x - radius,
+                (i & 2) ? center.y + radius : center.y - radius,
+                (i & 4) ? maxZ : minZ,
+                1.F
+            };
+            auto clip = grid.proj * corner;
+            auto ndc = glm::vec2{ clip } / clip.w;
+            ndcMin = glm::min(ndcMin, ndc);
+            ndcMax = glm::max(ndcMax, ndc);
+        }
+        if (ndcMax.x < -1.F || ndcMax.y < -1.F || ndcMin.x > 1.F || ndcMin.y > 1.F)
+        {
+            return std::nullopt;
+        }
+
+        glm::vec2 tiles{ grid.size };
+        auto maxTile = tiles - 1.F;
+        auto tileMin = glm::clamp(glm::floor(((ndcMin * 0.5F) + 0.5F) * tiles), glm::vec2{ 0.F }, maxTile);
+        auto tileMax = glm::clamp(glm::floor(((ndcMax * 0.5F) + 0.5F) * tiles), glm::vec2{ 0.F }, maxTile);
+
+        ClusterRange range;
+        range.min = glm::uvec3{ glm::uvec2{ tileMin }, getClusterSlice(minZ, grid) };
+        range.max = glm::uvec3{ glm::uvec2{ tileMax }, getClusterSlice(maxZ, grid) };
+        return range;
+    }
+
+    void LightingRenderComponent::updateClusters() noexcept
+    {
+        _clusters.clear();
+        _clusterLightIndices.clear();
+        _clusterSize = glm::vec4{ 0.F };
+        _clusterDepth = glm::vec4{ 0.F };
+
+        auto gridResult = getClusterGrid();
+        if (!gridResult)
+        {
+            return;
+        }
+        auto& grid = gridResult.value();
+        _clusterSize = glm::vec4{ grid.size, grid.size.x * grid.size.y * grid.size.z };
+        _clusterDepth = glm::vec4{ grid.depthScale, grid.depthBias, grid.logDepth ? 1.F : 0.F, 0.F };
+        _clusters.resize(grid.size.x * grid.size.y * grid.size.z, glm::uvec4{ 0 });
+
+        auto forEachCluster = [&grid](const ClusterRange& range, auto callback)
+        {
+            for (auto z = range.min.z; z <= range.max.z; ++z)
+            {
+                for (auto y = range.min.y; y <= range.max.y; ++y)
+                {
+                    for (auto x = range.min.x; x <= range.max.x; ++x)
+                    {
+                        callback(x + (grid.size.x * (y + (grid.size.y * z))));
+                    }
+                }
+            }
+        };
+
+        // count the lights per cluster, point lights first
+        _clusterRanges.clear();
+        _clusterRanges.reserve(_pointLightBounds.size() + _spotLightBounds.size());
+        auto addRanges = [&](const std::vector<Sphere>& bounds, glm::length_t countIndex)
+        {
+            for (auto& sphere : bounds)
+            {
+                auto& range = _clusterRanges.emplace_back(ClusterRange{ glm::uvec3{ 1 }, glm::uvec3{ 0 } });
+                if (auto result = getClusterRange(sphere, grid))
+                {
+                    range = result.value();
+                    forEachCluster(range, [this, countIndex](size_t i) { ++_clusters[i][countIndex]; });
+                }
+            }
+        };
+        addRanges(_pointLightBounds, 1);
+        addRanges(_spotLightBounds, 2);
+
+        uint32_t offset = 0;
+        for (auto& cluster : _clusters)
+        {
+            cluster.x = offset;
+            offset += cluster.y + cluster.z;
+        }
+        _clusterLightIndices.resize(offset);
+
+        // w is used as the write cursor
+        auto pointAmount = _pointLightBounds.size();
+        for (size_t i = 0; i < _clusterRanges.size(); ++i)
+        {
+            auto lightIndex = static_cast<uint32_t>(i < pointAmount ? i : i - pointAmount);
+            forEachCluster(_clusterRanges[i], [this, lightIndex](size_t j)
+            {
+                auto& cluster = _clusters[j];
+                _clusterLightIndices[cluster.x + cluster.w] = lightIndex;
+                ++cluster.w;
+            });
+        }
+        for (auto& cluster : _clusters)
+        {
+            cluster.w = 0;
+        }
+
+        auto data = bgfx::copy(&_clusters.front(), sizeof(glm::uvec4) * _clusters.size());
+        bgfx::update(_clusterBuffer, 0, data);
+        if (!_clusterLightIndices.empty())
+        {
+            data = bgfx::copy(&_clusterLightIndices.front(), sizeof(uint32_t) * _clusterLightIndices.size());
+            bgfx::update(_clusterLightIndexBuffer, 0, data);
+        }
+    }
+
     void LightingRenderComponent::updateAmbientLights() noexcept
     {
         auto entities = _cam->getEntities<AmbientLight>();
@@ -509,6 +753,7 @@ namespace darmok
         _lightCount.z = static_cast<float>(updateSpotLights());
         updateAmbientLights();
         updateCamera();
+        updateClusters();
         return {};
     }
 
@@ -520,9 +765,13 @@ namespace darmok
         encoder.setBuffer(RenderSamplers::LIGHTS_DIR, _dirLightBuffer, bgfx::Access::Read);
         encoder.setBuffer(RenderSamplers::LIGHTS_SPOT, _spotLightBuffer, bgfx::Access::Read);
         encoder.setUniform(_camPosUniform, glm::value_ptr(_camPos));
+        encoder.setUniform(_clusterSizeUniform, glm::value_ptr(_clusterSize));
+        encoder.setUniform(_clusterDepthUniform, glm::value_ptr(_clusterDepth));
+        encoder.setBuffer(RenderSamplers::CLUSTERS_LIGHTGRID, _clusterBuffer, bgfx::Access::Read);
+        encoder.setBuffer(RenderSamplers::CLUSTERS_LIGHTINDICES, _clusterLightIndexBuffer, bgfx::Access::Read);
 
         glm::mat3 normalMatrix{ 1.f };
-        if (auto trans = _scene->getComponent<Transform>(entity))
+        if (auto trans = _scene->getComponent<const Transform>(entity))
         {
             normalMatrix = glm::transpose(glm::adjugate(glm::mat3(trans->getWorldMatrix())));
         }
@@ -250,6 +250,16 @@ namespace darmok
 		app.setResetFlag(flag);
 	}
 
+	void LuaApp::setShaderCachePath1(App& app, const std::string& path) noexcept
+	{
+		app.setShaderCachePath(path);
+	}
+
+	void LuaApp::setShaderCachePath2(App& app, const std::string& path, size_t maxSize) noexcept
+	{
+		app.setShaderCachePath(path, maxSize);
+	}
+
 	void LuaApp::bind(sol::state_view& lua) noexcept
 	{
 		LuaAssetContext::bind(lua);
@@ -308,6 +318,7 @@ namespace darmok
 			"toggle_reset_flag", &App::toggleResetFlag,
 			"set_debug_flag", sol::overload(&App::setResetFlag, &LuaApp::setResetFlag),
 			"renderer_type", sol::property(&App::setRendererType),
+			"set_shader_cache_path", sol::overload(&LuaApp::setShaderCachePath1, &LuaApp::setShaderCachePath2),
 			"quit", &App::quit
 		);
 	}
@@ -373,6 +384,7 @@ namespace darmok
 		CliConfig cfg;
 		cli.set_version_flag("-v,--version", "VERSION " DARMOK_VERSION);
 		cli.add_option("-m,--main-lua", cfg.mainPath, "Path to the main lua file (dir will be taken as package path).");
+		cli.add_option("-s,--shader-cache", cfg.shaderCachePath, "Path to the directory where the compiled shaders are cached between runs.");
 		auto importGroup = cli.add_option_group("Asset Importer");
 		BaseCommandLineFileImporter::setup(*importGroup, cfg.assetImport);
 
@@ -380,6 +392,10 @@ namespace darmok
 		{
 			cli.parse(args.size(), args.data());
 			cfg.assetImport.fix(cli);
+			if (!cfg.shaderCachePath.empty())
+			{
+				_app.setShaderCachePath(cfg.shaderCachePath);
+			}
 			if (!importAssets(cfg.assetImport))
 			{
 				return -3;
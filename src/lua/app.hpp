@@ -66,6 +66,8 @@ namespace darmok
 
 		static void setDebugFlag(App& app, uint32_t flag) noexcept;
 		static void setResetFlag(App& app, uint32_t flag) noexcept;
+		static void setShaderCachePath1(App& app, const std::string& path) noexcept;
+		static void setShaderCachePath2(App& app, const std::string& path, size_t maxSize) noexcept;
 	};
 
 	class LuaError final : std::exception
@@ -93,6 +95,7 @@ namespace darmok
 		struct CliConfig final
 		{
 			std::filesystem::path mainPath;
+			std::filesystem::path shaderCachePath;
 			CommandLineFileImporterConfig assetImport;
 		};
 
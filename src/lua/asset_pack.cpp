@@ -11,7 +11,8 @@ namespace darmok
 			"AssetPack", sol::no_constructor,
 			sol::base_classes, sol::bases<IAssetContext>(),
 			"reload_asset", &LuaAssetPack::reloadAsset,
-			"remove_asset", &LuaAssetPack::removeAsset
+			"remove_asset", &LuaAssetPack::removeAsset,
+			"prune_cache", &AssetPack::pruneCache
 		);
 	}
 
@@ -2,6 +2,7 @@
 #include "lua/scene.hpp"
 #include "lua/scene_filter.hpp"
 #include "lua/render_forward.hpp"
+#include "lua/render_deferred.hpp"
 #include "lua/light.hpp"
 #include "lua/culling.hpp"
 #include <darmok/program.hpp>
@@ -146,9 +147,12 @@ namespace darmok
 	{
 		LuaViewport::bind(lua);
 		LuaForwardRenderer::bind(lua);
+		LuaDeferredRenderer::bind(lua);
 		LuaLightingRenderComponent::bind(lua);
 		LuaOcclusionCuller::bind(lua);
 		LuaFrustumCuller::bind(lua);
+		LuaSoftwareOcclusionCuller::bind(lua);
+		LuaOccluder::bind(lua);
 		LuaCullingDebugRenderer::bind(lua);
 
 #ifdef PHYSICS_DEBUG_RENDER
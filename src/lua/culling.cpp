@@ -1,7 +1,11 @@
 #include "lua/culling.hpp"
 #include "lua/utils.hpp"
+#include "lua/scene.hpp"
+#include "lua/protobuf.hpp"
+#include "lua/scene_serialize.hpp"
 #include <darmok/culling.hpp>
 #include <darmok/camera.hpp>
+#include <darmok/mesh_core.hpp>
 
 namespace darmok
 {
@@ -43,6 +47,65 @@ namespace darmok
         return cam.getComponent<FrustumCuller>();
     }
 
+    void LuaSoftwareOcclusionCuller::bind(sol::state_view& lua) noexcept
+    {
+        lua.new_usertype<SoftwareOcclusionCuller>("SoftwareOcclusionCuller", sol::no_constructor,
+            "type_id", sol::property(&entt::type_hash<SoftwareOcclusionCuller>::value),
+            "add_camera_component", &LuaSoftwareOcclusionCuller::addCameraComponent,
+            "get_camera_component", &LuaSoftwareOcclusionCuller::getCameraComponent
+        );
+    }
+
+    std::reference_wrapper<SoftwareOcclusionCuller> LuaSoftwareOcclusionCuller::addCameraComponent(Camera& cam)
+    {
+        return LuaUtils::unwrapExpected(cam.addComponent<SoftwareOcclusionCuller>());
+    }
+
+    OptionalRef<SoftwareOcclusionCuller>::std_t LuaSoftwareOcclusionCuller::getCameraComponent(Camera& cam) noexcept
+    {
+        return cam.getComponent<SoftwareOcclusionCuller>();
+    }
+
+    void LuaOccluder::bind(sol::state_view& lua) noexcept
+    {
+        auto def = lua.new_usertype<Occluder::Definition>("OccluderDefinition",
+            sol::factories([]() {
+                return Occluder::createDefinition();
+            }),
+            "get_entity_component", [](LuaEntityDefinition& entity)
+            {
+                return entity.getComponent<Occluder::Definition>();
+            }
+        );
+        LuaProtobufBinding{ std::move(def) };
+
+        lua.new_usertype<Occluder>("Occluder", sol::no_constructor,
+            "type_id", sol::property(&entt::type_hash<Occluder>::value),
+            "add_entity_component", sol::overload(
+                &LuaOccluder::addEntityComponent1,
+                &LuaOccluder::addEntityComponent2
+            ),
+            "get_entity_component", &LuaOccluder::getEntityComponent,
+            "vertices", &Occluder::vertices,
+            "indices", &Occluder::indices
+        );
+    }
+
+    Occluder& LuaOccluder::addEntityComponent1(LuaEntity& entity) noexcept
+    {
+        return entity.addComponent<Occluder>();
+    }
+
+    Occluder& LuaOccluder::addEntityComponent2(LuaEntity& entity, const MeshData& data) noexcept
+    {
+        return entity.addComponent<Occluder>(data);
+    }
+
+    OptionalRef<Occluder>::std_t LuaOccluder::getEntityComponent(LuaEntity& entity) noexcept
+    {
+        return entity.getComponent<Occluder>();
+    }
+
     void LuaCullingDebugRenderer::bind(sol::state_view& lua) noexcept
     {
         lua.new_usertype<CullingDebugRenderer>("CullingDebugRenderer", sol::no_constructor,
@@ -28,6 +28,31 @@ namespace darmok
         static OptionalRef<FrustumCuller>::std_t getCameraComponent(Camera& cam) noexcept;
     };
 
+    class SoftwareOcclusionCuller;
+
+    class LuaSoftwareOcclusionCuller final
+    {
+    public:
+        static void bind(sol::state_view& lua) noexcept;
+    private:
+        static std::reference_wrapper<SoftwareOcclusionCuller> addCameraComponent(Camera& cam);
+        static OptionalRef<SoftwareOcclusionCuller>::std_t getCameraComponent(Camera& cam) noexcept;
+    };
+
+    class LuaEntity;
+    struct MeshData;
+    struct Occluder;
+
+    class LuaOccluder final
+    {
+    public:
+        static void bind(sol::state_view& lua) noexcept;
+    private:
+        static Occluder& addEntityComponent1(LuaEntity& entity) noexcept;
+        static Occluder& addEntityComponent2(LuaEntity& entity, const MeshData& data) noexcept;
+        static OptionalRef<Occluder>::std_t getEntityComponent(LuaEntity& entity) noexcept;
+    };
+
     class CullingDebugRenderer;
 
     class LuaCullingDebugRenderer final
@@ -0,0 +1,26 @@
+#include "lua/render_deferred.hpp"
+#include "lua/utils.hpp"
+#include <darmok/camera.hpp>
+#include <darmok/render_deferred.hpp>
+
+namespace darmok
+{
+    std::reference_wrapper<DeferredRenderer> LuaDeferredRenderer::addCameraComponent(Camera& cam)
+    {
+        return LuaUtils::unwrapExpected(cam.addComponent<DeferredRenderer>());
+    }
+
+    OptionalRef<DeferredRenderer>::std_t LuaDeferredRenderer::getCameraComponent(Camera& cam) noexcept
+    {
+        return cam.getComponent<DeferredRenderer>();
+    }
+
+    void LuaDeferredRenderer::bind(sol::state_view& lua) noexcept
+    {
+        lua.new_usertype<DeferredRenderer>("DeferredRenderer", sol::no_constructor,
+            "type_id", sol::property(&entt::type_hash<DeferredRenderer>::value),
+            "add_camera_component", &LuaDeferredRenderer::addCameraComponent,
+            "get_camera_component", &LuaDeferredRenderer::getCameraComponent
+        );
+    }
+}
\ No newline at end of file
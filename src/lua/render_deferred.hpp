@@ -0,0 +1,20 @@
+#pragma once
+
+#include "lua/lua.hpp"
+#include <darmok/optional_ref.hpp>
+
+namespace darmok
+{
+    class DeferredRenderer;
+    class Camera;
+
+    class LuaDeferredRenderer final
+    {
+    public:
+        static void bind(sol::state_view& lua) noexcept;
+    private:
+
+        static std::reference_wrapper<DeferredRenderer> addCameraComponent(Camera& cam);
+        static OptionalRef<DeferredRenderer>::std_t getCameraComponent(Camera& cam) noexcept;
+    };
+}
\ No newline at end of file
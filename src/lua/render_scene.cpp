@@ -71,7 +71,8 @@ namespace darmok
 			"get_entity", &LuaRenderable::getEntity,
 			"mesh", sol::property(&Renderable::getMesh, &Renderable::setMesh),
 			"material", sol::property(&Renderable::getMaterial, &Renderable::setMaterial),
-			"enabled", sol::property(&Renderable::isEnabled, &Renderable::setEnabled)
+			"enabled", sol::property(&Renderable::isEnabled, &Renderable::setEnabled),
+			"shadow_caster", sol::property(&Renderable::isShadowCaster, &Renderable::setShadowCaster)
 		);
 	}
 }
@@ -215,57 +215,22 @@ namespace darmok
 		return 0;
 	}
 
-	void Material::renderSubmit(bgfx::ViewId viewId, bgfx::Encoder& encoder, OptionalRef<const RenderConfig> optConfig) const noexcept
+	void Material::renderSubmit(bgfx::ViewId viewId, bgfx::Encoder& encoder, OptionalRef<const RenderConfig> optConfig, const ProgramDefines& extraDefines, uint32_t depth, OptionalRef<MaterialSubmitState> submitState) const noexcept
 	{
-		std::optional<RenderConfig> defConfig;
-		if (!optConfig)
+		auto bound = submitState && submitState->material == this && submitState->viewId == viewId;
+		if (!bound)
 		{
-			defConfig = RenderConfig::createDefault();
-		}
-		auto& config = optConfig ? *optConfig : *defConfig;
-		glm::vec4 hasTextures{ 0 };
-
-		for (const auto& [type, key] : config.textureUniformKeys)
-		{
-			auto itr = textures.find(type);
-			std::shared_ptr<Texture> tex;
-			if (itr != textures.end())
+			if (optConfig)
 			{
-				hasTextures.x += 1 << (int)type;
-				tex = itr->second;
+				setUniforms(encoder, *optConfig);
 			}
 			else
 			{
-				tex = config.defaultTexture;
-			}
-			if (tex)
-			{
-				config.uniformHandles.configure(encoder, key, tex->getHandle());
+				// slow path, the renderers pass the config of the MaterialAppComponent
+				setUniforms(encoder, RenderConfig::createDefault());
 			}
 		}
 
-		// pbr
-		if (config.defaultTexture)
-		{
-			encoder.setTexture(RenderSamplers::MATERIAL_ALBEDO_LUT, config.albedoLutSamplerUniform, config.defaultTexture->getHandle());
-		}
-		auto val = Colors::normalize(baseColor);
-		encoder.setUniform(config.baseColorUniform, glm::value_ptr(val));
-		val = glm::vec4{ metallicFactor, roughnessFactor, normalScale, occlusionStrength };
-		encoder.setUniform(config.metallicRoughnessNormalOcclusionUniform, glm::value_ptr(val));
-		val = glm::vec4{ Colors::normalize(emissiveColor), 0 };
-		encoder.setUniform(config.emissiveColorUniform, glm::value_ptr(val));
-		val = glm::vec4{ multipleScattering ? 1.F : 0.F, whiteFurnanceFactor, 0, 0 };
-		encoder.setUniform(config.multipleScatteringUniform, glm::value_ptr(val));
-
-		// phong
-		val = glm::vec4{ Colors::normalize(specularColor), shininess };
-		encoder.setUniform(config.specularColorUniform, glm::value_ptr(val));
-
-		encoder.setUniform(config.hasTexturesUniform, glm::value_ptr(hasTextures));
-		config.basicUniforms.configure(encoder);
-		config.uniformHandles.configure(encoder, uniformValues);
-
 		uint64_t state = BGFX_STATE_DEFAULT;
 		state = (state & ~BGFX_STATE_DEPTH_TEST_MASK) | getDepthTestFlag(depthTest);
 		if (twoSided)
@@ -293,8 +258,61 @@ namespace darmok
 		}
 
 		encoder.setState(state);
-		auto prog = program->getHandle(programDefines);
-		encoder.submit(viewId, prog);
+
+		// the bindings are kept so that the next draw with the same material does not need them
+		uint8_t discard = BGFX_DISCARD_ALL;
+		if (submitState)
+		{
+			submitState->material = this;
+			submitState->viewId = viewId;
+			discard &= ~BGFX_DISCARD_BINDINGS;
+		}
+		encoder.submit(viewId, program->getHandle(programDefines, extraDefines), depth, discard);
+	}
+
+	void Material::setUniforms(bgfx::Encoder& encoder, const RenderConfig& config) const noexcept
+	{
+		glm::vec4 hasTextures{ 0 };
+		for (const auto& sampler : config.textureSamplers)
+		{
+			auto itr = textures.find(sampler.type);
+			const Texture* tex = nullptr;
+			if (itr != textures.end() && itr->second)
+			{
+				hasTextures.x += 1 << (int)sampler.type;
+				tex = itr->second.get();
+			}
+			else
+			{
+				tex = config.defaultTexture.get();
+			}
+			if (tex)
+			{
+				encoder.setTexture(sampler.stage, sampler.uniform, tex->getHandle());
+			}
+		}
+
+		// pbr
+		if (config.defaultTexture)
+		{
+			encoder.setTexture(RenderSamplers::MATERIAL_ALBEDO_LUT, config.albedoLutSamplerUniform, config.defaultTexture->getHandle());
+		}
+		auto val = Colors::normalize(baseColor);
+		encoder.setUniform(config.baseColorUniform, glm::value_ptr(val));
+		val = glm::vec4{ metallicFactor, roughnessFactor, normalScale, occlusionStrength };
+		encoder.setUniform(config.metallicRoughnessNormalOcclusionUniform, glm::value_ptr(val));
+		val = glm::vec4{ Colors::normalize(emissiveColor), 0 };
+		encoder.setUniform(config.emissiveColorUniform, glm::value_ptr(val));
+		val = glm::vec4{ multipleScattering ? 1.F : 0.F, whiteFurnanceFactor, 0, 0 };
+		encoder.setUniform(config.multipleScatteringUniform, glm::value_ptr(val));
+
+		// phong
+		val = glm::vec4{ Colors::normalize(specularColor), shininess };
+		encoder.setUniform(config.specularColorUniform, glm::value_ptr(val));
+
+		encoder.setUniform(config.hasTexturesUniform, glm::value_ptr(hasTextures));
+		config.basicUniforms.configure(encoder);
+		config.uniformHandles.configure(encoder, uniformValues);
 	}
 
 	MaterialRenderConfig MaterialRenderConfig::createDefault() noexcept
@@ -315,10 +333,27 @@ namespace darmok
 		config.emissiveColorUniform = { "u_emissiveFactorVec", bgfx::UniformType::Vec4 };
 		config.hasTexturesUniform = { "u_hasTextures", bgfx::UniformType::Vec4 };
 		config.multipleScatteringUniform = { "u_multipleScatteringVec", bgfx::UniformType::Vec4 };
+		config.updateTextureSamplers();
 
 		return config;
 	}
 
+	void MaterialRenderConfig::updateTextureSamplers() noexcept
+	{
+		textureSamplers.clear();
+		textureSamplers.reserve(textureUniformKeys.size());
+		for (const auto& [type, key] : textureUniformKeys)
+		{
+			textureSamplers.push_back({ type, static_cast<uint8_t>(key.stage()), UniformHandle{ key.name(), bgfx::UniformType::Sampler } });
+		}
+	}
+
+	void MaterialSubmitState::reset() noexcept
+	{
+		material = nullptr;
+		viewId = 0;
+	}
+
 
 	void MaterialRenderConfig::reset() noexcept
 	{
@@ -330,6 +365,7 @@ namespace darmok
 		hasTexturesUniform.reset();
 		multipleScatteringUniform.reset();
 		textureUniformKeys.clear();
+		textureSamplers.clear();
 		defaultTexture.reset();
 		basicUniforms.clear();
 		uniformHandles.clear();
@@ -385,11 +421,11 @@ namespace darmok
 		return {};
 	}
 
-	void MaterialAppComponent::renderSubmit(bgfx::ViewId viewId, bgfx::Encoder& encoder, const Material& material) const noexcept
+	void MaterialAppComponent::renderSubmit(bgfx::ViewId viewId, bgfx::Encoder& encoder, const Material& material, const ProgramDefines& extraDefines, uint32_t depth, OptionalRef<MaterialSubmitState> submitState) const noexcept
 	{
 		if (_renderConfig)
 		{
-			material.renderSubmit(viewId, encoder, *_renderConfig);
+			material.renderSubmit(viewId, encoder, *_renderConfig, extraDefines, depth, submitState);
 		}
 	}
 }
@@ -37,7 +37,7 @@ namespace darmok
 		};
 	}
 
-	expected<Mesh::StaticMode, std::string> Mesh::StaticMode::create(const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config) noexcept
+	expected<Mesh::StaticMode, std::string> Mesh::StaticMode::create(const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config, std::shared_ptr<const void> owner) noexcept
 	{
 		StaticMode mode;
 		if (vertices.empty())
@@ -45,10 +45,12 @@ namespace darmok
 			return mode;
 		}
 		auto flags = config.getFlags();
-		mode.vertexBuffer = { vertices.copyMem(), layout, flags };
+		auto vertexMem = owner ? vertices.makeRef(owner) : vertices.copyMem();
+		mode.vertexBuffer = { vertexMem, layout, flags };
 		if (!indices.empty())
 		{
-			mode.indexBuffer = { indices.copyMem(), flags };
+			auto indexMem = owner ? indices.makeRef(owner) : indices.copyMem();
+			mode.indexBuffer = { indexMem, flags };
 		}
 		return mode;
 	}
@@ -131,7 +133,12 @@ namespace darmok
 
 	expected<Mesh, std::string> Mesh::load(const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config) noexcept
 	{
-		auto modeResult = createMode(config.type, layout, vertices, indices, config);
+		return load(layout, vertices, indices, config, nullptr);
+	}
+
+	expected<Mesh, std::string> Mesh::load(const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config, std::shared_ptr<const void> owner) noexcept
+	{
+		auto modeResult = createMode(config.type, layout, vertices, indices, config, std::move(owner));
 		if(!modeResult)
 		{
 			return unexpected(modeResult.error());
@@ -153,7 +160,17 @@ namespace darmok
 			DataView{ def.vertices() }, DataView{ def.indices() }, Config::fromDefinition(def));
 	}
 
-	expected<Mesh::Mode, std::string> Mesh::createMode(Type type, const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config) noexcept
+	expected<Mesh, std::string> Mesh::load(const std::shared_ptr<const Definition>& def) noexcept
+	{
+		if (!def)
+		{
+			return unexpected<std::string>{ "empty definition" };
+		}
+		return load(ConstVertexLayoutWrapper{ def->layout() }.getBgfx(),
+			DataView{ def->vertices() }, DataView{ def->indices() }, Config::fromDefinition(*def), def);
+	}
+
+	expected<Mesh::Mode, std::string> Mesh::createMode(Type type, const bgfx::VertexLayout& layout, DataView vertices, DataView indices, Config config, std::shared_ptr<const void> owner) noexcept
 	{
 		auto flags = config.getFlags();
 		switch (config.type)
@@ -163,7 +180,7 @@ namespace darmok
 			case Definition::Transient:
 				return TransientMode::create(layout, vertices, indices, config);
 			case Definition::Static:
-				return StaticMode::create(layout, vertices, indices, config);
+				return StaticMode::create(layout, vertices, indices, config, std::move(owner));
 			default:
 				return unexpected<std::string>{ "unknown mesh type" };
 		}
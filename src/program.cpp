@@ -8,6 +8,11 @@
 #include "generated/shaders/forward.h"
 #include "generated/shaders/forward_basic.h"
 #include "generated/shaders/tonemap.h"
+#include "generated/shaders/deferred_light.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 namespace darmok
 {    
@@ -120,15 +125,24 @@ namespace darmok
 
     bgfx::ShaderHandle Program::findBestShader(const Defines& defines, const ShaderHandles& handles) noexcept
     {
-        size_t count = 0;
+        // the shader with most defines that are all contained in the requested ones
+        // iterating the shaders avoids enumerating every combination of the defines
+        std::optional<size_t> count;
         bgfx::ShaderHandle handle{ bgfx::kInvalidHandle };
-        for (auto combDefines : CollectionUtils::combinations(defines))
+        for (auto& [shaderDefines, shaderHandle] : handles)
         {
-            auto itr = handles.find(combDefines);
-            if (itr != handles.end() && count <= combDefines.size())
+            if (count && shaderDefines.size() <= count.value())
+            {
+                continue;
+            }
+            auto contained = std::all_of(shaderDefines.begin(), shaderDefines.end(), [&defines](auto& define)
+            {
+                return defines.contains(define);
+            });
+            if (contained)
             {
-                handle = itr->second;
-                count = combDefines.size();
+                handle = shaderHandle;
+                count = shaderDefines.size();
             }
         }
         return handle;
@@ -157,6 +171,29 @@ namespace darmok
         {
             addDefines(elm.first);
         }
+        updateMasks();
+    }
+
+    void Program::updateMasks() noexcept
+    {
+        _defineMasks.clear();
+        _maskHandles.clear();
+        if (_allDefines.size() > std::numeric_limits<DefinesMask>::digits)
+        {
+            return;
+        }
+
+        // sorted so that the bits do not depend on the set order
+        std::vector<std::string> defines{ _allDefines.begin(), _allDefines.end() };
+        std::sort(defines.begin(), defines.end());
+        for (size_t i = 0; i < defines.size(); ++i)
+        {
+            _defineMasks.emplace(defines[i], DefinesMask{ 1 } << i);
+        }
+        for (auto& [handleDefines, handle] : _handles)
+        {
+            _maskHandles.emplace(getDefinesMask(handleDefines), handle);
+        }
     }
 
 	expected<Program, std::string> Program::load(const Definition& def) noexcept
@@ -235,8 +272,51 @@ namespace darmok
         return def;
     }
 
+	Program::DefinesMask Program::getDefinesMask(const Defines& defines) const noexcept
+	{
+        DefinesMask mask = 0;
+        for (auto& define : defines)
+        {
+            auto itr = _defineMasks.find(define);
+            if (itr != _defineMasks.end())
+            {
+                mask |= itr->second;
+            }
+        }
+        return mask;
+	}
+
+	ProgramHandle Program::getHandle(DefinesMask mask) const noexcept
+	{
+        auto itr = _maskHandles.find(mask);
+        if (itr != _maskHandles.end())
+        {
+            return itr->second;
+        }
+        return {};
+	}
+
+	ProgramHandle Program::getHandle(const Defines& defines, const Defines& extraDefines) const noexcept
+	{
+        if (extraDefines.empty())
+        {
+            return getHandle(defines);
+        }
+        if (!_maskHandles.empty())
+        {
+            return getHandle(getDefinesMask(defines) | getDefinesMask(extraDefines));
+        }
+        auto allDefines = defines;
+        allDefines.insert(extraDefines.begin(), extraDefines.end());
+        return getHandle(allDefines);
+	}
+
 	ProgramHandle Program::getHandle(const Defines& defines) const noexcept
 	{
+        if (!_maskHandles.empty())
+        {
+            return getHandle(getDefinesMask(defines));
+        }
         Defines existingDefines;
         for (auto& define : defines)
         {
@@ -258,6 +338,11 @@ namespace darmok
 		return _vertexLayout;
 	}
 
+	const Program::Defines& Program::getDefines() const noexcept
+	{
+		return _allDefines;
+	}
+
     expected<void, std::string> StandardProgramLoader::loadDefinition(Definition& def, Type type)
     {
         switch (type)
@@ -272,6 +357,8 @@ namespace darmok
             return protobuf::readStaticMem(def, darmok_program_forward_basic);
         case protobuf::StandardProgram::Tonemap:
             return protobuf::readStaticMem(def, darmok_program_tonemap);
+        case protobuf::StandardProgram::DeferredLight:
+            return protobuf::readStaticMem(def, darmok_program_deferred_light);
         default:
             break;
         }
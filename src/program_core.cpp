@@ -800,6 +800,11 @@ namespace darmok
     {
     }
 
+    ProgramFileImporterImpl::ProgramFileImporterImpl(const CompileConfig& defaultConfig) noexcept
+        : _defaultConfig{ defaultConfig }
+    {
+    }
+
     void ProgramFileImporterImpl::setShadercPath(const std::filesystem::path& path) noexcept
     {
         _defaultConfig.shadercPath = path;
@@ -820,6 +825,11 @@ namespace darmok
         _defaultConfig.optimizationLevel = level;
     }
 
+    const ProgramFileImporterImpl::CompileConfig& ProgramFileImporterImpl::getDefaultConfig() const noexcept
+    {
+        return _defaultConfig;
+    }
+
     expected<void, std::string> ProgramFileImporterImpl::init(OptionalRef<std::ostream> log) noexcept
     {
         _defaultConfig.log = log;
@@ -996,6 +1006,13 @@ namespace darmok
         return (*_impl)(input, config);
     }
 
+    std::unique_ptr<IFileTypeImporter> ProgramFileImporter::clone() const noexcept
+    {
+        auto importer = std::make_unique<ProgramFileImporter>();
+        importer->_impl = std::make_unique<ProgramFileImporterImpl>(_impl->getDefaultConfig());
+        return importer;
+    }
+
     const std::string& ProgramFileImporter::getName() const noexcept
     {
         return _impl->getName();
@@ -1,5 +1,23 @@
 #include <darmok/render_deferred.hpp>
 #include <darmok/camera.hpp>
+#include <darmok/scene.hpp>
+#include <darmok/app.hpp>
+#include <darmok/mesh.hpp>
+#include <darmok/mesh_core.hpp>
+#include <darmok/program.hpp>
+#include <darmok/material.hpp>
+#include <darmok/texture.hpp>
+#include <darmok/transform.hpp>
+#include <darmok/light.hpp>
+#include <darmok/shadow.hpp>
+#include <darmok/string.hpp>
+#include "detail/render_samplers.hpp"
+#include "detail/render_scene.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include <array>
 
 namespace darmok
 {
@@ -9,25 +27,402 @@ namespace darmok
         return def;
     }
 
+    const std::string DeferredRenderer::_deferredDefine = "DEFERRED";
+    const std::string DeferredRenderer::_shadowDefine = "SHADOW_ENABLED";
+
+    DeferredRenderer::DeferredRenderer(const Definition& def) noexcept
+        : _def{ def }
+    {
+    }
+
+    DeferredRenderer::~DeferredRenderer() noexcept = default;
+
     expected<void, std::string> DeferredRenderer::init(Camera& cam, Scene& scene, App& app) noexcept
     {
         _cam = cam;
+        _scene = scene;
+        _app = app;
+        auto matResult = app.getOrAddComponent<MaterialAppComponent>();
+        if (!matResult)
+        {
+            return unexpected{ std::move(matResult).error() };
+        }
+        _materials = matResult.value().get();
+
+        auto progResult = StandardProgramLoader::load(Program::Standard::DeferredLight);
+        if (!progResult)
+        {
+            return unexpected{ std::move(progResult).error() };
+        }
+        _lightProgram = progResult.value();
+        auto& layout = _lightProgram->getVertexLayout();
+
+        static const Rectangle screen{ glm::uvec2{ 2 } };
+        auto meshResult = MeshData{ screen }.createMesh(layout);
+        if (!meshResult)
+        {
+            return unexpected{ std::move(meshResult).error() };
+        }
+        _screenMesh = std::make_unique<Mesh>(std::move(meshResult).value());
+
+        // the sphere vertices are inside the radius, scaled up when rendering
+        meshResult = MeshData{ Sphere{ 1.F } }.createMesh(layout);
+        if (!meshResult)
+        {
+            return unexpected{ std::move(meshResult).error() };
+        }
+        _sphereMesh = std::make_unique<Mesh>(std::move(meshResult).value());
+
+        _gbufferUniforms.clear();
+        _gbufferUniforms.emplace_back("s_gbufferAlbedo", bgfx::UniformType::Sampler);
+        _gbufferUniforms.emplace_back("s_gbufferNormal", bgfx::UniformType::Sampler);
+        _gbufferUniforms.emplace_back("s_gbufferMaterial", bgfx::UniformType::Sampler);
+        _gbufferUniforms.emplace_back("s_gbufferEmissive", bgfx::UniformType::Sampler);
+        _gbufferUniforms.emplace_back("s_gbufferDepth", bgfx::UniformType::Sampler);
+        _lightVecUniform = { "u_deferredLightVec", bgfx::UniformType::Vec4 };
+        _multipleScatteringUniform = { "u_multipleScatteringVec", bgfx::UniformType::Vec4 };
+
         return {};
     }
 
     expected<void, std::string> DeferredRenderer::load(const Definition& def) noexcept
     {
+        _def = def;
+        return {};
+    }
+
+    expected<void, std::string> DeferredRenderer::updateGBuffer(const glm::uvec2& size) noexcept
+    {
+        if (!_gbufferTextures.empty() && _gbufferTextures.front()->getSize() == size)
+        {
+            return {};
+        }
+        _gbuffer.reset();
+        _gbufferTextures.clear();
+        if (size.x == 0 || size.y == 0)
+        {
+            return {};
+        }
+
+        static const std::array<Texture::Definition::Format, 5> formats{
+            Texture::Definition::RGBA8,
+            Texture::Definition::RGBA16F,
+            Texture::Definition::RGBA8,
+            Texture::Definition::RGBA16F,
+            Texture::Definition::D32F,
+        };
+        static const uint64_t flags = BGFX_TEXTURE_RT | BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP;
+
+        std::vector<bgfx::TextureHandle> handles;
+        for (auto format : formats)
+        {
+            Texture::Config config;
+            *config.mutable_size() = convert<protobuf::Uvec2>(size);
+            config.set_format(format);
+            config.set_type(Texture::Definition::Texture2D);
+            auto texResult = Texture::load(config, flags);
+            if (!texResult)
+            {
+                _gbufferTextures.clear();
+                return unexpected{ std::move(texResult).error() };
+            }
+            auto& tex = _gbufferTextures.emplace_back(std::make_shared<Texture>(std::move(texResult).value()));
+            handles.push_back(tex->getHandle());
+        }
+        _gbuffer = bgfx::createFrameBuffer(static_cast<uint8_t>(handles.size()), &handles.front());
         return {};
     }
 
     expected<bgfx::ViewId, std::string> DeferredRenderer::renderReset(bgfx::ViewId viewId) noexcept
     {
+        _geometryViewId.reset();
+        _lightViewId.reset();
+        _forwardViewId.reset();
+        if (!_cam)
+        {
+            return unexpected<std::string>{"camera not loaded"};
+        }
+        auto size = _cam->getCombinedViewport().size;
+        auto result = updateGBuffer(size);
+        if (!result)
+        {
+            return unexpected{ std::move(result).error() };
+        }
+
+        bgfx::setViewName(viewId, _cam->getViewName("Deferred Geometry").c_str());
+        bgfx::setViewFrameBuffer(viewId, _gbuffer);
+        bgfx::setViewRect(viewId, 0, 0, size.x, size.y);
+        bgfx::setViewClear(viewId, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH | BGFX_CLEAR_STENCIL, 0, 1.F, 0U);
+        bgfx::setViewMode(viewId, bgfx::ViewMode::DepthAscending);
+        _geometryViewId = viewId++;
+
+        // the ambient pass goes first and copies the geometry depth
+        _cam->configureView(viewId, "Deferred Light");
+        bgfx::setViewMode(viewId, bgfx::ViewMode::Sequential);
+        _lightViewId = viewId++;
+
+        // transparent and other materials that cannot be deferred
+        _cam->configureView(viewId, "Deferred Forward");
+        bgfx::setViewClear(viewId, BGFX_CLEAR_NONE);
+        bgfx::setViewMode(viewId, bgfx::ViewMode::DepthAscending);
+        _forwardViewId = viewId++;
+
         return viewId;
     }
 
     expected<void, std::string> DeferredRenderer::shutdown() noexcept
     {
+        _gbuffer.reset();
+        _gbufferTextures.clear();
+        _gbufferUniforms.clear();
+        _lightVecUniform = {};
+        _multipleScatteringUniform = {};
+        _screenMesh.reset();
+        _sphereMesh.reset();
+        _lightProgram.reset();
+        _geometryViewId.reset();
+        _lightViewId.reset();
+        _forwardViewId.reset();
+        _materials.reset();
         _cam.reset();
+        _scene.reset();
+        _app.reset();
+        return {};
+    }
+
+    bool DeferredRenderer::canBeDeferred(const Material& material) const noexcept
+    {
+        if (!material.program || material.opacityType != Material::Definition::Opaque)
+        {
+            return false;
+        }
+        if (material.primitiveType != Material::Definition::Triangle)
+        {
+            return false;
+        }
+        return material.program->getDefines().contains(_deferredDefine);
+    }
+
+    void DeferredRenderer::fillQueues() noexcept
+    {
+        _geometryQueue.clear();
+        _forwardQueue.clear();
+        auto view = _cam->getViewMatrix();
+        for (auto entity : _cam->getEntities<Renderable>())
+        {
+            auto renderable = _scene->getComponent<const Renderable>(entity);
+            if (!renderable->valid() || !renderable->isEnabled())
+            {
+                continue;
+            }
+            if (_cam->shouldEntityBeCulled(entity))
+            {
+                continue;
+            }
+            auto depth = 0.F;
+            if (auto trans = _scene->getComponentInParent<const Transform>(entity))
+            {
+                depth = (view * trans->getWorldMatrix()[3]).z;
+            }
+            auto& material = *renderable->getMaterial();
+            auto& queue = canBeDeferred(material) ? _geometryQueue : _forwardQueue;
+            queue.add(entity, material, *renderable->getMesh(), depth);
+        }
+        _geometryQueue.sort();
+        _forwardQueue.sort();
+    }
+
+    expected<void, std::string> DeferredRenderer::render() noexcept
+    {
+        if (!_geometryViewId || !_lightViewId || !_forwardViewId || !_gbuffer)
+        {
+            return {};
+        }
+        if (!_scene)
+        {
+            return unexpected<std::string>{"scene not loaded"};
+        }
+        if (!_cam)
+        {
+            return unexpected<std::string>{"camera not loaded"};
+        }
+        if (!_cam->isEnabled())
+        {
+            return {};
+        }
+
+        fillQueues();
+
+        auto& encoder = *bgfx::begin();
+        std::vector<std::string> errors;
+
+        auto geometryViewId = _geometryViewId.value();
+        _cam->setViewTransform(geometryViewId);
+        static const ProgramDefines geometryDefines{ _deferredDefine };
+        auto result = renderQueue(geometryViewId, encoder, _geometryQueue, geometryDefines);
+        if (!result)
+        {
+            errors.push_back(std::move(result).error());
+        }
+
+        auto lightViewId = _lightViewId.value();
+        _cam->setViewTransform(lightViewId);
+        result = renderLights(lightViewId, encoder);
+        if (!result)
+        {
+            errors.push_back(std::move(result).error());
+        }
+
+        auto forwardViewId = _forwardViewId.value();
+        result = _cam->beforeRenderView(forwardViewId, encoder);
+        if (!result)
+        {
+            errors.push_back(std::move(result).error());
+        }
+        result = renderQueue(forwardViewId, encoder, _forwardQueue, {});
+        if (!result)
+        {
+            errors.push_back(std::move(result).error());
+        }
+
+        bgfx::end(&encoder);
+        return StringUtils::joinExpectedErrors(errors);
+    }
+
+    expected<void, std::string> DeferredRenderer::renderQueue(bgfx::ViewId viewId, bgfx::Encoder& encoder, const RenderQueue& queue, const ProgramDefines& defines) const noexcept
+    {
+        auto& items = queue.getItems();
+        auto recordItems = [this, viewId, &items, &defines](bgfx::Encoder& encoder, size_t start, size_t end) -> expected<void, std::string>
+        {
+            std::vector<std::string> errors;
+            MaterialSubmitState submitState;
+            for (auto i = start; i < end; ++i)
+            {
+                auto entity = items[i].entity;
+                auto result = _cam->beforeRenderEntity(entity, viewId, encoder);
+                if (!result)
+                {
+                    errors.push_back(std::move(result).error());
+                    continue;
+                }
+                auto renderable = _scene->getComponent<const Renderable>(entity);
+                if (!renderable->render(encoder))
+                {
+                    continue;
+                }
+                // the queue position keeps the order across encoders
+                _materials->renderSubmit(viewId, encoder, *renderable->getMaterial(), defines, static_cast<uint32_t>(i), submitState);
+            }
+            return StringUtils::joinExpectedErrors(errors);
+        };
+        return RenderParallelUtils::record(_app->getTaskExecutor(), encoder, items.size(), recordItems);
+    }
+
+    expected<void, std::string> DeferredRenderer::renderLights(bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept
+    {
+        std::vector<std::string> errors;
+        auto addResult = [&errors](expected<void, std::string> result)
+        {
+            if (!result)
+            {
+                errors.push_back(std::move(result).error());
+            }
+        };
+
+        addResult(renderLight(viewId, encoder, LightType::Ambient, 0, nullptr));
+
+        // same order as the directional light buffer
+        size_t dirIndex = 0;
+        for ([[maybe_unused]] auto entity : _cam->getEntities<DirectionalLight>())
+        {
+            addResult(renderLight(viewId, encoder, LightType::Directional, dirIndex++, nullptr));
+        }
+
+        if (auto lighting = _cam->getComponent<LightingRenderComponent>())
+        {
+            auto& pointBounds = lighting->getPointLightBounds();
+            for (size_t i = 0; i < pointBounds.size(); ++i)
+            {
+                addResult(renderLight(viewId, encoder, LightType::Point, i, pointBounds[i]));
+            }
+            auto& spotBounds = lighting->getSpotLightBounds();
+            for (size_t i = 0; i < spotBounds.size(); ++i)
+            {
+                addResult(renderLight(viewId, encoder, LightType::Spot, i, spotBounds[i]));
+            }
+        }
+
+        return StringUtils::joinExpectedErrors(errors);
+    }
+
+    expected<void, std::string> DeferredRenderer::renderLight(bgfx::ViewId viewId, bgfx::Encoder& encoder, LightType type, size_t index, OptionalRef<const Sphere> bounds) noexcept
+    {
+        // light and shadow uniforms are bound through the camera entity
+        auto camEntity = _scene->getEntity(_cam.value());
+        auto result = _cam->beforeRenderEntity(camEntity, viewId, encoder);
+        if (!result)
+        {
+            return result;
+        }
+
+        uint64_t state = BGFX_STATE_WRITE_RGB;
+        if (type == LightType::Ambient)
+        {
+            state |= BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_ALWAYS;
+        }
+        else
+        {
+            state |= BGFX_STATE_BLEND_ADD;
+        }
+
+        if (bounds)
+        {
+            // the back faces of the volume pass when they are behind the geometry
+            // so that it works with the camera inside the light range
+            static const float volumeScale = 1.1F;
+            auto model = glm::translate(bounds->origin) * glm::scale(glm::vec3{ bounds->radius * volumeScale });
+            encoder.setTransform(glm::value_ptr(model));
+            state |= BGFX_STATE_CULL_CCW | BGFX_STATE_DEPTH_TEST_GEQUAL;
+            result = _sphereMesh->render(encoder);
+        }
+        else
+        {
+            result = _screenMesh->render(encoder);
+        }
+        if (!result)
+        {
+            return result;
+        }
+
+        static const std::array<uint8_t, 5> stages{
+            RenderSamplers::DEFERRED_ALBEDO,
+            RenderSamplers::DEFERRED_NORMAL,
+            RenderSamplers::DEFERRED_MATERIAL,
+            RenderSamplers::DEFERRED_EMISSIVE,
+            RenderSamplers::DEFERRED_DEPTH,
+        };
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            encoder.setTexture(stages[i], _gbufferUniforms[i], _gbufferTextures[i]->getHandle());
+        }
+
+        glm::vec4 lightVec{ static_cast<float>(type), static_cast<float>(index), 0.F, 0.F };
+        encoder.setUniform(_lightVecUniform, glm::value_ptr(lightVec));
+        // the G-buffer does not store the material multiple scattering flag
+        static const glm::vec4 multipleScattering{ 0.F };
+        encoder.setUniform(_multipleScatteringUniform, glm::value_ptr(multipleScattering));
+
+        ProgramDefines defines;
+        if (auto shadow = _cam->getComponent<ShadowRenderer>())
+        {
+            if (shadow->isEnabled())
+            {
+                defines.insert(_shadowDefine);
+            }
+        }
+
+        encoder.setState(state);
+        encoder.submit(viewId, _lightProgram->getHandle(defines));
         return {};
     }
-}
\ No newline at end of file
+}
@@ -9,17 +9,28 @@
 #include <darmok/render_scene.hpp>
 #include <darmok/texture.hpp>
 #include <darmok/scene_filter.hpp>
+#include <darmok/string.hpp>
+#include <darmok/app.hpp>
 #include "detail/render_samplers.hpp"
+#include "detail/render_scene.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
 
 namespace darmok
 {
 	ForwardRenderer::Definition ForwardRenderer::createDefinition() noexcept
 	{
 		Definition def;
+		def.set_min_instancing_amount(2);
 		return def;
 	}
 
-	ForwardRenderer::ForwardRenderer() noexcept
+	const std::string ForwardRenderer::_instancingDefine = "INSTANCING";
+	const std::string ForwardRenderer::_skinningDefine = "SKINNING_ENABLED";
+	const uint16_t ForwardRenderer::_instanceStride = sizeof(glm::mat4);
+
+	ForwardRenderer::ForwardRenderer(const Definition& def) noexcept
+		: _def{ def }
 	{
 	}
 
@@ -41,6 +52,7 @@ namespace darmok
 
 	expected<void, std::string> ForwardRenderer::load(const Definition& def) noexcept
 	{
+		_def = def;
 		return {};
 	}
 
@@ -52,6 +64,9 @@ namespace darmok
 			return unexpected<std::string>{"camera not loaded"};
 		}
 		_cam->configureView(viewId, "Forward");
+		// draw calls are submitted already sorted by the render queue
+		// and use their position as depth so that the order is kept across encoders
+		bgfx::setViewMode(viewId, bgfx::ViewMode::DepthAscending);
 		_viewId = viewId;
 		return ++viewId;
 	}
@@ -89,12 +104,13 @@ namespace darmok
 		{
 			return result;
 		}
-		std::vector<std::string> errors;
+		auto view = _cam->getViewMatrix();
+		_queue.clear();
 		auto entities = _cam->getEntities<Renderable>();
 		for (auto entity : entities)
 		{
 			auto renderable = _scene->getComponent<const Renderable>(entity);
-			if (!renderable->valid())
+			if (!renderable->valid() || !renderable->isEnabled())
 			{
 				continue;
 			}
@@ -102,19 +118,149 @@ namespace darmok
 			{
 				continue;
 			}
-			auto result = _cam->beforeRenderEntity(entity, viewId, encoder);
-			if (!result)
+			auto depth = 0.F;
+			if (auto trans = _scene->getComponentInParent<const Transform>(entity))
 			{
-				errors.push_back(std::move(result).error());
-				continue;
+				depth = (view * trans->getWorldMatrix()[3]).z;
 			}
-			if (!renderable->render(encoder))
+			_queue.add(entity, *renderable->getMaterial(), *renderable->getMesh(), depth);
+		}
+		_queue.sort();
+
+		_groups.clear();
+		auto& items = _queue.getItems();
+		uint32_t instances = 0;
+		for (size_t i = 0; i < items.size();)
+		{
+			auto count = getInstanceGroupSize(i, instances);
+			if (count > 1)
 			{
-				continue;
+				instances += static_cast<uint32_t>(count);
 			}
-			_materials->renderSubmit(viewId, encoder, *renderable->getMaterial());
+			_groups.push_back({ i, count });
+			i += count;
 		}
+
+		auto recordGroups = [this, viewId](bgfx::Encoder& encoder, size_t start, size_t end) -> expected<void, std::string>
+		{
+			std::vector<std::string> errors;
+			MaterialSubmitState submitState;
+			for (auto i = start; i < end; ++i)
+			{
+				auto result = renderGroup(viewId, encoder, i, submitState);
+				if (!result)
+				{
+					errors.push_back(std::move(result).error());
+				}
+			}
+			return StringUtils::joinExpectedErrors(errors);
+		};
+		result = RenderParallelUtils::record(_app->getTaskExecutor(), encoder, _groups.size(), recordGroups);
 		bgfx::end(&encoder);
-		return StringUtils::joinExpectedErrors(errors);
+		return result;
+	}
+
+	expected<void, std::string> ForwardRenderer::renderGroup(bgfx::ViewId viewId, bgfx::Encoder& encoder, size_t index, MaterialSubmitState& submitState) const noexcept
+	{
+		auto& group = _groups[index];
+		if (group.count > 1)
+		{
+			return renderInstances(viewId, encoder, index, submitState);
+		}
+		auto entity = _queue.getItems()[group.start].entity;
+		auto renderable = _scene->getComponent<const Renderable>(entity);
+		auto result = _cam->beforeRenderEntity(entity, viewId, encoder);
+		if (!result)
+		{
+			return result;
+		}
+		if (!renderable->render(encoder))
+		{
+			return {};
+		}
+		// the group index keeps the queue order across encoders
+		// so consecutive draws with the same material do not set it again
+		_materials->renderSubmit(viewId, encoder, *renderable->getMaterial(), {}, static_cast<uint32_t>(index), submitState);
+		return {};
+	}
+
+	bool ForwardRenderer::canBeInstanced(const Material& material) const noexcept
+	{
+		if (!material.program || material.opacityType == Material::Definition::Transparent)
+		{
+			return false;
+		}
+		// the skinning offset is set per entity
+		if (material.programDefines.contains(_skinningDefine))
+		{
+			return false;
+		}
+		return material.program->getDefines().contains(_instancingDefine);
+	}
+
+	size_t ForwardRenderer::getInstanceGroupSize(size_t start, uint32_t usedInstances) const noexcept
+	{
+		auto minAmount = _def.min_instancing_amount();
+		if (minAmount == 0)
+		{
+			return 1;
+		}
+		auto& items = _queue.getItems();
+		auto first = _scene->getComponent<const Renderable>(items[start].entity);
+		auto mesh = first->getMesh();
+		auto material = first->getMaterial();
+		if (!canBeInstanced(*material))
+		{
+			return 1;
+		}
+		auto end = start + 1;
+		for (; end < items.size(); ++end)
+		{
+			// the queue keeps renderables with the same mesh and material together
+			auto renderable = _scene->getComponent<const Renderable>(items[end].entity);
+			if (renderable->getMesh() != mesh || renderable->getMaterial() != material)
+			{
+				break;
+			}
+		}
+		// groups are recorded in parallel so all the instance data needs to fit
+		auto count = static_cast<uint32_t>(end - start);
+		count = bgfx::getAvailInstanceDataBuffer(usedInstances + count, _instanceStride) - usedInstances;
+		return count < minAmount ? 1 : count;
+	}
+
+	expected<void, std::string> ForwardRenderer::renderInstances(bgfx::ViewId viewId, bgfx::Encoder& encoder, size_t index, MaterialSubmitState& submitState) const noexcept
+	{
+		auto& items = _queue.getItems();
+		auto [start, count] = _groups[index];
+
+		bgfx::InstanceDataBuffer idb;
+		bgfx::allocInstanceDataBuffer(&idb, static_cast<uint32_t>(count), _instanceStride);
+		auto data = idb.data;
+		for (size_t i = start; i < start + count; ++i)
+		{
+			auto trans = _scene->getComponentInParent<const Transform>(items[i].entity);
+			auto mtx = trans ? trans->getWorldMatrix() : glm::mat4{ 1 };
+			bx::memCopy(data, glm::value_ptr(mtx), _instanceStride);
+			data += _instanceStride;
+		}
+
+		// per entity state like the lighting uniforms is taken from the first renderable
+		auto entity = items[start].entity;
+		auto result = _cam->beforeRenderEntity(entity, viewId, encoder);
+		if (!result)
+		{
+			return result;
+		}
+		auto renderable = _scene->getComponent<const Renderable>(entity);
+		result = renderable->render(encoder);
+		if (!result)
+		{
+			return result;
+		}
+		encoder.setInstanceDataBuffer(&idb);
+		static const ProgramDefines defines{ _instancingDefine };
+		_materials->renderSubmit(viewId, encoder, *renderable->getMaterial(), defines, static_cast<uint32_t>(index), submitState);
+		return {};
 	}
 }
\ No newline at end of file
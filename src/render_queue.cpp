@@ -0,0 +1,157 @@
+#include <darmok/render_queue.hpp>
+#include <darmok/material.hpp>
+#include <darmok/program.hpp>
+#include <darmok/mesh.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+
+namespace darmok
+{
+    namespace
+    {
+        // positive floats keep their order when compared as unsigned ints
+        uint32_t getDepthBits(float depth) noexcept
+        {
+            if (!(depth > 0.F))
+            {
+                return 0;
+            }
+            return std::bit_cast<uint32_t>(depth);
+        }
+    }
+
+    void RenderQueue::clear() noexcept
+    {
+        _items.clear();
+        _materialIds.clear();
+    }
+
+    uint16_t RenderQueue::getMaterialId(const Material& material) noexcept
+    {
+        auto [itr, inserted] = _materialIds.try_emplace(&material, 0);
+        if (inserted)
+        {
+            auto id = _materialIds.size() - 1;
+            itr->second = static_cast<uint16_t>(std::min<size_t>(id, std::numeric_limits<uint16_t>::max()));
+        }
+        return itr->second;
+    }
+
+    void RenderQueue::add(Entity entity, const Material& material, const Mesh& mesh, float depth) noexcept
+    {
+        uint16_t prog = bgfx::kInvalidHandle;
+        if (material.program)
+        {
+            prog = material.program->getHandle(material.programDefines).idx();
+        }
+        auto mat = getMaterialId(material);
+        uint64_t key = 0;
+        if (material.opacityType == Material::Definition::Transparent)
+        {
+            key = createTransparentKey(prog, mat, depth);
+        }
+        else
+        {
+            key = createOpaqueKey(prog, mat, mesh.getVertexHandleIndex(), depth);
+        }
+        _items.push_back({ key, entity });
+    }
+
+    uint64_t RenderQueue::createOpaqueKey(uint16_t program, uint16_t material, uint16_t mesh, float depth) noexcept
+    {
+        // [63] transparent=0 [62-47] program [46-31] material [30-15] mesh [14-0] depth
+        // keeping the exponent and the upper mantissa bits gives a logarithmic depth bucket
+        uint64_t depthBits = (getDepthBits(depth) >> 16) & 0x7FFF;
+        return (uint64_t(program) << 47)
+            | (uint64_t(material) << 31)
+            | (uint64_t(mesh) << 15)
+            | depthBits;
+    }
+
+    uint64_t RenderQueue::createTransparentKey(uint16_t program, uint16_t material, float depth) noexcept
+    {
+        // [63] transparent=1 [62-32] inverted depth [31-16] program [15-0] material
+        uint64_t depthBits = 0x7FFFFFFF - (getDepthBits(depth) & 0x7FFFFFFF);
+        return (uint64_t(1) << 63)
+            | (depthBits << 32)
+            | (uint64_t(program) << 16)
+            | uint64_t(material);
+    }
+
+    void RenderQueue::radixSort(Items& items, Items& tmp) noexcept
+    {
+        // LSD radix sort on 8 bit digits, skipping digits shared by all the keys
+        static const size_t digitBits = 8;
+        static const size_t digits = sizeof(uint64_t) * 8 / digitBits;
+        static const size_t buckets = size_t(1) << digitBits;
+
+        auto size = items.size();
+        if (size < 2)
+        {
+            return;
+        }
+        tmp.resize(size);
+
+        std::array<std::array<uint32_t, buckets>, digits> histograms{};
+        for (auto& item : items)
+        {
+            for (size_t d = 0; d < digits; ++d)
+            {
+                ++histograms[d][(item.key >> (d * digitBits)) & (buckets - 1)];
+            }
+        }
+
+        auto src = &items;
+        auto dst = &tmp;
+        for (size_t d = 0; d < digits; ++d)
+        {
+            auto& histogram = histograms[d];
+            auto shift = d * digitBits;
+            auto firstDigit = (src->front().key >> shift) & (buckets - 1);
+            if (histogram[firstDigit] == size)
+            {
+                continue;
+            }
+            uint32_t offset = 0;
+            for (auto& count : histogram)
+            {
+                auto c = count;
+                count = offset;
+                offset += c;
+            }
+            for (auto& item : *src)
+            {
+                auto digit = (item.key >> shift) & (buckets - 1);
+                (*dst)[histogram[digit]++] = item;
+            }
+            std::swap(src, dst);
+        }
+        if (src != &items)
+        {
+            items.swap(tmp);
+        }
+    }
+
+    void RenderQueue::sort() noexcept
+    {
+        radixSort(_items, _tmpItems);
+    }
+
+    const RenderQueue::Items& RenderQueue::getItems() const noexcept
+    {
+        return _items;
+    }
+
+    size_t RenderQueue::size() const noexcept
+    {
+        return _items.size();
+    }
+
+    bool RenderQueue::empty() const noexcept
+    {
+        return _items.empty();
+    }
+}
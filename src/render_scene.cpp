@@ -7,7 +7,11 @@
 #include <darmok/texture.hpp>
 #include <darmok/protobuf.hpp>
 #include <darmok/scene_serialize.hpp>
+#include <darmok/string.hpp>
 #include "detail/scene.hpp"
+#include "detail/render_scene.hpp"
+
+#include <taskflow/taskflow.hpp>
 
 using namespace entt::literals;
 
@@ -17,6 +21,7 @@ namespace darmok
 		: _mesh{ mesh }
 		, _material{ material }
 		, _enabled{ true }
+		, _shadowCaster{ true }
 	{
 	}
 
@@ -68,6 +73,17 @@ namespace darmok
 		return *this;
 	}
 
+	bool Renderable::isShadowCaster() const noexcept
+	{
+		return _shadowCaster;
+	}
+
+	Renderable& Renderable::setShadowCaster(bool caster) noexcept
+	{
+		_shadowCaster = caster;
+		return *this;
+	}
+
 	bgfx::VertexLayout Renderable::getVertexLayout() const noexcept
 	{
 		if (!_material)
@@ -115,6 +131,7 @@ namespace darmok
 			}
 			_material = matResult.value();
 		}
+		_shadowCaster = !def.skip_shadows();
 
 		return {};
 	}
@@ -123,4 +140,54 @@ namespace darmok
 	{
 		return {};
 	}
+
+	const size_t RenderParallelUtils::defaultMinChunkSize = 64;
+
+	expected<void, std::string> RenderParallelUtils::record(OptionalRef<tf::Executor> executor, bgfx::Encoder& encoder, size_t size, const ChunkCallback& callback, size_t minChunkSize) noexcept
+	{
+		size_t workers = executor ? executor->num_workers() : 0;
+		minChunkSize = std::max<size_t>(minChunkSize, 1);
+		auto chunkAmount = std::min(workers + 1, (size + minChunkSize - 1) / minChunkSize);
+		if (chunkAmount <= 1)
+		{
+			return callback(encoder, 0, size);
+		}
+		auto chunkSize = (size + chunkAmount - 1) / chunkAmount;
+		std::vector<expected<void, std::string>> results(chunkAmount);
+
+		tf::Taskflow taskflow{ "RenderParallel" };
+		for (size_t i = 1; i < chunkAmount; ++i)
+		{
+			auto start = i * chunkSize;
+			if (start >= size)
+			{
+				break;
+			}
+			auto end = std::min(start + chunkSize, size);
+			taskflow.emplace([&callback, &results, i, start, end]()
+			{
+				auto encoder = bgfx::begin(true);
+				if (encoder == nullptr)
+				{
+					results[i] = unexpected<std::string>{ "no free bgfx encoder" };
+					return;
+				}
+				results[i] = callback(*encoder, start, end);
+				bgfx::end(encoder);
+			});
+		}
+		auto future = executor->run(taskflow);
+		results[0] = callback(encoder, 0, std::min(chunkSize, size));
+		future.wait();
+
+		std::vector<std::string> errors;
+		for (auto& result : results)
+		{
+			if (!result)
+			{
+				errors.push_back(std::move(result).error());
+			}
+		}
+		return StringUtils::joinExpectedErrors(errors);
+	}
 }
\ No newline at end of file
@@ -7,9 +7,12 @@
 #include <darmok/utils.hpp>
 #include <darmok/scene_filter.hpp>
 #include <darmok/string.hpp>
+#include <darmok/app.hpp>
 
 #include <glm/gtc/type_ptr.hpp>
 #include <fmt/format.h>
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
 
 #include "detail/camera.hpp"
 
@@ -475,14 +478,70 @@ namespace darmok
         }
     }
 
-    expected<void, std::string> SceneImpl::update(float deltaTime) noexcept
-    {
-        destroyPendingEntities();
+    const size_t SceneImpl::_minParallelTransforms = 1024;
 
+    void SceneImpl::updateTransforms() noexcept
+    {
+        for (auto& level : _transformLevels)
+        {
+            level.clear();
+        }
+        _changedTransforms.clear();
         for (auto entity : _scene.getUpdateEntities<Transform>())
         {
-            _scene.getComponent<Transform>(entity)->update();
+            auto& trans = _registry.get<Transform>(entity);
+            if (!trans.isDirty())
+            {
+                continue;
+            }
+            _changedTransforms.push_back(entity);
+            auto depth = trans.getDepth();
+            if (depth >= _transformLevels.size())
+            {
+                _transformLevels.resize(depth + 1);
+            }
+            _transformLevels[depth].emplace_back(trans);
+        }
+
+        // with an update filter a dirty parent could be skipped
+        // and then updated concurrently by its children
+        OptionalRef<tf::Executor> executor;
+        if (_app && _updateFilter.empty())
+        {
+            executor = _app->getTaskExecutor();
+        }
+
+        // the parents are up to date when updating each level
+        for (auto& level : _transformLevels)
+        {
+            if (!executor || level.size() < _minParallelTransforms)
+            {
+                for (auto& trans : level)
+                {
+                    trans.get().update();
+                }
+                continue;
+            }
+            tf::Taskflow taskflow{ "SceneTransforms" };
+            taskflow.for_each(level.begin(), level.end(), [](std::reference_wrapper<Transform> trans)
+            {
+                trans.get().update();
+            });
+            executor->run(taskflow).wait();
+        }
+
+        // lets the on_update listeners track the moved entities
+        for (auto entity : _changedTransforms)
+        {
+            _registry.patch<Transform>(entity);
         }
+    }
+
+    expected<void, std::string> SceneImpl::update(float deltaTime) noexcept
+    {
+        destroyPendingEntities();
+
+        updateTransforms();
 
         std::vector<std::string> errors;
 
@@ -17,6 +17,7 @@
 #include <darmok/mesh_assimp.hpp>
 #include <darmok/skeleton_assimp.hpp>
 #include <darmok/shape.hpp>
+#include <darmok/asset_pack.hpp>
 
 #include <assimp/vector3.h>
 #include <assimp/scene.h>
@@ -786,14 +787,25 @@ namespace darmok
         return (*_impl)(path);
     }
 
-    AssimpSceneFileImporterImpl::AssimpSceneFileImporterImpl(bx::AllocatorI& alloc)
+    AssimpSceneFileImporterImpl::AssimpSceneFileImporterImpl(bx::AllocatorI& alloc, const CompilerConfig& defaultCompilerConfig)
         : _dataLoader{ alloc }
         , _texLoader{ _dataLoader }
         , _alloc{ alloc }
         , _progLoader{ _dataLoader }
+        , _defaultCompilerConfig{ defaultCompilerConfig }
     {
     }
 
+    bx::AllocatorI& AssimpSceneFileImporterImpl::getAllocator() const noexcept
+    {
+        return _alloc;
+    }
+
+    const AssimpSceneFileImporterImpl::CompilerConfig& AssimpSceneFileImporterImpl::getDefaultCompilerConfig() const noexcept
+    {
+        return _defaultCompilerConfig;
+    }
+
     void AssimpSceneFileImporterImpl::setLogOutput(OptionalRef<std::ostream> log) noexcept
     {
         _defaultCompilerConfig.progCompiler.log = log;
@@ -1033,6 +1045,11 @@ namespace darmok
 
         auto basePath = input.getRelativePath().parent_path();
         outputPath = basePath / outputPath;
+        _packOutput = outputPath.extension() == AssetPackFile::extension;
+        if (_packOutput)
+        {
+            _outputFormat = protobuf::Format::Binary;
+        }
         auto binary = _outputFormat == protobuf::Format::Binary;
         effect.outputs.emplace_back(outputPath, binary);
 
@@ -1040,12 +1057,12 @@ namespace darmok
         {
             for (auto& depPath : AssimpSceneDefinitionConverter::getDependencies(*_currentScene))
             {
-                effect.dependencies.insert(basePath / depPath);
+                effect.dependencies.insert(input.basePath / basePath / depPath);
             }
         }
         if (_currentConfig->program().has_path())
         {
-            effect.dependencies.insert(basePath / _currentConfig->program().path());
+            effect.dependencies.insert(input.basePath / basePath / _currentConfig->program().path());
         }
         return effect;
     }
@@ -1105,7 +1122,7 @@ namespace darmok
             {
                 continue;
             }
-            auto writeResult = protobuf::write(def, *out, _outputFormat);
+            auto writeResult = _packOutput ? AssetPackFile::write(def, *out) : protobuf::write(def, *out, _outputFormat);
             if (!writeResult)
             {
                 return unexpected{ "failed to write output: " + writeResult.error() };
@@ -1143,6 +1160,14 @@ namespace darmok
         return (*_impl)(input, config);
     }
 
+    std::unique_ptr<IFileTypeImporter> AssimpSceneFileImporter::clone() const noexcept
+    {
+        auto& alloc = _impl->getAllocator();
+        auto importer = std::make_unique<AssimpSceneFileImporter>(alloc);
+        importer->_impl = std::make_unique<AssimpSceneFileImporterImpl>(alloc, _impl->getDefaultCompilerConfig());
+        return importer;
+    }
+
     AssimpSceneFileImporter& AssimpSceneFileImporter::setBgfxShadercPath(const std::filesystem::path& path) noexcept
     {
         _impl->setBgfxShadercPath(path);
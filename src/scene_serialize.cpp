@@ -20,6 +20,7 @@
 #include <darmok/render_forward.hpp>
 #include <darmok/render_deferred.hpp>
 #include <darmok/culling.hpp>
+#include <darmok/bounds_tree.hpp>
 #include <darmok/environment.hpp>
 #include <darmok/shadow.hpp>
 #include <darmok/prefab.hpp>
@@ -696,6 +697,11 @@ namespace darmok
 
     void SceneLoaderImpl::createAssetPack() const noexcept
     {
+        if (_assetPackFile)
+        {
+            _assetPack = std::make_unique<AssetPack>(*_assetPackFile, _assetConfig);
+            return;
+        }
         _assetPack = std::make_unique<AssetPack>(_sceneDef.assets(), _assetConfig);
     }
 
@@ -788,11 +794,27 @@ namespace darmok
 
     SceneLoaderImpl::EntityResult SceneLoaderImpl::load(const Scene::Definition& sceneDef, Scene& scene) noexcept
     {
-        if (_scene.ptr() != &scene || _sceneDefRef.ptr() != &sceneDef)
+        return load(sceneDef, nullptr, scene);
+    }
+
+    SceneLoaderImpl::EntityResult SceneLoaderImpl::load(const AssetPackFile& pack, Scene& scene) noexcept
+    {
+        auto unpackResult = pack.unpackScene(_packSceneDef);
+        if (!unpackResult)
+        {
+            return unexpected{ std::move(unpackResult).error() };
+        }
+        return load(_packSceneDef, pack, scene);
+    }
+
+    SceneLoaderImpl::EntityResult SceneLoaderImpl::load(const Scene::Definition& sceneDef, OptionalRef<const AssetPackFile> pack, Scene& scene) noexcept
+    {
+        if (_scene.ptr() != &scene || _sceneDefRef.ptr() != &sceneDef || _assetPackFile.ptr() != pack.ptr())
         {
 			_loader = entt::continuous_loader{ scene.getRegistry() };
         }
         _sceneDefRef = sceneDef;
+        _assetPackFile = pack;
 		_scene = scene;
         _typeId = 0;
         _count = 0;
@@ -987,6 +1009,7 @@ namespace darmok
     {
         registerSceneComponent<FreelookController>();
         registerSceneComponent<FrameAnimationUpdater>();
+        registerSceneComponent<SceneBoundsTree>();
         registerSceneComponent<RmluiSceneComponent>();
         registerSceneComponent<SkeletalAnimationSceneComponent>();
         registerSceneComponent<physics3d::PhysicsSystem>();
@@ -1002,6 +1025,7 @@ namespace darmok
         registerComponent<physics3d::PhysicsBody>();
         registerComponent<physics3d::CharacterController>();
         registerComponent<BoundingBox>();
+        registerComponent<Occluder>();
         registerComponent<Prefab>();
 
         registerCameraComponent<ForwardRenderer>();
@@ -1010,6 +1034,7 @@ namespace darmok
         registerCameraComponent<SkeletalAnimationRenderComponent>();
         registerCameraComponent<OcclusionCuller>();
         registerCameraComponent<FrustumCuller>();
+        registerCameraComponent<SoftwareOcclusionCuller>();
         registerCameraComponent<CullingDebugRenderer>();
         registerCameraComponent<SkyboxRenderer>();
         registerCameraComponent<GridRenderer>();
@@ -1039,6 +1064,11 @@ namespace darmok
 		return _impl->load(sceneDef, scene);
     }
 
+    SceneLoader::EntityResult SceneLoader::operator()(const AssetPackFile& pack, Scene& scene) noexcept
+    {
+        return _impl->load(pack, scene);
+    }
+
     SceneArchive& SceneLoader::getArchive() noexcept
     {
         return _archive;
@@ -14,48 +14,204 @@
 #include <darmok/scene_filter.hpp>
 #include <darmok/string.hpp>
 #include <darmok/transform.hpp>
+#include <darmok/app.hpp>
 #include <darmok/glm_serialize.hpp>
+#include <darmok/bounds_tree.hpp>
+#include <darmok/skeleton.hpp>
+#include <darmok/utils.hpp>
 #include "generated/shaders/shadow.h"
 #include "detail/render_samplers.hpp"
+#include "detail/render_scene.hpp"
+#include "detail/culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace darmok
 {
+    ShadowAtlas::ShadowAtlas(uint16_t layerAmount, uint8_t maxLevel) noexcept
+        : _layerAmount{ 0 }
+        , _maxLevel{ 0 }
+    {
+        reset(layerAmount, maxLevel);
+    }
+
+    void ShadowAtlas::reset(uint16_t layerAmount, uint8_t maxLevel) noexcept
+    {
+        static const uint8_t maxLevelLimit = 8;
+        _layerAmount = layerAmount;
+        _maxLevel = std::min(maxLevel, maxLevelLimit);
+        auto side = static_cast<size_t>(getSide());
+        _cells.assign(side * side * _layerAmount, false);
+    }
+
+    void ShadowAtlas::clear() noexcept
+    {
+        std::fill(_cells.begin(), _cells.end(), false);
+    }
+
+    uint16_t ShadowAtlas::getLayerAmount() const noexcept
+    {
+        return _layerAmount;
+    }
+
+    uint8_t ShadowAtlas::getMaxLevel() const noexcept
+    {
+        return _maxLevel;
+    }
+
+    uint32_t ShadowAtlas::getSide() const noexcept
+    {
+        return 1U << _maxLevel;
+    }
+
+    uint32_t ShadowAtlas::getTileSide(uint8_t level) const noexcept
+    {
+        return 1U << (_maxLevel - level);
+    }
+
+    bool ShadowAtlas::isValid(const ShadowAtlasTile& tile) const noexcept
+    {
+        if (tile.layer >= _layerAmount || tile.level > _maxLevel)
+        {
+            return false;
+        }
+        auto tileSide = getTileSide(tile.level);
+        auto side = getSide();
+        return tile.position.x % tileSide == 0 && tile.position.y % tileSide == 0
+            && tile.position.x + tileSide <= side && tile.position.y + tileSide <= side;
+    }
+
+    bool ShadowAtlas::isFree(const ShadowAtlasTile& tile) const noexcept
+    {
+        if (!isValid(tile))
+        {
+            return false;
+        }
+        auto side = getSide();
+        auto tileSide = getTileSide(tile.level);
+        auto layerStart = static_cast<size_t>(tile.layer) * side * side;
+        for (auto y = tile.position.y; y < tile.position.y + tileSide; ++y)
+        {
+            for (auto x = tile.position.x; x < tile.position.x + tileSide; ++x)
+            {
+                if (_cells[layerStart + (y * side) + x])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void ShadowAtlas::setCells(const ShadowAtlasTile& tile, bool used) noexcept
+    {
+        auto side = getSide();
+        auto tileSide = getTileSide(tile.level);
+        auto layerStart = static_cast<size_t>(tile.layer) * side * side;
+        for (auto y = tile.position.y; y < tile.position.y + tileSide; ++y)
+        {
+            for (auto x = tile.position.x; x < tile.position.x + tileSide; ++x)
+            {
+                _cells[layerStart + (y * side) + x] = used;
+            }
+        }
+    }
+
+    std::optional<ShadowAtlasTile> ShadowAtlas::allocate(uint8_t level) noexcept
+    {
+        if (level > _maxLevel)
+        {
+            return std::nullopt;
+        }
+        auto side = getSide();
+        auto tileSide = getTileSide(level);
+        ShadowAtlasTile tile;
+        tile.level = level;
+        for (tile.layer = 0; tile.layer < _layerAmount; ++tile.layer)
+        {
+            for (tile.position.y = 0; tile.position.y < side; tile.position.y += tileSide)
+            {
+                for (tile.position.x = 0; tile.position.x < side; tile.position.x += tileSide)
+                {
+                    if (isFree(tile))
+                    {
+                        setCells(tile, true);
+                        return tile;
+                    }
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool ShadowAtlas::reserve(const ShadowAtlasTile& tile) noexcept
+    {
+        if (!isFree(tile))
+        {
+            return false;
+        }
+        setCells(tile, true);
+        return true;
+    }
+
+    void ShadowAtlas::release(const ShadowAtlasTile& tile) noexcept
+    {
+        if (isValid(tile))
+        {
+            setCells(tile, false);
+        }
+    }
+
+    glm::vec3 ShadowAtlas::getRect(const ShadowAtlasTile& tile) const noexcept
+    {
+        auto side = static_cast<float>(getSide());
+        return { glm::vec2{ tile.position } / side, static_cast<float>(getTileSide(tile.level)) / side };
+    }
+
+    glm::uvec4 ShadowAtlas::getViewport(const ShadowAtlasTile& tile, uint32_t layerSize) const noexcept
+    {
+        auto cellSize = layerSize / getSide();
+        auto tileSize = cellSize * getTileSide(tile.level);
+        return { tile.position * cellSize, tileSize, tileSize };
+    }
+
     ShadowRenderPass::ShadowRenderPass()
-        : _fb{ bgfx::kInvalidHandle }
-        , _lightEntity{ entt::null }
+        : _lightEntity{ entt::null }
         , _part{ 0 }
+        , _viewProj{ 1.F }
+        , _cached{ false }
+        , _cachedHash{ 0 }
+        , _cachedViewProj{ 1.F }
     {
     }
 
-    void ShadowRenderPass::configure(Entity entity, uint8_t part) noexcept
+    void ShadowRenderPass::configure(Entity entity, uint8_t part, const ShadowAtlasTile& tile) noexcept
     {
-        if (_lightEntity == entity && _part == part)
+        if (_lightEntity == entity && _part == part && _tile == tile)
         {
             return;
         }
         _lightEntity = entity;
         _part = part;
+        _tile = tile;
+        _cached = false;
         configureView();
     }
 
-    void ShadowRenderPass::init(ShadowRenderer& renderer, uint16_t index) noexcept
+    void ShadowRenderPass::init(ShadowRenderer& renderer) noexcept
     {
         _renderer = renderer;
-
-        bgfx::Attachment attach;
-        attach.init(renderer.getTextureHandle(), bgfx::Access::Write, index);
-        _fb = bgfx::createFrameBuffer(1, &attach);
+        _cached = false;
     }
 
     void ShadowRenderPass::shutdown() noexcept
     {
-        if (isValid(_fb))
-        {
-            bgfx::destroy(_fb);
-            _fb.idx = bgfx::kInvalidHandle;
-        }
         _renderer.reset();
         _viewId.reset();
+        _entities.clear();
+        _cached = false;
     }
 
     bgfx::ViewId ShadowRenderPass::renderReset(bgfx::ViewId viewId) noexcept
@@ -65,6 +221,7 @@ namespace darmok
             return viewId;
         }
         _viewId = viewId;
+        _cached = false;
         configureView();
         return ++viewId;
     }
@@ -95,29 +252,31 @@ namespace darmok
         }
         bgfx::setViewName(viewId, name.c_str());
 
-        auto size = _renderer->getDefinition().map_size();
-        bgfx::setViewRect(viewId, 0, 0, size, size);
-        bgfx::setViewFrameBuffer(viewId, _fb);
+        // the clear is limited to the view rect so the other tiles of the layer are kept
+        auto rect = _renderer->getAtlas().getViewport(_tile, _renderer->getDefinition().map_size());
+        bgfx::setViewRect(viewId, static_cast<uint16_t>(rect.x), static_cast<uint16_t>(rect.y),
+            static_cast<uint16_t>(rect.z), static_cast<uint16_t>(rect.w));
+        bgfx::setViewFrameBuffer(viewId, _renderer->getLayerFrameBuffer(_tile.layer));
         bgfx::setViewClear(viewId, BGFX_CLEAR_DEPTH);
     }
 
-    void ShadowRenderPass::render(bgfx::Encoder& encoder) noexcept
+    bool ShadowRenderPass::prepare() noexcept
     {
         if (!_viewId)
         {
-            return;
+            return false;
         }
         auto viewId = _viewId.value();
-        encoder.touch(viewId);
 
+        // unused passes have no tile in the atlas so there is nothing to clear
         if (_lightEntity == entt::null || !_renderer || !_renderer->isEnabled())
         {
-            return;
+            return false;
         }
         auto scene = _renderer->getScene();
         if (!scene)
         {
-            return;
+            return false;
         }
 
         auto lightTrans = scene->getComponent<const Transform>(_lightEntity);
@@ -126,7 +285,7 @@ namespace darmok
 
         if (scene->hasComponent<DirectionalLight>(_lightEntity))
         {
-            proj = _renderer->getDirLightProjMatrix(lightTrans, _part);
+            proj = _renderer->getDirLightProjMatrix(_lightEntity, _part);
         }
         else if (auto spotLight = scene->getComponent<SpotLight>(_lightEntity))
         {
@@ -137,11 +296,92 @@ namespace darmok
             proj = _renderer->getPointLightProjMatrix(pointLight.value(), _part);
         }
         bgfx::setViewTransform(viewId, glm::value_ptr(view), glm::value_ptr(proj));
+        _viewProj = proj * view;
+        return true;
+    }
+
+    void ShadowRenderPass::invalidate() noexcept
+    {
+        _cached = false;
+    }
 
+    void ShadowRenderPass::render(bgfx::Encoder& encoder) noexcept
+    {
+        if (!_viewId || !_renderer)
+        {
+            return;
+        }
+        auto hash = updateEntities();
+
+        // the shadow map keeps the previous depth if the view is not touched
+        // directional light matrices are snapped to the texels so small camera movements keep it
+        if (_cached && hash && _cachedHash == hash.value() && _cachedViewProj == _viewProj)
+        {
+            return;
+        }
+        auto viewId = _viewId.value();
+        encoder.touch(viewId);
         renderEntities(viewId, encoder);
+
+        _cached = hash && !_renderer->getDefinition().disable_cache();
+        _cachedHash = hash.value_or(0);
+        _cachedViewProj = _viewProj;
+    }
+
+    std::optional<size_t> ShadowRenderPass::updateEntities() noexcept
+    {
+        _entities.clear();
+        auto scene = _renderer->getScene();
+
+        // the pass frustum is limited by the light range
+        auto planes = Frustum{ _viewProj }.getPlanes();
+        auto& casters = _renderer->getCasters();
+        auto& casterBounds = _renderer->getCasterBounds();
+        for (size_t i = 0; i < casters.size(); ++i)
+        {
+            if (auto& bounds = casterBounds[i])
+            {
+                auto outside = std::any_of(planes.begin(), planes.end(), [&bounds](const Plane& plane)
+                {
+                    return plane.isInFront(bounds.value());
+                });
+                if (outside)
+                {
+                    continue;
+                }
+            }
+            _entities.push_back(casters[i]);
+        }
+
+        // indexed casters are only rendered if they are inside the light frustum
+        if (auto tree = _renderer->getBoundsTree())
+        {
+            auto start = _entities.size();
+            tree->getTree().query(Frustum{ _viewProj }, _entities);
+            auto end = std::remove_if(_entities.begin() + start, _entities.end(), [this](Entity entity)
+            {
+                return !_renderer->isTreeCaster(entity);
+            });
+            _entities.erase(end, _entities.end());
+        }
+
+        // the map changes if a caster inside the frustum moved or changed mesh
+        // skinned casters can change without moving so they are never cached
+        size_t hash = 0;
+        for (auto entity : _entities)
+        {
+            auto trans = scene->getComponentInParent<const Transform>(entity);
+            auto renderable = scene->getComponent<const Renderable>(entity);
+            if (scene->hasComponent<Skinnable>(entity))
+            {
+                return std::nullopt;
+            }
+            hashCombine(hash, entity, trans ? trans->getVersion() : 0, renderable->getMesh(), renderable->isEnabled());
+        }
+        return hash;
     }
 
-    void ShadowRenderPass::renderEntities(bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept
+    void ShadowRenderPass::renderEntities(bgfx::ViewId viewId, bgfx::Encoder& encoder) const noexcept
     {
         static const uint64_t renderState =
             BGFX_STATE_WRITE_Z
@@ -152,22 +392,13 @@ namespace darmok
         auto scene = _renderer->getScene();
         auto cam = _renderer->getCamera();
 
-        auto entities = cam->getEntities<Renderable>();
-        for (auto entity : entities)
+        for (auto entity : _entities)
         {
             if (entity == _lightEntity)
             {
                 continue;
             }
             auto renderable = scene->getComponent<const Renderable>(entity);
-            if (!renderable->valid())
-            {
-                continue;
-            }
-            if (renderable->getMaterial()->primitiveType == Material::Definition::Line)
-            {
-                continue;
-            }
             cam->setEntityTransform(entity, encoder);
             if (!renderable->render(encoder))
             {
@@ -182,10 +413,12 @@ namespace darmok
     ShadowRenderer::Definition ShadowRenderer::createDefinition() noexcept
     {
         Definition def;
-        def.set_map_size(512);
+        def.set_map_size(1024);
+        def.set_layer_amount(6);
+        def.set_max_tile_level(3);
         def.set_cascade_margin(0.02F);
         def.set_cascade_easing(Easing::Definition::QuadraticIn);
-        def.set_max_pass_amount(20);
+        def.set_max_pass_amount(32);
         def.set_cascade_amount(3);
         def.set_bias(0.005F);
         def.set_normal_bias(0.02F);
@@ -196,6 +429,7 @@ namespace darmok
     ShadowRenderer::ShadowRenderer(const Definition& def) noexcept
         : _def{ def }
         , _crop{ 1 }
+        , _frameCount{ 0 }
         , _dirAmount{ 0 }
         , _spotAmount{ 0 }
         , _pointAmount{ 0 }
@@ -208,6 +442,7 @@ namespace darmok
         .end();
         _shadowLightDataLayout.begin()
             .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::Color1, 4, bgfx::AttribType::Float)
         .end();
     }
 
@@ -259,11 +494,14 @@ namespace darmok
     expected<void, std::string> ShadowRenderer::doLoad() noexcept
     {
         glm::uvec2 size{ _def.map_size() };
-        if (!_tex || _tex->getSize() != size)
+        auto layerAmount = getLayerAmount();
+        if (!_tex || _tex->getSize() != size || _tex->getLayerCount() != layerAmount)
         {
+            _layerFbs.clear();
+
             Texture::Config texConfig;
             *texConfig.mutable_size() = convert<protobuf::Uvec2>(size);
-            texConfig.set_layers(_def.max_pass_amount());
+            texConfig.set_layers(layerAmount);
             texConfig.set_format(Texture::Definition::D16);
             texConfig.set_type(Texture::Definition::Texture2D);
 
@@ -281,6 +519,21 @@ namespace darmok
             _tex = std::make_unique<Texture>(std::move(texResult).value());
         }
 
+        // the passes render into tiles of these framebuffers
+        if (_layerFbs.empty())
+        {
+            _layerFbs.reserve(layerAmount);
+            for (uint16_t layer = 0; layer < layerAmount; ++layer)
+            {
+                bgfx::Attachment attach;
+                attach.init(_tex->getHandle(), bgfx::Access::Write, layer);
+                _layerFbs.emplace_back(bgfx::createFrameBuffer(1, &attach));
+            }
+        }
+        _atlas.reset(layerAmount, getMaxTileLevel());
+        _lightTiles.clear();
+        _dirLightCascades.clear();
+
         for (auto& pass : _passes)
         {
             pass.shutdown();
@@ -290,7 +543,7 @@ namespace darmok
         for (uint16_t index = 0; index < _def.max_pass_amount(); ++index)
         {
             auto& pass = _passes.emplace_back();
-            pass.init(*this, index);
+            pass.init(*this);
         }
 
         return {};
@@ -303,6 +556,11 @@ namespace darmok
             pass.shutdown();
         }
         _passes.clear();
+        _lights.clear();
+        _lightTiles.clear();
+        _dirLightCascades.clear();
+        _layerFbs.clear();
+        _tex.reset();
         _shadowMapUniform.reset();
         _shadowData1Uniform.reset();
         _shadowData2Uniform.reset();
@@ -320,11 +578,22 @@ namespace darmok
     {
         updateLights();
         updateCamera();
+        updateCasters();
+        updateDirLightCascades();
         updateBuffers();
+        ++_frameCount;
 
         return {};
     }
 
+    void ShadowRenderer::invalidateCache() noexcept
+    {
+        for (auto& pass : _passes)
+        {
+            pass.invalidate();
+        }
+    }
+
     bool ShadowRenderer::isEnabled() const noexcept
     {
         return _cam && _cam->isEnabled();
@@ -332,6 +601,48 @@ namespace darmok
 
     const size_t ShadowRenderer::_pointLightFaceAmount = 6;
 
+    uint16_t ShadowRenderer::getLayerAmount() const noexcept
+    {
+        // definitions without atlas configuration use a full layer per pass
+        if (_def.layer_amount() == 0)
+        {
+            return static_cast<uint16_t>(_def.max_pass_amount());
+        }
+        return static_cast<uint16_t>(_def.layer_amount());
+    }
+
+    uint8_t ShadowRenderer::getMaxTileLevel() const noexcept
+    {
+        return static_cast<uint8_t>(std::min(_def.max_tile_level(), 8U));
+    }
+
+    size_t ShadowRenderer::getLightPassAmount(ShadowLightType type) const noexcept
+    {
+        switch (type)
+        {
+        case ShadowLightType::Dir:
+            return _def.cascade_amount();
+        case ShadowLightType::Point:
+            return _pointLightFaceAmount;
+        default:
+            return 1;
+        }
+    }
+
+    const ShadowAtlas& ShadowRenderer::getAtlas() const noexcept
+    {
+        return _atlas;
+    }
+
+    bgfx::FrameBufferHandle ShadowRenderer::getLayerFrameBuffer(uint16_t layer) const noexcept
+    {
+        if (layer >= _layerFbs.size())
+        {
+            return { bgfx::kInvalidHandle };
+        }
+        return _layerFbs[layer].get();
+    }
+
     void ShadowRenderer::updateLights() noexcept
     {
         if (!_cam || !_scene)
@@ -339,67 +650,219 @@ namespace darmok
             return;
         }
 
+        collectLights();
+        allocateTiles();
+
         size_t passIdx = 0;
         _dirAmount = 0;
         _spotAmount = 0;
         _pointAmount = 0;
 
-        auto configurePasses = [this, &passIdx](Entity entity, size_t passAmount) -> bool
+        for (auto& light : _lights)
         {
-            if (passIdx > _passes.size() - passAmount)
+            for (uint8_t part = 0; part < light.tiles.size(); ++part)
             {
-                return false;
+                _passes[passIdx].configure(light.entity, part, light.tiles[part]);
+                ++passIdx;
             }
-            for (auto i = 0; i < passAmount; ++i)
+            switch (light.lightType)
             {
-                _passes[passIdx].configure(entity, i);
-                ++passIdx;
+            case ShadowLightType::Dir:
+                ++_dirAmount;
+                break;
+            case ShadowLightType::Spot:
+                ++_spotAmount;
+                break;
+            case ShadowLightType::Point:
+                ++_pointAmount;
+                break;
             }
-            return true;
+        }
+        for (; passIdx < _passes.size(); ++passIdx)
+        {
+            _passes[passIdx].configure();
+        }
+    }
+
+    void ShadowRenderer::collectLights() noexcept
+    {
+        _lights.clear();
+
+        glm::vec3 camPos{ 0.F };
+        if (auto camTrans = _cam->getTransform())
+        {
+            camPos = camTrans->getWorldPosition();
+        }
+
+        // the range of the light compared to its distance to the camera
+        // approximates how much of the screen the light can affect
+        auto getCoverage = [this, &camPos](Entity entity, float range)
+        {
+            glm::vec3 pos{ 0.F };
+            if (auto trans = _scene->getComponent<const Transform>(entity))
+            {
+                pos = trans->getWorldPosition();
+            }
+            auto dist = std::max(glm::distance(camPos, pos), _def.near_plane());
+            return range / dist;
+        };
+
+        // each halving of the coverage halves the tile size
+        auto maxLevel = getMaxTileLevel();
+        auto getLevel = [maxLevel](float coverage) -> uint8_t
+        {
+            if (coverage >= 1.F)
+            {
+                return 0;
+            }
+            auto level = std::floor(-std::log2(std::max(coverage, std::numeric_limits<float>::min())));
+            return static_cast<uint8_t>(std::min(level, static_cast<float>(maxLevel)));
         };
 
         for (auto entity : _cam->getEntities<DirectionalLight>())
         {
             auto light = _scene->getComponent<const DirectionalLight>(entity);
-            if (light->getShadowType() == LightDefinition::NoShadow)
+            auto shadowType = light->getShadowType();
+            if (shadowType == LightDefinition::NoShadow)
             {
                 continue;
             }
-            if (!configurePasses(entity, _def.cascade_amount()))
-            {
-                break;
-            }
-            ++_dirAmount;
+            _lights.push_back({ entity, ShadowLightType::Dir, shadowType, std::numeric_limits<float>::max(), 0 });
         }
         for (auto entity : _cam->getEntities<SpotLight>())
         {
             auto light = _scene->getComponent<const SpotLight>(entity);
-            if (light->getShadowType() == LightDefinition::NoShadow)
+            auto shadowType = light->getShadowType();
+            if (shadowType == LightDefinition::NoShadow)
             {
                 continue;
             }
-            if (!configurePasses(entity, 1))
-            {
-                break;
-            }
-            ++_spotAmount;
+            auto coverage = getCoverage(entity, light->getRange());
+            _lights.push_back({ entity, ShadowLightType::Spot, shadowType, light->getIntensity() * coverage, getLevel(coverage) });
         }
         for (auto entity : _cam->getEntities<PointLight>())
         {
             auto light = _scene->getComponent<const PointLight>(entity);
-            if (light->getShadowType() == LightDefinition::NoShadow)
+            auto shadowType = light->getShadowType();
+            if (shadowType == LightDefinition::NoShadow)
             {
                 continue;
             }
-            if (!configurePasses(entity, _pointLightFaceAmount))
+            auto coverage = getCoverage(entity, light->getRange());
+            _lights.push_back({ entity, ShadowLightType::Point, shadowType, light->getIntensity() * coverage, getLevel(coverage) });
+        }
+
+        std::stable_sort(_lights.begin(), _lights.end(), [](const LightShadow& a, const LightShadow& b)
+        {
+            return a.importance > b.importance;
+        });
+
+        // the least important lights are dropped if there are not enough passes
+        size_t passAmount = 0;
+        auto end = std::remove_if(_lights.begin(), _lights.end(), [this, &passAmount](const LightShadow& light)
+        {
+            auto amount = getLightPassAmount(light.lightType);
+            if (passAmount + amount > _passes.size())
+            {
+                return true;
+            }
+            passAmount += amount;
+            return false;
+        });
+        _lights.erase(end, _lights.end());
+    }
+
+    void ShadowRenderer::allocateTiles() noexcept
+    {
+        _atlas.clear();
+
+        auto reserveTiles = [this](LightShadow& light, const std::vector<ShadowAtlasTile>& tiles)
+        {
+            if (tiles.size() != getLightPassAmount(light.lightType))
+            {
+                return false;
+            }
+            for (size_t i = 0; i < tiles.size(); ++i)
             {
-                break;
+                if (!_atlas.reserve(tiles[i]))
+                {
+                    for (size_t j = 0; j < i; ++j)
+                    {
+                        _atlas.release(tiles[j]);
+                    }
+                    return false;
+                }
+            }
+            light.tiles = tiles;
+            return true;
+        };
+
+        auto findPrevTiles = [this](const LightShadow& light) -> OptionalRef<const std::vector<ShadowAtlasTile>>
+        {
+            auto itr = _lightTiles.find(light.entity);
+            if (itr == _lightTiles.end() || itr->second.empty())
+            {
+                return nullptr;
+            }
+            return itr->second;
+        };
+
+        // lights that keep their level keep their tiles so their cached maps stay valid
+        for (auto& light : _lights)
+        {
+            auto prevTiles = findPrevTiles(light);
+            if (prevTiles && prevTiles->front().level == light.level)
+            {
+                reserveTiles(light, prevTiles.value());
             }
-            ++_pointAmount;
         }
-        for (; passIdx < _passes.size(); ++passIdx)
+
+        // the rest get the biggest tiles that fit, starting from their desired level
+        auto maxLevel = _atlas.getMaxLevel();
+        for (auto& light : _lights)
         {
-            _passes[passIdx].configure();
+            if (!light.tiles.empty())
+            {
+                continue;
+            }
+            auto prevTiles = findPrevTiles(light);
+            auto amount = getLightPassAmount(light.lightType);
+            for (auto level = light.level; level <= maxLevel && light.tiles.empty(); ++level)
+            {
+                if (prevTiles && prevTiles->front().level == level && reserveTiles(light, prevTiles.value()))
+                {
+                    break;
+                }
+                for (size_t i = 0; i < amount; ++i)
+                {
+                    auto tile = _atlas.allocate(level);
+                    if (!tile)
+                    {
+                        break;
+                    }
+                    light.tiles.push_back(tile.value());
+                }
+                if (light.tiles.size() < amount)
+                {
+                    for (auto& tile : light.tiles)
+                    {
+                        _atlas.release(tile);
+                    }
+                    light.tiles.clear();
+                }
+            }
+        }
+
+        auto end = std::remove_if(_lights.begin(), _lights.end(), [](const LightShadow& light)
+        {
+            return light.tiles.empty();
+        });
+        _lights.erase(end, _lights.end());
+
+        _lightTiles.clear();
+        for (auto& light : _lights)
+        {
+            _lightTiles.emplace(light.entity, light.tiles);
         }
     }
 
@@ -422,6 +885,8 @@ namespace darmok
         };
 
         _camProjs.clear();
+        _cascadeSpheres.clear();
+        auto camWorld = glm::inverse(view);
         auto margin = _def.cascade_margin();
         for (auto casc = 0; casc < _def.cascade_amount(); ++casc)
         {
@@ -434,6 +899,11 @@ namespace darmok
             auto cascProj = cascFrust.getAlignedProjectionMatrix();
             cascProj *= view;
             _camProjs.emplace_back(cascProj);
+
+            // the radius only depends on the projection so it does not change when the camera moves
+            auto sphere = cascFrust.getBoundingSphere();
+            sphere.origin = camWorld * glm::vec4{ sphere.origin, 1.F };
+            _cascadeSpheres.push_back(sphere);
         }
     }
 
@@ -442,13 +912,6 @@ namespace darmok
         return (_dirAmount * _def.cascade_amount()) + _spotAmount + (_pointAmount * _pointLightFaceAmount);
     }
 
-    enum class ShadowLightType
-    {
-        Dir,
-        Spot,
-        Point
-    };
-
     void ShadowRenderer::updateBuffers() noexcept
     {
         auto amount = static_cast<uint32_t>(getShadowMapAmount());
@@ -457,8 +920,8 @@ namespace darmok
 
         uint32_t index = 0;
 
-        auto addElement = [&transWriter, &lightDataWriter, &index]
-            (Entity entity, const glm::mat4& mtx, ShadowLightType lightType, ShadowType shadowType)
+        auto addElement = [this, &transWriter, &lightDataWriter, &index]
+            (const LightShadow& light, const glm::mat4& mtx, const ShadowAtlasTile& tile)
         {
             // not sure why but the shader reads the data by rows
             // TODO: try to set trans buffer type to mat4
@@ -468,54 +931,36 @@ namespace darmok
             transWriter.write(bgfx::Attrib::Color2, index, tmtx[2]);
             transWriter.write(bgfx::Attrib::Color3, index, tmtx[3]);
 
-            const glm::vec4 lightData{ entity, lightType, toUnderlying(shadowType), 0.f };
+            const glm::vec4 lightData{ light.entity, light.lightType, toUnderlying(light.shadowType), 0.f };
             lightDataWriter.write(bgfx::Attrib::Color0, index, lightData);
+            const glm::vec4 tileData{ _atlas.getRect(tile), tile.layer };
+            lightDataWriter.write(bgfx::Attrib::Color1, index, tileData);
 
             ++index;
         };
 
-        for (auto entity : _cam->getEntities<DirectionalLight>())
-        {
-            auto light = _scene->getComponent<const DirectionalLight>(entity);
-            auto shadowType = light->getShadowType();
-            if (shadowType == LightDefinition::NoShadow)
-            {
-                continue;
-            }
-            auto lightTrans = _scene->getComponent<const Transform>(entity);
-            for (auto casc = 0; casc < _def.cascade_amount(); ++casc)
-            {
-                auto mtx = getDirLightMapMatrix(lightTrans, casc);
-                addElement(entity, mtx, ShadowLightType::Dir, shadowType);
-            }
-        }
-
-        for (auto entity : _cam->getEntities<SpotLight>())
-        {
-            auto light = _scene->getComponent<const SpotLight>(entity);
-            auto shadowType = light->getShadowType();
-            if (shadowType == LightDefinition::NoShadow)
-            {
-                continue;
-            }
-            auto lightTrans = _scene->getComponent<const Transform>(entity);
-            auto mtx = getSpotLightMapMatrix(light.value(), lightTrans);
-            addElement(entity, mtx, ShadowLightType::Spot, shadowType);
-        }
-
-        for (auto entity : _cam->getEntities<PointLight>())
+        // same order as the passes
+        for (auto& light : _lights)
         {
-            auto light = _scene->getComponent<const PointLight>(entity);
-            auto shadowType = light->getShadowType();
-            if (shadowType == LightDefinition::NoShadow)
-            {
-                continue;
-            }
-            auto lightTrans = _scene->getComponent<const Transform>(entity);
-            for (auto face = 0; face < _pointLightFaceAmount; ++face)
+            auto lightTrans = _scene->getComponent<const Transform>(light.entity);
+            for (uint8_t part = 0; part < light.tiles.size(); ++part)
             {
-                auto mtx = getPointLightMapMatrix(light.value(), lightTrans, face);
-                addElement(entity, mtx, ShadowLightType::Point, shadowType);
+                glm::mat4 mtx{ 1.F };
+                if (light.lightType == ShadowLightType::Dir)
+                {
+                    mtx = getDirLightMapMatrix(light.entity, part);
+                }
+                else if (light.lightType == ShadowLightType::Spot)
+                {
+                    auto spotLight = _scene->getComponent<const SpotLight>(light.entity);
+                    mtx = getSpotLightMapMatrix(spotLight.value(), lightTrans);
+                }
+                else
+                {
+                    auto pointLight = _scene->getComponent<const PointLight>(light.entity);
+                    mtx = getPointLightMapMatrix(pointLight.value(), lightTrans, part);
+                }
+                addElement(light, mtx, light.tiles[part]);
             }
         }
 
@@ -588,28 +1033,179 @@ namespace darmok
         return _camProjs[cascade % _camProjs.size()];
     }
 
-    glm::mat4 ShadowRenderer::getDirLightProjMatrix(const OptionalRef<const Transform>& lightTrans, uint8_t cascade) const noexcept
+    const Sphere& ShadowRenderer::getCascadeSphere(uint8_t cascade) const noexcept
     {
-        auto mtx = getCameraProjMatrix(cascade);
-        if (lightTrans)
+        if (_cascadeSpheres.empty())
+        {
+            return Sphere::standard();
+        }
+        return _cascadeSpheres[cascade % _cascadeSpheres.size()];
+    }
+
+    uint32_t ShadowRenderer::getCascadeUpdateInterval(uint8_t cascade) const noexcept
+    {
+        if (cascade >= _def.cascade_update_intervals_size())
         {
-            mtx *= lightTrans->getWorldMatrix();
+            return 1;
+        }
+        return std::max(_def.cascade_update_intervals(cascade), 1U);
+    }
+
+    void ShadowRenderer::updateDirLightCascades() noexcept
+    {
+        auto mapSize = _def.map_size();
+        for (auto& light : _lights)
+        {
+            if (light.lightType != ShadowLightType::Dir)
+            {
+                continue;
+            }
+            auto& cascades = _dirLightCascades[light.entity];
+            cascades.resize(light.tiles.size(), { glm::mat4{ 0.F } });
+            for (uint8_t casc = 0; casc < light.tiles.size(); ++casc)
+            {
+                auto& cascade = cascades[casc];
+                auto& tile = light.tiles[casc];
+
+                // far cascades can keep the projection of a previous frame
+                // their pass is cached if the casters did not move
+                auto interval = getCascadeUpdateInterval(casc);
+                auto valid = cascade.tile == tile && cascade.proj != glm::mat4{ 0.F };
+                if (valid && interval > 1 && ((_frameCount + casc) % interval) != 0)
+                {
+                    continue;
+                }
+                auto tileSize = _atlas.getViewport(tile, mapSize).z;
+                cascade.proj = calcDirLightProjMatrix(light.entity, casc, tileSize, true);
+                cascade.tile = tile;
+            }
+        }
+        std::erase_if(_dirLightCascades, [this](auto& elm)
+        {
+            return std::none_of(_lights.begin(), _lights.end(), [&elm](auto& light) { return light.entity == elm.first; });
+        });
+    }
+
+    glm::mat4 ShadowRenderer::calcDirLightProjMatrix(Entity entity, uint8_t cascade, uint32_t mapSize, bool fitCasters) const noexcept
+    {
+        OptionalRef<const Transform> lightTrans;
+        if (_scene)
+        {
+            lightTrans = _scene->getComponent<const Transform>(entity);
+        }
+        auto& sphere = getCascadeSphere(cascade);
+        glm::vec3 center = getLightViewMatrix(lightTrans) * glm::vec4{ sphere.origin, 1.F };
+        auto radius = sphere.radius;
+
+        // the sphere keeps the size of the map constant when the camera rotates
+        // snapping its center to the texels stops the shadow edges from shimmering when it moves
+        auto texelSize = 2.F * radius / static_cast<float>(std::max(mapSize, 1U));
+        if (texelSize > 0.F)
+        {
+            center.x = std::floor(center.x / texelSize) * texelSize;
+            center.y = std::floor(center.y / texelSize) * texelSize;
+        }
+
+        BoundingBox bb{ center - glm::vec3{ radius }, center + glm::vec3{ radius } };
+
+        // receivers in front of the first caster are not shadowed
+        // so the near plane can move to it to improve the depth precision
+        if (fitCasters)
+        {
+            if (auto casterNear = getCasterNearDepth(lightTrans, bb))
+            {
+                bb.min.z = casterNear.value();
+            }
         }
-        auto bb = Frustum{ mtx }.getBoundingBox();
-        bb.snap(_def.map_size());
         return bb.getOrtho();
     }
 
-    glm::mat4 ShadowRenderer::getDirLightMatrix(const OptionalRef<const Transform>& lightTrans, uint8_t cascade) const noexcept
+    std::optional<float> ShadowRenderer::getCasterNearDepth(const OptionalRef<const Transform>& lightTrans, const BoundingBox& lightBounds) const noexcept
     {
-        auto proj = getDirLightProjMatrix(lightTrans, cascade);
-        auto view = getLightViewMatrix(lightTrans);
-        return proj * view;
+        auto lightView = getLightViewMatrix(lightTrans);
+        std::optional<float> near;
+        auto addBounds = [&lightBounds, &near](const BoundingBox& bounds)
+        {
+            if (bounds.max.x < lightBounds.min.x || bounds.min.x > lightBounds.max.x
+                || bounds.max.y < lightBounds.min.y || bounds.min.y > lightBounds.max.y
+                || bounds.min.z > lightBounds.max.z)
+            {
+                return;
+            }
+            near = std::min(near.value_or(bounds.min.z), bounds.min.z);
+        };
+
+        for (auto& bounds : _casterBounds)
+        {
+            // casters without bounds could be anywhere
+            if (!bounds)
+            {
+                return std::nullopt;
+            }
+            addBounds(bounds.value() * lightView);
+        }
+
+        if (_tree && _scene)
+        {
+            // light column of the cascade without the near plane
+            auto lightWorld = lightTrans ? lightTrans->getWorldMatrix() : glm::mat4{ 1.F };
+            std::array<Plane, 5> planes{
+                Plane{ glm::vec3{ -1.F, 0.F, 0.F }, -lightBounds.min.x },
+                Plane{ glm::vec3{ 1.F, 0.F, 0.F }, lightBounds.max.x },
+                Plane{ glm::vec3{ 0.F, -1.F, 0.F }, -lightBounds.min.y },
+                Plane{ glm::vec3{ 0.F, 1.F, 0.F }, lightBounds.max.y },
+                Plane{ glm::vec3{ 0.F, 0.F, 1.F }, lightBounds.max.z },
+            };
+            for (auto& plane : planes)
+            {
+                plane *= lightWorld;
+            }
+            std::vector<Entity> entities;
+            _tree->getTree().query(planes, entities);
+            for (auto entity : entities)
+            {
+                if (!isTreeCaster(entity))
+                {
+                    continue;
+                }
+                if (auto bounds = CullingUtils::getEntityBounds(_scene.value(), entity))
+                {
+                    auto mtx = lightView;
+                    if (auto trans = _scene->getComponentInParent<const Transform>(entity))
+                    {
+                        mtx *= trans->getWorldMatrix();
+                    }
+                    addBounds(bounds.value() * mtx);
+                }
+            }
+        }
+        return near;
+    }
+
+    glm::mat4 ShadowRenderer::getDirLightProjMatrix(Entity entity, uint8_t cascade) const noexcept
+    {
+        auto itr = _dirLightCascades.find(entity);
+        if (itr != _dirLightCascades.end() && cascade < itr->second.size())
+        {
+            return itr->second[cascade].proj;
+        }
+        return calcDirLightProjMatrix(entity, cascade, _def.map_size(), false);
+    }
+
+    glm::mat4 ShadowRenderer::getDirLightMatrix(Entity entity, uint8_t cascade) const noexcept
+    {
+        auto proj = getDirLightProjMatrix(entity, cascade);
+        OptionalRef<const Transform> lightTrans;
+        if (_scene)
+        {
+            lightTrans = _scene->getComponent<const Transform>(entity);
+        }
+        return proj * getLightViewMatrix(lightTrans);
     }
 
-    glm::mat4 ShadowRenderer::getDirLightMapMatrix(const OptionalRef<const Transform>& lightTrans, uint8_t cascade) const noexcept
+    glm::mat4 ShadowRenderer::getDirLightMapMatrix(Entity entity, uint8_t cascade) const noexcept
     {
-        return _crop * getDirLightMatrix(lightTrans, cascade);
+        return _crop * getDirLightMatrix(entity, cascade);
     }
 
     glm::mat4 ShadowRenderer::getSpotLightMatrix(const SpotLight& light, const OptionalRef<const Transform>& lightTrans) const noexcept
@@ -666,16 +1262,108 @@ namespace darmok
         return viewId;
     }
 
+    void ShadowRenderer::updateCasters() noexcept
+    {
+        _casters.clear();
+        _casterBounds.clear();
+        std::fill(_treeCasters.begin(), _treeCasters.end(), 0);
+        _tree.reset();
+        if (!_cam || !_scene || _lights.empty())
+        {
+            return;
+        }
+        if (auto tree = _scene->getSceneComponent<SceneBoundsTree>())
+        {
+            // scene components do not update while paused
+            tree->refit();
+            _tree = tree.value();
+        }
+        for (auto entity : _cam->getEntities<Renderable>())
+        {
+            auto renderable = _scene->getComponent<const Renderable>(entity);
+            if (!renderable->valid())
+            {
+                continue;
+            }
+            if (!renderable->isShadowCaster() || renderable->getMaterial()->primitiveType == Material::Definition::Line)
+            {
+                continue;
+            }
+            if (_tree && _tree->contains(entity))
+            {
+                auto index = static_cast<size_t>(entt::to_entity(entity));
+                if (index / 64 >= _treeCasters.size())
+                {
+                    _treeCasters.resize((index / 64) + 1, 0);
+                }
+                _treeCasters[index / 64] |= uint64_t{ 1 } << (index % 64);
+                continue;
+            }
+            _casters.push_back(entity);
+
+            // calculated once for all the passes
+            auto& bounds = _casterBounds.emplace_back(CullingUtils::getEntityBounds(_scene.value(), entity));
+            if (bounds)
+            {
+                if (auto trans = _scene->getComponentInParent<const Transform>(entity))
+                {
+                    bounds = bounds.value() * trans->getWorldMatrix();
+                }
+            }
+        }
+    }
+
+    const std::vector<Entity>& ShadowRenderer::getCasters() const noexcept
+    {
+        return _casters;
+    }
+
+    const std::vector<std::optional<BoundingBox>>& ShadowRenderer::getCasterBounds() const noexcept
+    {
+        return _casterBounds;
+    }
+
+    bool ShadowRenderer::isTreeCaster(Entity entity) const noexcept
+    {
+        auto index = static_cast<size_t>(entt::to_entity(entity));
+        return index / 64 < _treeCasters.size() && ((_treeCasters[index / 64] >> (index % 64)) & 1) != 0;
+    }
+
+    OptionalRef<const SceneBoundsTree> ShadowRenderer::getBoundsTree() const noexcept
+    {
+        return _tree;
+    }
+
     expected<void, std::string> ShadowRenderer::render() noexcept
     {
-        auto encoder = bgfx::begin();
+        // view configuration needs to happen on the main thread
+        _activePasses.clear();
         for (auto& pass : _passes)
         {
-            pass.render(*encoder);
+            if (pass.prepare())
+            {
+                _activePasses.push_back(pass);
+            }
         }
+        if (_activePasses.empty())
+        {
+            return {};
+        }
+
+        // each pass (cascade, spot light or point light face) is recorded in its own task
+        auto encoder = bgfx::begin();
+        auto result = RenderParallelUtils::record(_app->getTaskExecutor(), *encoder, _activePasses.size(),
+            [this](bgfx::Encoder& encoder, size_t start, size_t end) -> expected<void, std::string>
+            {
+                for (auto i = start; i < end; ++i)
+                {
+                    _activePasses[i].get().render(encoder);
+                }
+                return {};
+            }, 1);
         bgfx::end(encoder);
 
-        return {};
+        return result;
     }
 
     expected<void, std::string> ShadowRenderer::beforeRenderEntity(Entity entity, bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept
@@ -763,7 +1451,7 @@ namespace darmok
             auto lightTrans = _scene->getComponent<const Transform>(entity);
             for (auto casc = 0; casc < cascadeAmount; ++casc)
             {
-                auto mtx = renderer->getDirLightMatrix(lightTrans, casc);
+                auto mtx = renderer->getDirLightMatrix(entity, casc);
                 meshData += MeshData{ Frustum{mtx}, Mesh::Definition::FillOutline };
             }
 
@@ -4,6 +4,7 @@
 #include <darmok/glm_serialize.hpp>
 
 #include <cmath>
+#include <algorithm>
 
 #include <glm/ext/matrix_projection.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
@@ -11,6 +12,7 @@
 #include <glm/gtx/string_cast.hpp>
 #include <glm/gtx/matrix_operation.hpp>
 #include <glm/gtx/norm.hpp>
+#include <glm/gtx/component_wise.hpp>
 #include <fmt/format.h>
 #include <bx/bx.h>
 #include <bgfx/bgfx.h>
@@ -619,6 +621,21 @@ namespace darmok
         return std::nullopt;
     }
 
+    std::optional<float> Ray::intersect(const BoundingBox& bbox) const noexcept
+    {
+        // slab test, divisions by zero result in infinities that are handled by min/max
+        auto invDir = 1.F / direction;
+        auto t1 = (bbox.min - origin) * invDir;
+        auto t2 = (bbox.max - origin) * invDir;
+        auto tmin = glm::compMax(glm::min(t1, t2));
+        auto tmax = glm::compMin(glm::max(t1, t2));
+        if (tmax < 0.F || tmin > tmax)
+        {
+            return std::nullopt;
+        }
+        return std::max(tmin, 0.F);
+    }
+
     Ray Ray::unproject(const glm::vec2& screenPosition, const glm::mat4& model, const glm::mat4& proj, const Viewport& viewport) noexcept
     {
         auto near = glm::unProject(glm::vec3(screenPosition, 0), model, proj, viewport.getValues());
@@ -1287,6 +1304,45 @@ namespace darmok
         return bb;
     }
 
+    Sphere Frustum::getBoundingSphere() const noexcept
+    {
+        static const size_t planeCorners = 4;
+        glm::vec3 nearCenter{ 0.F };
+        glm::vec3 farCenter{ 0.F };
+        for (size_t i = 0; i < planeCorners; ++i)
+        {
+            nearCenter += corners[i];
+            farCenter += corners[i + planeCorners];
+        }
+        nearCenter /= static_cast<float>(planeCorners);
+        farCenter /= static_cast<float>(planeCorners);
+
+        float nearDist2 = 0.F;
+        float farDist2 = 0.F;
+        for (size_t i = 0; i < planeCorners; ++i)
+        {
+            nearDist2 = std::max(nearDist2, glm::distance2(corners[i], nearCenter));
+            farDist2 = std::max(farDist2, glm::distance2(corners[i + planeCorners], farCenter));
+        }
+
+        // the center along the axis is at the same distance of the near and far corners
+        auto axis = farCenter - nearCenter;
+        auto len = glm::length(axis);
+        auto center = nearCenter;
+        if (len > 0.F)
+        {
+            auto dist = ((farDist2 - nearDist2) / (2.F * len)) + (len * 0.5F);
+            center += axis * (std::clamp(dist, 0.F, len) / len);
+        }
+
+        float radius2 = 0.F;
+        for (auto& corner : corners)
+        {
+            radius2 = std::max(radius2, glm::distance2(corner, center));
+        }
+        return { std::sqrt(radius2), center };
+    }
+
     glm::vec3 Frustum::getCenter() const noexcept
     {
         glm::vec3 center = glm::vec3(0.0f);
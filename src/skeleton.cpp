@@ -13,9 +13,17 @@
 #include <darmok/glm_serialize.hpp>
 #include <darmok/scene_serialize.hpp>
 #include <darmok/asset_pack.hpp>
+#include <darmok/app.hpp>
+#include <darmok/camera.hpp>
+#include "detail/render_samplers.hpp"
 
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/vector_angle.hpp>
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+#include <algorithm>
+#include <limits>
 
 
 namespace darmok
@@ -150,47 +158,307 @@ namespace darmok
     }
 
 
+    const size_t SkeletalAnimationSceneComponent::_minParallelUpdates = 16;
+
+    SkeletalAnimationSceneComponent::SkeletalAnimationSceneComponent(const Definition& def) noexcept
+        : _def{ def }
+        , _frameCount{ 0 }
+        , _skinningSize{ 0 }
+    {
+        _skinningLayout.begin()
+            .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Float)
+        .end();
+    }
+
     expected<void, std::string> SkeletalAnimationSceneComponent::init(Scene& scene, App& app) noexcept
     {
         _scene = scene;
+        _app = app;
+        _frameCount = 0;
+        _skinningSize = 0;
+        _skinningBuffer = { 1, _skinningLayout, BGFX_BUFFER_COMPUTE_READ | BGFX_BUFFER_ALLOW_RESIZE };
 		return {};
     }
 
+    expected<void, std::string> SkeletalAnimationSceneComponent::shutdown() noexcept
+    {
+        _scene.reset();
+        _app.reset();
+        _skinningBuffer.reset();
+        _poseUpdates.clear();
+        _skinnables.clear();
+        _skinningUpdates.clear();
+        _animatorsVisible.clear();
+        return {};
+    }
+
+    void SkeletalAnimationSceneComponent::updateVisibility() noexcept
+    {
+        _cameraPositions.clear();
+        for (auto entity : _scene->getUpdateEntities<Camera>())
+        {
+            auto& cam = _scene->getComponent<const Camera>(entity).value();
+            if (!cam.isEnabled())
+            {
+                continue;
+            }
+            auto trans = cam.getTransform();
+            _cameraPositions.push_back(trans ? trans->getWorldPosition() : glm::vec3{ 0 });
+        }
+
+        _animatorsVisible.clear();
+        if (!_def.skip_culled() || _cameraPositions.empty())
+        {
+            return;
+        }
+        // cameras are updated before the scene components so their culling is current
+        for (auto entity : _scene->getEntities<Skinnable>())
+        {
+            auto animator = _scene->getComponentInParent<const SkeletalAnimator>(entity);
+            if (!animator)
+            {
+                continue;
+            }
+            auto& visible = _animatorsVisible[animator.ptr()];
+            if (visible)
+            {
+                continue;
+            }
+            for (auto camEntity : _scene->getUpdateEntities<Camera>())
+            {
+                auto& cam = _scene->getComponent<const Camera>(camEntity).value();
+                if (cam.isEnabled() && !cam.shouldEntityBeCulled(entity))
+                {
+                    visible = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    SkeletalAnimationSceneComponent::PoseUpdate SkeletalAnimationSceneComponent::createPoseUpdate(Entity entity, SkeletalAnimator& animator) const noexcept
+    {
+        PoseUpdate update{ animator };
+
+        // animators without skinned meshes can be used for attachments so they are never skipped
+        auto itr = _animatorsVisible.find(&animator);
+        if (itr != _animatorsVisible.end() && !itr->second)
+        {
+            update.sample = false;
+            return update;
+        }
+        if (_def.lods_size() == 0 || _cameraPositions.empty())
+        {
+            return update;
+        }
+
+        glm::vec3 pos{ 0 };
+        if (auto trans = _scene->getComponent<const Transform>(entity))
+        {
+            pos = trans->getWorldPosition();
+        }
+        auto dist = std::numeric_limits<float>::max();
+        for (auto& camPos : _cameraPositions)
+        {
+            dist = std::min(dist, glm::distance(pos, camPos));
+        }
+
+        OptionalRef<const protobuf::SkeletalAnimationLod> lod;
+        for (auto& lodDef : _def.lods())
+        {
+            if (dist < lodDef.distance())
+            {
+                break;
+            }
+            lod = lodDef;
+        }
+        if (!lod || lod->update_interval() <= 1)
+        {
+            return update;
+        }
+
+        // the entity index staggers the samples of the animators with the same interval
+        auto interval = lod->update_interval();
+        auto step = (_frameCount + entt::to_entity(entity)) % interval;
+        update.sample = step == 0;
+        if (lod->interpolate())
+        {
+            update.interpolation = static_cast<float>(step) / static_cast<float>(interval);
+        }
+        return update;
+    }
+
     expected<void, std::string> SkeletalAnimationSceneComponent::update(float deltaTime) noexcept
     {
         if (!_scene)
         {
             return unexpected<std::string>{"scene not loaded"};
         }
-        auto entities = _scene->getUpdateEntities<SkeletalAnimator>();
-        std::vector<OptionalRef<RenderableSkeleton>> skeletons;
-        for (auto entity : entities)
+
+        updateVisibility();
+        _poseUpdates.clear();
+        for (auto entity : _scene->getUpdateEntities<SkeletalAnimator>())
         {
-            auto& anim = _scene->getComponent<SkeletalAnimator>(entity).value();
-            auto updateResult = anim.update(deltaTime);
-            if (!updateResult)
+            auto& animator = _scene->getComponent<SkeletalAnimator>(entity).value();
+            _poseUpdates.push_back(createPoseUpdate(entity, animator));
+        }
+        ++_frameCount;
+
+        OptionalRef<tf::Executor> executor;
+        if (_app)
+        {
+            executor = _app->getTaskExecutor();
+        }
+
+        // sampling, blending and local to model jobs of each animator in its own task
+        if (executor && _poseUpdates.size() >= _minParallelUpdates)
+        {
+            tf::Taskflow taskflow{ "SkeletalAnimationPoses" };
+            taskflow.for_each(_poseUpdates.begin(), _poseUpdates.end(), [deltaTime](PoseUpdate& update)
             {
-                return updateResult;
+                update.result = update.animator.get().updatePose(deltaTime, update.sample, update.interpolation);
+            });
+            executor->run(taskflow).wait();
+        }
+        else
+        {
+            for (auto& update : _poseUpdates)
+            {
+                update.result = update.animator.get().updatePose(deltaTime, update.sample, update.interpolation);
             }
+        }
+
+        // listeners can modify the scene so they are called from the main thread
+        for (auto& update : _poseUpdates)
+        {
+            if (!update.result)
+            {
+                return update.result;
+            }
+            update.animator.get().updateEvents();
+        }
+
+        std::vector<OptionalRef<RenderableSkeleton>> skeletons;
+        for (auto entity : _scene->getUpdateEntities<SkeletalAnimator>())
+        {
             skeletons.clear();
-            auto matrixes = anim.getJointModelMatrixes();
             _scene->getComponentsInChildren<RenderableSkeleton>(entity, skeletons);
+            if (skeletons.empty())
+            {
+                continue;
+            }
+            auto& anim = _scene->getComponent<const SkeletalAnimator>(entity).value();
+            auto matrixes = anim.getJointModelMatrixes();
             for (auto& skel : skeletons)
             {
                 skel->update(_scene.value(), matrixes);
             }
         }
+
+        updateSkinning();
         return {};
     }
 
+    void SkeletalAnimationSceneComponent::updateSkinning() noexcept
+    {
+        if (!_scene)
+        {
+            return;
+        }
+
+        // the skinning is calculated once per frame and shared by all the cameras and passes
+        _skinningUpdates.clear();
+        _skinnables.clear();
+        uint32_t size = 0;
+        auto changed = false;
+        for (auto entity : _scene->getEntities<Skinnable>())
+        {
+            auto animator = _scene->getComponentInParent<const SkeletalAnimator>(entity);
+            if (!animator)
+            {
+                continue;
+            }
+            auto& skinnable = _scene->getComponent<Skinnable>(entity).value();
+            _skinnables.emplace_back(skinnable);
+            if (!skinnable.isSkinningUpdated(animator.value()))
+            {
+                _skinningUpdates.push_back({ skinnable, animator.value() });
+            }
+            if (skinnable.getSkinningOffset() != size)
+            {
+                skinnable.setSkinningOffset(size);
+                changed = true;
+            }
+            size += 1;
+            if (auto armature = skinnable.getArmature())
+            {
+                size += static_cast<uint32_t>(armature->getJoints().size());
+            }
+        }
+        if (_skinningUpdates.empty() && !changed && size == _skinningSize)
+        {
+            return;
+        }
+
+        OptionalRef<tf::Executor> executor;
+        if (_app)
+        {
+            executor = _app->getTaskExecutor();
+        }
+        if (executor && _skinningUpdates.size() >= _minParallelUpdates)
+        {
+            tf::Taskflow taskflow{ "SkeletalAnimationSkinning" };
+            taskflow.for_each(_skinningUpdates.begin(), _skinningUpdates.end(), [](const SkinningUpdate& update)
+            {
+                update.skinnable.get().updateSkinning(update.animator.get());
+            });
+            executor->run(taskflow).wait();
+        }
+        else
+        {
+            for (auto& update : _skinningUpdates)
+            {
+                update.skinnable.get().updateSkinning(update.animator.get());
+            }
+        }
+
+        _skinningSize = size;
+        if (size == 0)
+        {
+            return;
+        }
+
+        // 3x4 matrices since the last row of an affine transform is always (0, 0, 0, 1)
+        VertexDataWriter writer{ _skinningLayout, size * 3 };
+        for (const Skinnable& skinnable : _skinnables)
+        {
+            auto index = skinnable.getSkinningOffset() * 3;
+            for (auto& mtx : skinnable.getSkinning())
+            {
+                auto tmtx = glm::transpose(mtx);
+                writer.write(bgfx::Attrib::Color0, index++, tmtx[0]);
+                writer.write(bgfx::Attrib::Color0, index++, tmtx[1]);
+                writer.write(bgfx::Attrib::Color0, index++, tmtx[2]);
+            }
+        }
+        bgfx::update(_skinningBuffer, 0, writer.finish().copyMem());
+    }
+
+    const DynamicVertexBuffer& SkeletalAnimationSceneComponent::getSkinningBuffer() const noexcept
+    {
+        return _skinningBuffer;
+    }
+
     SkeletalAnimationSceneComponent::Definition SkeletalAnimationSceneComponent::createDefinition() noexcept
     {
         Definition def;
+        def.set_skip_culled(true);
 		return def;
     }
 
     expected<void, std::string> SkeletalAnimationSceneComponent::load(const Definition& def) noexcept
     {
+        _def = def;
 		return {};
     }
 
@@ -198,8 +466,10 @@ namespace darmok
     {
         _scene = scene;
         _cam = cam;
-        // TODO: maybe we should use u_model[X] but the bgfx API setTransform forces you to pass all at the same time
-        _skinningUniform = { "u_skinning", bgfx::UniformType::Mat4, DARMOK_SKELETON_MAX_BONES };
+        _skinningDataUniform = { "u_skinningData", bgfx::UniformType::Vec4 };
+        // entities can be rendered from multiple threads, make sure the storages exist beforehand
+        scene.createComponentStorage<Skinnable>();
+        scene.createComponentStorage<SkeletalAnimator>();
         return {};
     }
 
@@ -207,7 +477,8 @@ namespace darmok
     {
         _scene.reset();
         _cam.reset();
-        _skinningUniform.reset();
+        _animations.reset();
+        _skinningDataUniform.reset();
         return {};
     }
 
@@ -220,33 +491,40 @@ namespace darmok
         return _scene->getComponentInParent<SkeletalAnimator>(entity);
     }
 
+    expected<void, std::string> SkeletalAnimationRenderComponent::render() noexcept
+    {
+        if (!_scene)
+        {
+            return {};
+        }
+        // the scene component is not updated if the scene is paused
+        _animations = _scene->getSceneComponent<SkeletalAnimationSceneComponent>();
+        if (_animations)
+        {
+            _animations->updateSkinning();
+        }
+        return {};
+    }
+
     expected<void, std::string> SkeletalAnimationRenderComponent::beforeRenderEntity(Entity entity, bgfx::ViewId viewId, bgfx::Encoder& encoder) noexcept
     {
-        auto skinnable = _scene->getComponent<Skinnable>(entity);
-        if (!skinnable)
+        if (!_animations)
         {
             return {};
         }
-        auto animator = getAnimator(entity);
-        if (!animator)
+        auto skinnable = _scene->getComponent<const Skinnable>(entity);
+        if (!skinnable)
         {
             return {};
         }
-
-        auto armature = skinnable->getArmature();
-        _skinning.clear();
-        _skinning.push_back(glm::mat4{ 1 });
-        if (armature)
+        if (!getAnimator(entity))
         {
-            auto& joints = armature->getJoints();
-            _skinning.reserve(joints.size() + 1);
-            for (auto& joint : joints)
-            {
-                auto model = animator->getJointModelMatrix(joint.name);
-                _skinning.push_back(model * joint.inverseBindPose);
-            }
+            return {};
         }
-        encoder.setUniform(_skinningUniform, &_skinning.front(), uint16_t(_skinning.size()));
+
+        encoder.setBuffer(RenderSamplers::SKINNING, _animations->getSkinningBuffer(), bgfx::Access::Read);
+        const glm::vec4 skinningData{ skinnable->getSkinningOffset(), 0.F, 0.F, 0.F };
+        encoder.setUniform(_skinningDataUniform, glm::value_ptr(skinningData));
         return {};
     }
 
@@ -659,6 +937,11 @@ namespace darmok
         {
         }
 
+    std::unique_ptr<IFileTypeImporter> SkeletalAnimatorDefinitionFileImporter::clone() const noexcept
+    {
+        return std::make_unique<SkeletalAnimatorDefinitionFileImporter>();
+    }
+
     Armature::Armature(const Definition& def) noexcept
     {
         _joints.reserve(def.joints_size());
@@ -690,6 +973,8 @@ namespace darmok
 
     Skinnable::Skinnable(const std::shared_ptr<Armature>& armature) noexcept
         : _armature{ armature }
+        , _skinningVersion{ 0 }
+        , _skinningOffset{ 0 }
     {
     }
 
@@ -701,6 +986,74 @@ namespace darmok
     void Skinnable::setArmature(const std::shared_ptr<Armature>& armature) noexcept
     {
         _armature = armature;
+        _jointIndices.clear();
+        _jointsSkeleton.reset();
+        _skinningAnimator.reset();
+        _skinning.clear();
+    }
+
+    void Skinnable::resolveJoints(const SkeletalAnimator& animator) noexcept
+    {
+        auto skel = animator.getSkeleton();
+        if (_jointsSkeleton.ptr() == skel.get() && !_jointIndices.empty())
+        {
+            return;
+        }
+        _jointIndices.clear();
+        _jointsSkeleton = skel.get();
+        if (!_armature)
+        {
+            return;
+        }
+        auto& joints = _armature->getJoints();
+        _jointIndices.reserve(joints.size());
+        for (auto& joint : joints)
+        {
+            _jointIndices.push_back(animator.getJointIndex(joint.name));
+        }
+    }
+
+    void Skinnable::updateSkinning(const SkeletalAnimator& animator) noexcept
+    {
+        resolveJoints(animator);
+        _skinning.clear();
+        _skinning.push_back(glm::mat4{ 1 });
+        if (_armature)
+        {
+            auto& joints = _armature->getJoints();
+            _skinning.reserve(joints.size() + 1);
+            for (size_t i = 0; i < joints.size(); ++i)
+            {
+                glm::mat4 model{ 1 };
+                if (auto index = _jointIndices[i])
+                {
+                    model = animator.getJointModelMatrix(index.value());
+                }
+                _skinning.push_back(model * joints[i].inverseBindPose);
+            }
+        }
+        _skinningAnimator = animator;
+        _skinningVersion = animator.getVersion();
+    }
+
+    bool Skinnable::isSkinningUpdated(const SkeletalAnimator& animator) const noexcept
+    {
+        return _skinningAnimator.ptr() == &animator && _skinningVersion == animator.getVersion() && !_skinning.empty();
+    }
+
+    const std::vector<glm::mat4>& Skinnable::getSkinning() const noexcept
+    {
+        return _skinning;
+    }
+
+    uint32_t Skinnable::getSkinningOffset() const noexcept
+    {
+        return _skinningOffset;
+    }
+
+    void Skinnable::setSkinningOffset(uint32_t offset) noexcept
+    {
+        _skinningOffset = offset;
     }
 
     expected<void, std::string> Skinnable::load(const Definition& def, IComponentLoadContext& ctxt)
@@ -726,6 +726,11 @@ namespace darmok
         return (*_impl)(input, config);
     }
 
+    std::unique_ptr<IFileTypeImporter> AssimpSkeletonFileImporter::clone() const noexcept
+    {
+        return std::make_unique<AssimpSkeletonFileImporter>();
+    }
+
     AssimpSkeletalAnimationFileImporterImpl::AssimpSkeletalAnimationFileImporterImpl(size_t bufferSize) noexcept
         : _bufferSize(bufferSize)
     {
@@ -1011,6 +1016,11 @@ namespace darmok
         return (*_impl)(input, config);
     }
 
+    std::unique_ptr<IFileTypeImporter> AssimpSkeletalAnimationFileImporter::clone() const noexcept
+    {
+        return std::make_unique<AssimpSkeletalAnimationFileImporter>();
+    }
+
     bool AssimpOzzImporter::Load(const char* filename)
     {
         _path = filename;
@@ -220,6 +220,7 @@ namespace darmok
         , _speed{ 1.f }
         , _paused{ false }
         , _blendPosition{ 0 }
+        , _version{ 0 }
     {
     }
 
@@ -408,7 +409,7 @@ namespace darmok
         return _looped && !_def.loop();
     }
 
-    expected<void, std::string> OzzSkeletalAnimatorAnimationState::update(float deltaTime) noexcept
+    expected<void, std::string> OzzSkeletalAnimatorAnimationState::update(float deltaTime, bool sample) noexcept
     {
         if (hasFinished())
         {
@@ -425,6 +426,10 @@ namespace darmok
         }
 
         setNormalizedTime(normTime);
+        if (!sample)
+        {
+            return {};
+        }
 
         ozz::animation::SamplingJob sampling;
         sampling.animation = &getOzz();
@@ -532,12 +537,12 @@ namespace darmok
         _speed = _def.speed();
     }
 
-    expected<void, std::string> OzzSkeletalAnimatorState::update(float deltaTime, const glm::vec2& blendPosition) noexcept
+    expected<void, std::string> OzzSkeletalAnimatorState::update(float deltaTime, const glm::vec2& blendPosition, bool sample) noexcept
     {
         deltaTime *= _speed;
         for (auto& anim : _animationStates)
         {
-            auto result = anim.update(deltaTime);
+            auto result = anim.update(deltaTime, sample);
             if (!result)
             {
                 return result;
@@ -553,10 +558,6 @@ namespace darmok
         {
             return {};
         }
-        ozz::animation::BlendingJob blending;
-        blending.layers = ozz::make_span(_layers);
-        blending.output = ozz::make_span(_locals);
-        blending.threshold = _def.threshold();
 
         ConstSkeletalAnimatorTweenDefinitionWrapper tween{ _def.tween() };
         if (_blendPos != blendPosition)
@@ -571,6 +572,16 @@ namespace darmok
         {
             _normalizedTweenTime = 1.f;
         }
+        if (!sample)
+        {
+            return {};
+        }
+
+        ozz::animation::BlendingJob blending;
+        blending.layers = ozz::make_span(_layers);
+        blending.output = ozz::make_span(_locals);
+        blending.threshold = _def.threshold();
+
         auto blendFactor = tween.calcTween(_normalizedTweenTime);
         auto pos = getBlendedPosition(blendFactor);
 
@@ -679,15 +690,18 @@ namespace darmok
         _normalizedTime = std::fmodf(normalizedTime, 1.f);
     }
 
-    expected<void, std::string> OzzSkeletalAnimatorTransition::update(float deltaTime, const glm::vec2& blendPosition) noexcept
+    expected<void, std::string> OzzSkeletalAnimatorTransition::update(float deltaTime, const glm::vec2& blendPosition, bool sample) noexcept
     {
         if (hasFinished())
         {
-            _locals = _currentState.getLocals();
+            if (sample)
+            {
+                _locals = _currentState.getLocals();
+            }
             return {};
         }
 
-        auto updateResult = _previousState.update(deltaTime, blendPosition);
+        auto updateResult = _previousState.update(deltaTime, blendPosition, sample);
         if (!updateResult)
         {
             return updateResult;
@@ -697,12 +711,16 @@ namespace darmok
         {
             currentStateDeltaTime += _def.offset();
         }
-        auto result = _currentState.update(currentStateDeltaTime, blendPosition);
+        auto result = _currentState.update(currentStateDeltaTime, blendPosition, sample);
         if (!result)
         {
             return {};
         }
         _normalizedTime += deltaTime / getDuration();
+        if (!sample)
+        {
+            return {};
+        }
         ConstSkeletalAnimatorTweenDefinitionWrapper tween{ _def.tween() };
         auto v = tween.calcTween(_normalizedTime);
 
@@ -905,6 +923,8 @@ namespace darmok
 		_skeleton = std::move(skeleton);
 		_animations = std::move(animations);
         _def = std::move(def);
+        _prevSample.clear();
+        _lastSample.clear();
 
         auto& skel = getOzz();
         _models.resize(skel.num_joints());
@@ -913,6 +933,7 @@ namespace darmok
         job.output = ozz::make_span(_models);
         job.skeleton = &skel;
         job.Run();
+        ++_version;
     }
 
     expected<void, std::string> SkeletalAnimatorImpl::load(const Definition& def, IComponentLoadContext& ctxt) noexcept
@@ -939,6 +960,26 @@ namespace darmok
         return _impl->getJointModelMatrix(name);
     }
 
+    glm::mat4 SkeletalAnimator::getJointModelMatrix(size_t index) const noexcept
+    {
+        return _impl->getJointModelMatrix(index);
+    }
+
+    std::optional<size_t> SkeletalAnimator::getJointIndex(std::string_view name) const noexcept
+    {
+        return _impl->getJointIndex(name);
+    }
+
+    std::shared_ptr<Skeleton> SkeletalAnimator::getSkeleton() const noexcept
+    {
+        return _impl->getSkeleton();
+    }
+
+    uint32_t SkeletalAnimator::getVersion() const noexcept
+    {
+        return _impl->getVersion();
+    }
+
     std::unordered_map<std::string, glm::mat4> SkeletalAnimator::getJointModelMatrixes(const glm::vec3& dir) const noexcept
     {
         return _impl->getJointModelMatrixes(dir);
@@ -949,6 +990,16 @@ namespace darmok
         return _impl->update(deltaTime);
     }
 
+    expected<void, std::string> SkeletalAnimator::updatePose(float deltaTime, bool sample, std::optional<float> interpolation) noexcept
+    {
+        return _impl->updatePose(deltaTime, sample, interpolation);
+    }
+
+    void SkeletalAnimator::updateEvents() noexcept
+    {
+        _impl->updateEvents();
+    }
+
     expected<void, std::string> SkeletalAnimator::load(const Definition& def, IComponentLoadContext& ctxt) noexcept
     {
 		return _impl->load(def, ctxt);
@@ -961,19 +1012,47 @@ namespace darmok
 
     glm::mat4 SkeletalAnimatorImpl::getJointModelMatrix(const std::string& joint) const noexcept
     {
-        if (_skeleton == nullptr)
+        if (auto index = getJointIndex(joint))
+        {
+            return getJointModelMatrix(index.value());
+        }
+        return glm::mat4(1);
+    }
+
+    glm::mat4 SkeletalAnimatorImpl::getJointModelMatrix(size_t index) const noexcept
+    {
+        if (index >= _models.size())
         {
             return glm::mat4(1);
         }
+        return OzzUtils::convert(_models[index]);
+    }
+
+    std::optional<size_t> SkeletalAnimatorImpl::getJointIndex(std::string_view name) const noexcept
+    {
+        if (_skeleton == nullptr)
+        {
+            return std::nullopt;
+        }
         auto jointNames = getOzz().joint_names();
         for (size_t i = 0; i < jointNames.size() && i < _models.size(); i++)
         {
-            if (jointNames[i] == joint)
+            if (jointNames[i] == name)
             {
-                return OzzUtils::convert(_models[i]);
+                return i;
             }
         }
-        return glm::mat4(1);
+        return std::nullopt;
+    }
+
+    std::shared_ptr<Skeleton> SkeletalAnimatorImpl::getSkeleton() const noexcept
+    {
+        return _skeleton;
+    }
+
+    uint32_t SkeletalAnimatorImpl::getVersion() const noexcept
+    {
+        return _version;
     }
 
     std::unordered_map<std::string, glm::mat4> SkeletalAnimatorImpl::getJointModelMatrixes(const glm::vec3& dir) const noexcept
@@ -1004,44 +1083,114 @@ namespace darmok
     }
 
     expected<void, std::string> SkeletalAnimatorImpl::update(float deltaTime) noexcept
+    {
+        auto result = updatePose(deltaTime);
+        if (!result)
+        {
+            return result;
+        }
+        updateEvents();
+        return {};
+    }
+
+    // each animation state has its own sampling context
+    // so this does not share mutable data with other animators
+    expected<void, std::string> SkeletalAnimatorImpl::updatePose(float deltaTime, bool sample, std::optional<float> interpolation) noexcept
     {
         deltaTime *= _speed;
-        ozz::animation::LocalToModelJob ltm;
+        const ozz::vector<ozz::math::SoaTransform>* locals = nullptr;
 
         if (_transition)
         {
-            auto result = _transition->update(deltaTime, _blendPosition);
+            auto result = _transition->update(deltaTime, _blendPosition, sample);
             if (!result)
             {
                 return result;
             }
-            ltm.input = ozz::make_span(_transition->getLocals());
+            locals = &_transition->getLocals();
         }
         else if (_state)
         {
-            auto result = _state->update(deltaTime, _blendPosition);
+            auto result = _state->update(deltaTime, _blendPosition, sample);
             if (!result)
             {
                 return result;
             }
-            ltm.input = ozz::make_span(_state->getLocals());
+            locals = &_state->getLocals();
         }
         else
         {
             return {};
         }
 
+        if (!interpolation)
+        {
+            _prevSample.clear();
+            _lastSample.clear();
+            if (!sample)
+            {
+                return {};
+            }
+            return updateModels(ozz::make_span(*locals));
+        }
+
+        // the joints show the previous sample when a new one arrives
+        // so the pose lags one interval behind but moves smoothly
+        if (sample)
+        {
+            if (_lastSample.empty())
+            {
+                _prevSample = *locals;
+            }
+            else
+            {
+                std::swap(_prevSample, _lastSample);
+            }
+            _lastSample = *locals;
+        }
+        if (_lastSample.empty())
+        {
+            return {};
+        }
+        return updateInterpolation(interpolation.value());
+    }
+
+    expected<void, std::string> SkeletalAnimatorImpl::updateInterpolation(float factor) noexcept
+    {
+        std::array<ozz::animation::BlendingJob::Layer, 2> layers;
+        layers[0].weight = 1.f - factor;
+        layers[0].transform = ozz::make_span(_prevSample);
+        layers[1].weight = factor;
+        layers[1].transform = ozz::make_span(_lastSample);
+
+        _interpolatedLocals.resize(_lastSample.size());
+        ozz::animation::BlendingJob blending;
+        blending.layers = ozz::make_span(layers);
+        blending.output = ozz::make_span(_interpolatedLocals);
+        blending.threshold = bx::kFloatSmallest;
+        blending.rest_pose = layers[0].transform;
+        if (!blending.Run())
+        {
+            return unexpected<std::string>{ "error in the interpolation blending job" };
+        }
+        return updateModels(ozz::make_span(_interpolatedLocals));
+    }
+
+    expected<void, std::string> SkeletalAnimatorImpl::updateModels(ozz::span<const ozz::math::SoaTransform> locals) noexcept
+    {
+        ozz::animation::LocalToModelJob ltm;
+        ltm.input = locals;
         ltm.skeleton = &getOzz();
         ltm.output = ozz::make_span(_models);
         if (!ltm.Run())
         {
             return unexpected<std::string>{ "error in the model job" };
         }
-        afterUpdate();
+        ++_version;
         return {};
     }
 
-    void SkeletalAnimatorImpl::afterUpdate() noexcept
+    void SkeletalAnimatorImpl::updateEvents() noexcept
     {
         auto listeners = _listeners.copy();
         if (_transition && _transition->hasFinished())
@@ -146,6 +146,7 @@ namespace darmok
 
         constexpr std::string_view vertexNormalizeAttrName = "DarmokVertexNormalize";
         constexpr std::string_view vertexAsIntAttrName = "DarmokVertexAsInt";
+        constexpr std::string_view instanceDataPrefix = "i_data";
 
         expected<protobuf::VertexLayout, std::string> createVertexLayout(slang::EntryPointReflection& entryPoint) noexcept
         {
@@ -172,6 +173,11 @@ namespace darmok
                 {
                     continue;
                 }
+                if (std::string_view{ name }.starts_with(instanceDataPrefix))
+                {
+                    // instance data is not part of the mesh vertex layout
+                    continue;
+                }
                 auto bgfxAttribResult = getBgfxAttrib(semanticName, field->getSemanticIndex());
                 if (!bgfxAttribResult)
                 {
@@ -1326,6 +1332,11 @@ namespace darmok
 		return (*_impl)(src);
     }
 
+    SlangProgramFileImporterImpl::SlangProgramFileImporterImpl(const CompileConfig& defaultConfig) noexcept
+        : _defaultConfig{ defaultConfig }
+    {
+    }
+
     void SlangProgramFileImporterImpl::addIncludePath(const std::filesystem::path& path) noexcept
     {
 		_defaultConfig.includePaths.insert(path);
@@ -1341,6 +1352,11 @@ namespace darmok
         _defaultConfig.optimizationLevel = level;
     }
 
+    const SlangProgramFileImporterImpl::CompileConfig& SlangProgramFileImporterImpl::getDefaultConfig() const noexcept
+    {
+        return _defaultConfig;
+    }
+
     expected<void, std::string> SlangProgramFileImporterImpl::init(OptionalRef<std::ostream> log) noexcept
     {
         _defaultConfig.log = log;
@@ -1471,4 +1487,11 @@ namespace darmok
     {
 		return (*_impl)(input, config);
     }
+
+    std::unique_ptr<IFileTypeImporter> SlangProgramFileImporter::clone() const noexcept
+    {
+        auto importer = std::make_unique<SlangProgramFileImporter>();
+        importer->_impl = std::make_unique<SlangProgramFileImporterImpl>(_impl->getDefaultConfig());
+        return importer;
+    }
 }
@@ -685,4 +685,9 @@ namespace darmok
 	{
 		return _impl->getName();
 	}
+
+	std::unique_ptr<IFileTypeImporter> FreetypeFontFileImporter::clone() const noexcept
+	{
+		return std::make_unique<FreetypeFontFileImporter>();
+	}
 }
\ No newline at end of file
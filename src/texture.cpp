@@ -447,6 +447,22 @@ namespace darmok
 		return load(DataView{ def.data() }, def.config(), def.flags());
 	}
 
+	expected<Texture, std::string> Texture::load(const std::shared_ptr<const Definition>& def) noexcept
+	{
+		if (!def)
+		{
+			return unexpected{ "empty definition" };
+		}
+		// bgfx keeps the definition alive until the texture is created
+		const auto mem = DataView{ def->data() }.makeRef(def);
+		auto result = createTextureHandle(def->config(), def->flags(), mem);
+		if (!result)
+		{
+			return unexpected{ std::move(result).error() };
+		}
+		return Texture{ std::move(result).value(), def->config() };
+	}
+
 	bgfx::TextureInfo Texture::getInfo() const noexcept
 	{
 		bgfx::TextureInfo info;
@@ -633,4 +649,9 @@ namespace darmok
 		, ProtobufFileImporter<ImageTextureDefinitionLoader>(_defLoader, "texture")
 	{
 	}
+
+	std::unique_ptr<IFileTypeImporter> TextureFileImporter::clone() const noexcept
+	{
+		return std::make_unique<TextureFileImporter>();
+	}
 }
\ No newline at end of file
@@ -670,6 +670,13 @@ namespace darmok
 		return name;
 	}
 
+	std::unique_ptr<IFileTypeImporter> TexturePackerAtlasFileImporter::clone() const noexcept
+	{
+		auto importer = std::make_unique<TexturePackerAtlasFileImporter>();
+		importer->_exePath = _exePath;
+		return importer;
+	}
+
 	const std::unordered_map<std::string, std::string> TexturePackerAtlasFileImporter::_textureFormatExts = {
 		{ "png8", ".png"},
 		{ "pvr3", ".pvr"},
@@ -793,7 +800,7 @@ namespace darmok
 		for (const auto& node : nodes)
 		{
 			const auto* path = node.node().text().as_string();
-			effect.dependencies.insert(basePath / path);
+			effect.dependencies.insert(input.basePath / basePath / path);
 		}
 
 		return effect;
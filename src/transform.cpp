@@ -70,6 +70,8 @@ namespace darmok
         , _worldInverse{ 1.f }
         , _matrixChanged{ false }
         , _parentChanged{ false }
+        , _version{ 0 }
+        , _depth{ 0 }
     {
         setParent(parent);
         setLocalMatrix(mat);
@@ -85,6 +87,8 @@ namespace darmok
         , _worldInverse{ 1.f }
         , _matrixChanged{ true }
         , _parentChanged{ false }
+        , _version{ 0 }
+        , _depth{ 0 }
     {
         setParent(parent);
     }
@@ -108,7 +112,7 @@ namespace darmok
         _scale = glm::vec3{1.f};
         _localMatrix = glm::mat4{ 1.f };
         _localInverse = glm::mat4{ 1.f };
-        _matrixChanged = true;
+        setMatrixChanged();
     }
 
     std::string Transform::toString() const noexcept
@@ -175,35 +179,65 @@ namespace darmok
         {
             _parent->_children.emplace(*this);
         }
+        updateDepth();
         setParentChanged();
         return *this;
     }
 
+    void Transform::updateDepth() noexcept
+    {
+        _depth = _parent ? _parent->_depth + 1 : 0;
+        for (auto& child : _children)
+        {
+            child.get().updateDepth();
+        }
+    }
+
+    uint32_t Transform::getDepth() const noexcept
+    {
+        return _depth;
+    }
+
     const Transform::Children& Transform::getChildren() const noexcept
     {
         return _children;
     }
 
+    // the children of a dirty transform are always dirty
+    // so the subtree is only traversed the first time it changes
     void Transform::setMatrixChanged() noexcept
     {
+        auto dirty = isDirty();
         _matrixChanged = true;
-        setChildrenParentChanged();
+        if (!dirty)
+        {
+            setChildrenParentChanged();
+        }
     }
 
     void Transform::setParentChanged() noexcept
     {
+        auto dirty = isDirty();
         _parentChanged = true;
-        setChildrenParentChanged();
+        if (!dirty)
+        {
+            setChildrenParentChanged();
+        }
     }
 
     void Transform::setChildrenParentChanged() noexcept
     {
-        for (auto& child : Children{ _children })
+        for (auto& child : _children)
         {
             child.get().setParentChanged();
         }
     }
 
+    bool Transform::isDirty() const noexcept
+    {
+        return _matrixChanged || _parentChanged;
+    }
+
     Transform& Transform::setPosition(const glm::vec3& v) noexcept
     {
         if (v != _position)
@@ -297,7 +331,11 @@ namespace darmok
             _worldInverse = _localInverse;
             if (_parent != nullptr)
             {
-                _parent->update();
+                // checked first so that updates of siblings in different threads do not write to the parent
+                if (_parent->isDirty())
+                {
+                    _parent->update();
+                }
                 _worldMatrix = _parent->getWorldMatrix() * _worldMatrix;
                 _worldInverse = _worldInverse * _parent->getWorldInverse();
             }
@@ -305,9 +343,18 @@ namespace darmok
         }
         _matrixChanged = false;
         _parentChanged = false;
+        if (changed)
+        {
+            ++_version;
+        }
         return changed;
     }
 
+    uint32_t Transform::getVersion() const noexcept
+    {
+        return _version;
+    }
+
     Transform& Transform::setRotation(const glm::quat& v) noexcept
     {
         if (v != _rotation)
@@ -169,8 +169,21 @@ namespace darmok
 		encoder.setUniform(_randomUniform, glm::value_ptr(_randomValues));
 	}
 
+	UniformHandleContainer::UniformHandleContainer(UniformHandleContainer&& other) noexcept
+		: _handles{ std::move(other._handles) }
+	{
+	}
+
+	UniformHandleContainer& UniformHandleContainer::operator=(UniformHandleContainer&& other) noexcept
+	{
+		std::unique_lock lock{ _handlesMutex };
+		_handles = std::move(other._handles);
+		return *this;
+	}
+
 	void UniformHandleContainer::clear() noexcept
 	{
+		std::unique_lock lock{ _handlesMutex };
 		_handles.clear();
 	}
 
@@ -224,10 +237,19 @@ namespace darmok
 
 	const UniformHandle& UniformHandleContainer::getHandle(const Key& key) const noexcept
 	{
+		{
+			std::shared_lock lock{ _handlesMutex };
+			auto itr = _handles.find(key);
+			if (itr != _handles.end())
+			{
+				return itr->second;
+			}
+		}
+		std::unique_lock lock{ _handlesMutex };
 		auto itr = _handles.find(key);
 		if (itr == _handles.end())
 		{
-			itr = _handles.emplace(key.name, UniformHandle{ key.name, key.type }).first;
+			itr = _handles.emplace(key, UniformHandle{ key.name, key.type }).first;
 		}
 		return itr->second;
 	}
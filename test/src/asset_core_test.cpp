@@ -0,0 +1,181 @@
+#include <catch2/catch_test_macros.hpp>
+#include <darmok/asset_core.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace darmok;
+namespace fs = std::filesystem;
+
+namespace
+{
+	struct TestImportRecord final
+	{
+		std::mutex mutex;
+		std::vector<std::string> imported;
+		std::atomic<int> clones = 0;
+
+		void add(const std::string& name) noexcept
+		{
+			std::lock_guard lock{ mutex };
+			imported.push_back(name);
+		}
+
+		size_t find(const std::string& name) noexcept
+		{
+			std::lock_guard lock{ mutex };
+			auto itr = std::find(imported.begin(), imported.end(), name);
+			return std::distance(imported.begin(), itr);
+		}
+	};
+
+	// imports the files with the given prefix, logging around a slow import
+	class TestFileImporter final : public IFileTypeImporter
+	{
+	public:
+		TestFileImporter(std::string name, std::string prefix, TestImportRecord& record, std::string dependency = {}) noexcept
+			: _name{ std::move(name) }
+			, _prefix{ std::move(prefix) }
+			, _record{ record }
+			, _dependency{ std::move(dependency) }
+		{
+		}
+
+		const std::string& getName() const noexcept override
+		{
+			return _name;
+		}
+
+		expected<void, std::string> init(OptionalRef<std::ostream> log) noexcept override
+		{
+			_log = log;
+			return {};
+		}
+
+		expected<Effect, std::string> prepare(const Input& input) noexcept override
+		{
+			Effect effect;
+			auto fileName = input.path.filename().string();
+			if (!fileName.starts_with(_prefix))
+			{
+				return effect;
+			}
+			effect.outputs.push_back({ input.getOutputPath(".out"), false });
+			if (!_dependency.empty())
+			{
+				// not normalized on purpose
+				effect.dependencies.insert(input.basePath / "sub" / ".." / _dependency);
+			}
+			return effect;
+		}
+
+		expected<void, std::string> operator()(const Input& input, Config& config) noexcept override
+		{
+			auto fileName = input.path.filename().string();
+			if (_log)
+			{
+				*_log << "begin " << fileName << std::endl;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			_record.add(fileName);
+			if (_log)
+			{
+				*_log << "end " << fileName << std::endl;
+			}
+			*config.outputStreams.front() << fileName;
+			return {};
+		}
+
+		std::unique_ptr<IFileTypeImporter> clone() const noexcept override
+		{
+			++_record.clones;
+			return std::make_unique<TestFileImporter>(_name, _prefix, _record, _dependency);
+		}
+
+	private:
+		std::string _name;
+		std::string _prefix;
+		TestImportRecord& _record;
+		std::string _dependency;
+		OptionalRef<std::ostream> _log;
+	};
+
+	fs::path createTestInput(const fs::path& basePath, const std::vector<std::string>& fileNames)
+	{
+		fs::remove_all(basePath);
+		auto inputPath = basePath / "input";
+		fs::create_directories(inputPath);
+		for (auto& fileName : fileNames)
+		{
+			std::ofstream out{ inputPath / fileName };
+			out << fileName;
+		}
+		return inputPath;
+	}
+}
+
+TEST_CASE("file importer imports dependencies first", "[asset-core]")
+{
+	auto basePath = fs::temp_directory_path() / "darmok_asset_core_test";
+	auto inputPath = createTestInput(basePath, { "base.txt", "top.txt", "other1.txt", "other2.txt" });
+
+	TestImportRecord record;
+	FileImporter importer{ inputPath };
+	importer.setOutputPath(basePath / "output");
+	importer.setJobs(4);
+	importer.addTypeImporter<TestFileImporter>("top", "top", record, "base.txt");
+	importer.addTypeImporter<TestFileImporter>("base", "base", record);
+	importer.addTypeImporter<TestFileImporter>("other", "other", record);
+
+	std::stringstream log;
+	REQUIRE(importer(log));
+	REQUIRE(record.imported.size() == 4);
+	REQUIRE(record.find("base.txt") < record.find("top.txt"));
+	REQUIRE(record.clones > 0);
+	REQUIRE(fs::exists(basePath / "output" / "top.out"));
+
+	fs::remove_all(basePath);
+}
+
+TEST_CASE("file importer does not interleave the logs of parallel imports", "[asset-core]")
+{
+	auto basePath = fs::temp_directory_path() / "darmok_asset_core_log_test";
+	std::vector<std::string> fileNames;
+	for (int i = 0; i < 8; ++i)
+	{
+		fileNames.push_back("file" + std::to_string(i) + ".txt");
+	}
+	auto inputPath = createTestInput(basePath, fileNames);
+
+	TestImportRecord record;
+	FileImporter importer{ inputPath };
+	importer.setOutputPath(basePath / "output");
+	importer.setJobs(4);
+	importer.addTypeImporter<TestFileImporter>("file", "file", record);
+
+	std::stringstream log;
+	REQUIRE(importer(log));
+	REQUIRE(record.imported.size() == fileNames.size());
+
+	std::string line;
+	size_t begins = 0;
+	while (std::getline(log, line))
+	{
+		if (!line.starts_with("begin "))
+		{
+			continue;
+		}
+		++begins;
+		std::string next;
+		REQUIRE(std::getline(log, next));
+		REQUIRE(next == "end " + line.substr(6));
+	}
+	REQUIRE(begins == fileNames.size());
+
+	fs::remove_all(basePath);
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+#include <darmok/asset_pack.hpp>
+
+#include <fstream>
+
+using namespace darmok;
+
+namespace
+{
+	protobuf::AssetPack createTestAssetPack()
+	{
+		protobuf::AssetPack pack;
+		auto& assets = *pack.mutable_assets();
+		for (uint32_t i = 0; i < 10; ++i)
+		{
+			protobuf::Texture tex;
+			tex.mutable_config()->mutable_size()->set_x(i + 1);
+			tex.set_data(std::string(i * 100, static_cast<char>(i)));
+			assets["texture" + std::to_string(i) + ".png"].PackFrom(tex);
+		}
+		protobuf::TextureConfig config;
+		config.set_layers(3);
+		assets["config.json"].PackFrom(config);
+		return pack;
+	}
+}
+
+TEST_CASE("asset pack file can be written and read", "[asset-pack]")
+{
+	auto path = std::filesystem::temp_directory_path() / "darmok_asset_pack_test.dpk";
+	auto pack = createTestAssetPack();
+	REQUIRE(AssetPackFile::write(pack, path));
+
+	{
+		auto fileResult = AssetPackFile::open(path);
+		REQUIRE(fileResult);
+		auto& file = fileResult.value();
+		REQUIRE(file.size() == 11);
+		REQUIRE(file.getPaths().size() == 11);
+		REQUIRE(file.contains("texture3.png"));
+		REQUIRE(!file.contains("texture10.png"));
+
+		protobuf::Texture tex;
+		REQUIRE(file.unpack("texture3.png", tex));
+		REQUIRE(tex.config().size().x() == 4);
+		REQUIRE(tex.data() == std::string(300, 3));
+
+		auto dataResult = file.getData("texture3.png");
+		REQUIRE(dataResult);
+		REQUIRE(reinterpret_cast<uintptr_t>(dataResult->ptr()) % AssetPackFile::blobAlignment == 0);
+
+		auto typeResult = file.getTypeId("config.json");
+		REQUIRE(typeResult);
+		REQUIRE(typeResult.value() == protobuf::getTypeId<protobuf::TextureConfig>());
+
+		REQUIRE(!file.unpack("config.json", tex));
+		REQUIRE(!file.unpack("missing.png", tex));
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("scene asset pack file can be read through the data loader", "[asset-pack]")
+{
+	auto dir = std::filesystem::temp_directory_path();
+	auto path = dir / "darmok_scene_asset_pack_test.dpk";
+
+	protobuf::Scene scene;
+	scene.set_name("test");
+	*scene.mutable_assets() = createTestAssetPack();
+	{
+		std::ofstream out{ path, std::ios::binary };
+		REQUIRE(AssetPackFile::write(scene, out));
+	}
+
+	{
+		FileDataLoader dataLoader;
+		dataLoader.addRootPath(dir);
+		AssetPackFileLoader loader{ dataLoader };
+		auto fileResult = loader(path.filename());
+		REQUIRE(fileResult);
+		auto& file = *fileResult.value();
+		REQUIRE(file.size() == 12);
+		REQUIRE(file.hasScene());
+		REQUIRE(file.contains("texture3.png"));
+
+		protobuf::Scene sceneDef;
+		REQUIRE(file.unpackScene(sceneDef));
+		REQUIRE(sceneDef.name() == "test");
+		REQUIRE(sceneDef.assets().assets_size() == 0);
+
+		REQUIRE(!loader("missing.dpk"));
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("asset pack file rejects invalid data", "[asset-pack]")
+{
+	auto path = std::filesystem::temp_directory_path() / "darmok_asset_pack_invalid_test.dpk";
+	{
+		std::ofstream out{ path, std::ios::binary };
+		out << "this is not an asset pack file";
+	}
+	REQUIRE(!AssetPackFile::open(path));
+	std::filesystem::remove(path);
+}
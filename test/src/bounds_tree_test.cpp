@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+#include <darmok/bounds_tree.hpp>
+#include <darmok/math.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+
+using namespace darmok;
+
+namespace
+{
+	BoundingBox createUnitBox(const glm::vec3& pos)
+	{
+		return BoundingBox{ pos - glm::vec3{ 0.5F }, pos + glm::vec3{ 0.5F } };
+	}
+
+	bool containsEntity(const std::vector<Entity>& entities, Entity entity)
+	{
+		return std::find(entities.begin(), entities.end(), entity) != entities.end();
+	}
+}
+
+TEST_CASE("Bounds tree stays balanced", "[bounds-tree]")
+{
+	BoundsTree tree{ 0.1F };
+	std::vector<BoundsTree::NodeId> nodes;
+	for (uint32_t i = 0; i < 128; ++i)
+	{
+		nodes.push_back(tree.insert(Entity{ i }, createUnitBox(glm::vec3{ i * 2.F, 0.F, 0.F })));
+	}
+	REQUIRE(tree.size() == 128);
+	REQUIRE(tree.getHeight() <= 14);
+
+	for (size_t i = 0; i < nodes.size(); i += 2)
+	{
+		tree.remove(nodes[i]);
+	}
+	REQUIRE(tree.size() == 64);
+
+	std::vector<Entity> entities;
+	tree.query(BoundingBox{ glm::vec3{ -1.F }, glm::vec3{ 300.F } }, entities);
+	REQUIRE(entities.size() == 64);
+	REQUIRE_FALSE(containsEntity(entities, Entity{ 0 }));
+	REQUIRE(containsEntity(entities, Entity{ 1 }));
+}
+
+TEST_CASE("Bounds tree queries use the exact bounds", "[bounds-tree]")
+{
+	BoundsTree tree{ 1.F };
+	auto node = tree.insert(Entity{ 0 }, createUnitBox(glm::vec3{ 0.F }));
+	tree.insert(Entity{ 1 }, createUnitBox(glm::vec3{ 5.F, 0.F, 0.F }));
+
+	// small movements stay inside the fat bounds
+	REQUIRE_FALSE(tree.update(node, createUnitBox(glm::vec3{ 0.2F, 0.F, 0.F })));
+	REQUIRE(tree.update(node, createUnitBox(glm::vec3{ 0.F, 10.F, 0.F })));
+
+	std::vector<Entity> entities;
+	tree.query(Sphere{ 1.F, glm::vec3{ 0.F } }, entities);
+	REQUIRE(entities.empty());
+	tree.query(Sphere{ 1.F, glm::vec3{ 0.F, 10.F, 0.F } }, entities);
+	REQUIRE(entities.size() == 1);
+	REQUIRE(entities.front() == Entity{ 0 });
+
+	auto hits = tree.raycast(Ray{ glm::vec3{ -5.F, 0.F, 0.F }, glm::vec3{ 1.F, 0.F, 0.F } });
+	REQUIRE(hits.size() == 1);
+	REQUIRE(hits.front().entity == Entity{ 1 });
+	REQUIRE(Math::almostEqual(hits.front().distance, 9.5F));
+
+	auto proj = Math::ortho(glm::vec2{ -1.F }, glm::vec2{ 1.F }, 0.F, 1.F);
+	entities.clear();
+	tree.query(Frustum{ proj * glm::translate(glm::mat4{ 1.F }, glm::vec3{ 0.F, -10.F, 0.F }) }, entities);
+	REQUIRE(entities.size() == 1);
+	REQUIRE(entities.front() == Entity{ 0 });
+}
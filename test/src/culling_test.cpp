@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+#include <darmok/culling.hpp>
+
+using namespace darmok;
+
+namespace
+{
+	void rasterizeScreenQuad(OcclusionDepthBuffer& buffer, float depth)
+	{
+		std::vector<glm::vec3> vertices{
+			{ -1.F, -1.F, depth }, { 1.F, -1.F, depth },
+			{ 1.F, 1.F, depth }, { -1.F, 1.F, depth }
+		};
+		std::vector<VertexIndex> indices{ 0, 1, 2, 0, 2, 3 };
+		buffer.rasterize(glm::mat4{ 1.F }, vertices, indices);
+		buffer.buildPyramid();
+	}
+}
+
+TEST_CASE("Occlusion depth buffer builds a pyramid", "[culling]")
+{
+	OcclusionDepthBuffer buffer{ glm::uvec2{ 16, 8 } };
+	REQUIRE(buffer.getLevelAmount() == 5);
+	rasterizeScreenQuad(buffer, 0.5F);
+	REQUIRE(buffer.getDepth(glm::uvec2{ 3, 4 }) == 0.5F);
+	REQUIRE(buffer.getDepth(glm::uvec2{ 0, 0 }, buffer.getLevelAmount() - 1) == 0.5F);
+}
+
+TEST_CASE("Occlusion depth buffer tests boxes", "[culling]")
+{
+	OcclusionDepthBuffer buffer{ glm::uvec2{ 32, 16 } };
+	const BoundingBox behind{ glm::vec3{ -0.2F, -0.2F, 0.6F }, glm::vec3{ 0.2F, 0.2F, 0.8F } };
+	const BoundingBox front{ glm::vec3{ -0.2F, -0.2F, 0.1F }, glm::vec3{ 0.2F, 0.2F, 0.3F } };
+	const BoundingBox crossing{ glm::vec3{ -0.2F, -0.2F, 0.4F }, glm::vec3{ 0.2F, 0.2F, 0.8F } };
+
+	REQUIRE_FALSE(buffer.isOccluded(glm::mat4{ 1.F }, behind));
+
+	rasterizeScreenQuad(buffer, 0.5F);
+	REQUIRE(buffer.isOccluded(glm::mat4{ 1.F }, behind));
+	REQUIRE_FALSE(buffer.isOccluded(glm::mat4{ 1.F }, front));
+	REQUIRE_FALSE(buffer.isOccluded(glm::mat4{ 1.F }, crossing));
+}
+
+TEST_CASE("Occlusion depth buffer is conservative with partial occluders", "[culling]")
+{
+	OcclusionDepthBuffer buffer{ glm::uvec2{ 32, 32 } };
+	// occluder only covering the left half of the screen
+	std::vector<glm::vec3> vertices{
+		{ -1.F, -1.F, 0.5F }, { 0.F, -1.F, 0.5F },
+		{ 0.F, 1.F, 0.5F }, { -1.F, 1.F, 0.5F }
+	};
+	std::vector<VertexIndex> indices{ 0, 1, 2, 0, 2, 3 };
+	buffer.rasterize(glm::mat4{ 1.F }, vertices, indices);
+	buffer.buildPyramid();
+
+	const BoundingBox left{ glm::vec3{ -0.8F, -0.2F, 0.6F }, glm::vec3{ -0.4F, 0.2F, 0.8F } };
+	const BoundingBox middle{ glm::vec3{ -0.2F, -0.2F, 0.6F }, glm::vec3{ 0.2F, 0.2F, 0.8F } };
+	REQUIRE(buffer.isOccluded(glm::mat4{ 1.F }, left));
+	REQUIRE_FALSE(buffer.isOccluded(glm::mat4{ 1.F }, middle));
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch_test_macros.hpp>
+#include "detail/loader_async.hpp"
+#include "loader_test_utils.hpp"
+
+#include <chrono>
+
+using namespace darmok;
+using namespace darmok::test;
+
+namespace
+{
+	template<typename T>
+	bool isReady(const std::shared_future<T>& future) noexcept
+	{
+		return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+}
+
+TEST_CASE("async loader without executor loads synchronously", "[loader-async]")
+{
+	TestStringLoader defLoader;
+	AsyncLoader<std::string, std::string> loader{ defLoader };
+
+	auto future = loader("test.txt");
+	REQUIRE(isReady(future));
+	REQUIRE(future.get());
+	REQUIRE(*future.get().value() == "test.txt");
+	REQUIRE(loader.getLoadingAmount() == 0);
+}
+
+TEST_CASE("async loader resolves requests in update", "[loader-async]")
+{
+	tf::Executor executor{ 2 };
+	TestStringLoader defLoader;
+	AsyncLoader<std::string, std::string> loader{ defLoader };
+	loader.init(executor);
+
+	auto future1 = loader("test.txt");
+	auto future2 = loader("test.txt");
+	auto future3 = loader("");
+	REQUIRE(loader.isLoading("test.txt"));
+	REQUIRE(loader.getLoadingAmount() == 2);
+
+	executor.wait_for_all();
+	REQUIRE(!isReady(future1));
+	REQUIRE(loader.update() == 2);
+	REQUIRE(defLoader.count == 2);
+
+	REQUIRE(isReady(future1));
+	REQUIRE(isReady(future2));
+	REQUIRE(future1.get().value() == future2.get().value());
+	REQUIRE(*future1.get().value() == "test.txt");
+	REQUIRE(!future3.get());
+	REQUIRE(future3.get().error() == "empty path");
+	REQUIRE(loader.getLoadingAmount() == 0);
+
+	loader.shutdown();
+}
+
+TEST_CASE("async loader fails pending requests on shutdown", "[loader-async]")
+{
+	tf::Executor executor{ 1 };
+	TestStringLoader defLoader;
+	AsyncLoader<std::string, std::string> loader{ defLoader };
+	loader.init(executor);
+
+	auto future = loader("test.txt");
+	loader.shutdown();
+	REQUIRE(isReady(future));
+	REQUIRE(!future.get());
+}
+
+TEST_CASE("async loader returns the resource loaded while it was loading", "[loader-async]")
+{
+	tf::Executor executor{ 1 };
+	TestStringLoader defLoader;
+	TestLoader loader{ defLoader };
+	AsyncLoader<TestResource, std::string> asyncLoader{ loader, defLoader };
+	asyncLoader.init(executor);
+
+	auto future = asyncLoader("test.txt");
+	auto res = loader("test.txt").value();
+	executor.wait_for_all();
+	REQUIRE(asyncLoader.update() == 1);
+
+	REQUIRE(isReady(future));
+	REQUIRE(future.get().value() == res);
+	REQUIRE(TestResource::alive == 1);
+
+	asyncLoader.shutdown();
+}
@@ -0,0 +1,57 @@
+#include <catch2/catch_test_macros.hpp>
+#include "loader_test_utils.hpp"
+
+using namespace darmok;
+using namespace darmok::test;
+
+TEST_CASE("loader without budget destroys released resources right away", "[loader]")
+{
+	TestStringLoader defLoader;
+	TestLoader loader{ defLoader };
+
+	auto res = loader("a.txt").value();
+	REQUIRE(res->value == "a.txt");
+	REQUIRE(loader("a.txt").value() == res);
+	REQUIRE(defLoader.count == 1);
+
+	res.reset();
+	REQUIRE(TestResource::alive == 0);
+	REQUIRE(loader.isCached("a.txt"));
+	loader.pruneCache();
+	REQUIRE(!loader.isCached("a.txt"));
+	REQUIRE(loader.getRetainedCacheSize() == 0);
+}
+
+TEST_CASE("loader retains released resources within the budget", "[loader]")
+{
+	TestStringLoader defLoader;
+	TestLoader loader{ defLoader };
+	loader.setCacheBudget(250);
+
+	auto a = loader("a.txt").value();
+	auto b = loader("b.txt").value();
+	auto c = loader("c.txt").value();
+	a.reset();
+	b.reset();
+	c.reset();
+	loader.pruneCache();
+
+	// a was released first so it's the first evicted
+	REQUIRE(TestResource::alive == 2);
+	REQUIRE(loader.getRetainedCacheSize() == 200);
+	REQUIRE(!loader.isCached("a.txt"));
+	REQUIRE(loader.isCached("b.txt"));
+
+	auto b2 = loader("b.txt").value();
+	REQUIRE(b2->value == "b.txt");
+	REQUIRE(defLoader.count == 3);
+	REQUIRE(loader.getRetainedCacheSize() == 100);
+
+	auto a2 = loader("a.txt").value();
+	REQUIRE(defLoader.count == 4);
+
+	loader.setCacheBudget(0);
+	REQUIRE(TestResource::alive == 2);
+	REQUIRE(loader.getRetainedCacheSize() == 0);
+	REQUIRE(!loader.isCached("c.txt"));
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <darmok/loader.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace darmok::test
+{
+	// loads the path as the string, fails with an empty path
+	class TestStringLoader final : public ILoader<std::string>
+	{
+	public:
+		std::atomic<int> count = 0;
+
+		Result operator()(std::filesystem::path path) noexcept override
+		{
+			++count;
+			if (path.empty())
+			{
+				return unexpected<Error>{ "empty path" };
+			}
+			return std::make_shared<std::string>(path.string());
+		}
+	};
+
+	struct TestResource final
+	{
+		std::string value;
+
+		TestResource(const std::string& def) noexcept
+			: value{ def }
+		{
+			++alive;
+		}
+
+		~TestResource() noexcept
+		{
+			--alive;
+		}
+
+		size_t getStorageSize() const noexcept
+		{
+			return 100;
+		}
+
+		static inline int alive = 0;
+	};
+
+	using ITestFromDefinitionLoader = IFromDefinitionLoader<ILoader<TestResource>, std::string>;
+	using TestLoader = FromDefinitionLoader<ITestFromDefinitionLoader, ILoader<std::string>>;
+}
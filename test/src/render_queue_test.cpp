@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+#include <darmok/render_queue.hpp>
+
+using namespace darmok;
+
+TEST_CASE("Render queue radix sort orders keys", "[render]")
+{
+	RenderQueue::Items items;
+	std::vector<uint64_t> keys{ 5, 0xFF00000000000000, 3, 0x100, 42, 0x100, 0 };
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		items.push_back({ keys[i], static_cast<Entity>(i) });
+	}
+	RenderQueue::Items tmp;
+	RenderQueue::radixSort(items, tmp);
+
+	REQUIRE(items.size() == keys.size());
+	for (size_t i = 1; i < items.size(); ++i)
+	{
+		REQUIRE(items[i - 1].key <= items[i].key);
+	}
+	// stable for equal keys
+	REQUIRE(items[4].entity == static_cast<Entity>(3));
+	REQUIRE(items[5].entity == static_cast<Entity>(5));
+}
+
+TEST_CASE("Render queue keys", "[render]")
+{
+	SECTION("opaque sorts front to back inside the same state")
+	{
+		auto nearKey = RenderQueue::createOpaqueKey(1, 2, 3, 1.F);
+		auto farKey = RenderQueue::createOpaqueKey(1, 2, 3, 100.F);
+		REQUIRE(nearKey < farKey);
+	}
+	SECTION("opaque groups by program before depth")
+	{
+		auto a = RenderQueue::createOpaqueKey(1, 5, 5, 100.F);
+		auto b = RenderQueue::createOpaqueKey(2, 0, 0, 1.F);
+		REQUIRE(a < b);
+	}
+	SECTION("transparent sorts back to front after opaque")
+	{
+		auto opaque = RenderQueue::createOpaqueKey(0xFFFF, 0xFFFF, 0xFFFF, 1000.F);
+		auto nearKey = RenderQueue::createTransparentKey(1, 1, 1.F);
+		auto farKey = RenderQueue::createTransparentKey(1, 1, 100.F);
+		REQUIRE(opaque < farKey);
+		REQUIRE(farKey < nearKey);
+	}
+}
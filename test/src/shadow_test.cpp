@@ -0,0 +1,57 @@
+#include <catch2/catch_test_macros.hpp>
+#include <darmok/shadow.hpp>
+
+using namespace darmok;
+
+TEST_CASE("Shadow atlas falls back to smaller tiles", "[shadow]")
+{
+	ShadowAtlas atlas{ 1, 2 };
+
+	auto full = atlas.allocate(0);
+	REQUIRE(full);
+	REQUIRE_FALSE(atlas.allocate(0));
+	REQUIRE_FALSE(atlas.allocate(2));
+
+	atlas.release(full.value());
+	auto half = atlas.allocate(1);
+	REQUIRE(half);
+	REQUIRE_FALSE(atlas.allocate(0));
+
+	size_t smallTiles = 0;
+	while (atlas.allocate(2))
+	{
+		++smallTiles;
+	}
+	REQUIRE(smallTiles == 12);
+	REQUIRE_FALSE(atlas.allocate(3));
+}
+
+TEST_CASE("Shadow atlas reserves previous tiles", "[shadow]")
+{
+	ShadowAtlas atlas{ 2, 1 };
+	ShadowAtlasTile tile;
+	tile.layer = 1;
+	tile.level = 1;
+	tile.position = { 1, 1 };
+
+	REQUIRE(atlas.reserve(tile));
+	REQUIRE_FALSE(atlas.reserve(tile));
+	REQUIRE_FALSE(atlas.isFree(tile));
+
+	// misaligned tiles are not valid
+	ShadowAtlasTile misaligned;
+	misaligned.level = 0;
+	misaligned.position = { 1, 0 };
+	REQUIRE_FALSE(atlas.reserve(misaligned));
+
+	auto rect = atlas.getRect(tile);
+	REQUIRE(rect.x == 0.5F);
+	REQUIRE(rect.y == 0.5F);
+	REQUIRE(rect.z == 0.5F);
+
+	auto viewport = atlas.getViewport(tile, 1024);
+	REQUIRE(viewport == glm::uvec4{ 512, 512, 512, 512 });
+
+	atlas.clear();
+	REQUIRE(atlas.isFree(tile));
+}
@@ -2,6 +2,7 @@
 #include <darmok/shape.hpp>
 #include <darmok/math.hpp>
 #include <string>
+#include <cmath>
 #include <glm/glm.hpp>
 
 using namespace darmok;
@@ -81,4 +82,42 @@ TEST_CASE("Frustum planes are correct", "[shape]")
 	REQUIRE(left.normal == glm::vec3(-1, 0, 0));
 	REQUIRE(right.distance == 1);
 	REQUIRE(right.normal == glm::vec3(1, 0, 0));
-}
\ No newline at end of file
+}
+
+TEST_CASE("Frustum bounding sphere contains the corners", "[shape]")
+{
+	auto proj = Math::ortho(glm::vec2(-1), glm::vec2(1), 0, 1);
+	auto sphere = Frustum{ proj }.getBoundingSphere();
+	REQUIRE(Math::almostEqual(sphere.radius, 1.5F));
+	REQUIRE(Math::almostEqual(sphere.origin.z, 0.5F));
+
+	// the far plane is much bigger so the center is moved to it
+	Frustum frust;
+	frust.corners = {
+		glm::vec3{-1, -1, 1}, glm::vec3{ 1, -1, 1}, glm::vec3{-1,  1, 1}, glm::vec3{ 1,  1, 1},
+		glm::vec3{-4, -4, 5}, glm::vec3{ 4, -4, 5}, glm::vec3{-4,  4, 5}, glm::vec3{ 4,  4, 5}
+	};
+	sphere = frust.getBoundingSphere();
+	REQUIRE(Math::almostEqual(sphere.origin.z, 5.F));
+	REQUIRE(Math::almostEqual(sphere.radius, std::sqrt(32.F)));
+}
+
+TEST_CASE("Ray intersects bounding box", "[shape]")
+{
+	BoundingBox bbox{ glm::vec3(-1), glm::vec3(1) };
+	Ray ray{ glm::vec3(0, 0, -5), glm::vec3(0, 0, 1) };
+	auto dist = ray.intersect(bbox);
+	REQUIRE(dist);
+	REQUIRE(Math::almostEqual(dist.value(), 4.F));
+
+	ray.origin = glm::vec3(0);
+	dist = ray.intersect(bbox);
+	REQUIRE(dist);
+	REQUIRE(dist.value() == 0.F);
+
+	ray.origin = glm::vec3(0, 0, 5);
+	REQUIRE_FALSE(ray.intersect(bbox));
+
+	ray.origin = glm::vec3(2, 0, -5);
+	REQUIRE_FALSE(ray.intersect(bbox));
+}